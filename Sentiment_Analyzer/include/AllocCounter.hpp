@@ -0,0 +1,22 @@
+#ifndef ALLOCCOUNTER_HPP
+#define ALLOCCOUNTER_HPP
+
+#include <cstdint>
+
+/**
+ * @class AllocCounter
+ * @brief Counts global operator new calls to verify allocation-free hot paths
+ *
+ * Build with -DEMOTION_COUNT_ALLOCS to replace the global operator new/delete
+ * with counting versions. Without the flag nothing is replaced, enabled()
+ * returns false and count() stays at zero.
+ */
+class AllocCounter {
+public:
+    static bool enabled();
+
+    // Number of heap allocations made by the whole process so far
+    static uint64_t count();
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef BATCHPREDICTION_HPP
+#define BATCHPREDICTION_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @struct BatchPrediction
+ * @brief Per-class scores for a batch of documents
+ *
+ * scores is a row-major rows x classes matrix. What a score means depends
+ * on the model (posterior probability for Naive Bayes, one-vs-rest sigmoid
+ * for Logistic Regression, cosine similarity for VSM); in every case larger
+ * is more confident and argmax[row] indexes into classes.
+ */
+struct BatchPrediction {
+    std::vector<std::string> classes;
+    std::vector<double> scores;
+    std::vector<int> argmax;
+    size_t rows;
+
+    BatchPrediction() : rows(0) {}
+
+    size_t cols() const { return classes.size(); }
+
+    double score(size_t row, size_t col) const { return scores[row * classes.size() + col]; }
+
+    // Score of the winning class, usable as a confidence threshold
+    double confidence(size_t row) const {
+        return argmax[row] < 0 ? 0.0 : score(row, (size_t)argmax[row]);
+    }
+
+    const std::string &label(size_t row) const {
+        static const std::string none;
+        return argmax[row] < 0 ? none : classes[argmax[row]];
+    }
+
+    // Helper: size the matrix and fill argmax from the scores
+    void resize(size_t numRows, const std::vector<std::string> &classList) {
+        classes = classList;
+        rows = numRows;
+        scores.assign(numRows * classList.size(), 0.0);
+        argmax.assign(numRows, -1);
+    }
+
+    void computeArgmax() {
+        size_t c = classes.size();
+        for (size_t r = 0; r < rows; ++r) {
+            int best = c > 0 ? 0 : -1;
+            for (size_t k = 1; k < c; ++k) {
+                if (scores[r * c + k] > scores[r * c + best]) best = (int)k;
+            }
+            argmax[r] = best;
+        }
+    }
+};
+
+#endif
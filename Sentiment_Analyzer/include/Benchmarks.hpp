@@ -0,0 +1,84 @@
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <string>
+#include <vector>
+
+class Preprocessor;
+struct ModelSnapshot;
+
+/**
+ * @class Benchmarks
+ * @brief Offline experiments that measure model size / accuracy / latency trade-offs
+ *
+ * Each benchmark trains on a deterministic 80/20 split of the given
+ * tokenized corpus and prints a comparison table.
+ */
+class Benchmarks {
+public:
+    // Compare vocabulary pruning strategies (min-df, top-k frequency, chi-squared, MI)
+    static void vocabularyPruning(const std::vector<std::vector<std::string>> &docs,
+                                  const std::vector<std::string> &labels);
+
+    // Compare double, int8 and float16 NB/LR inference: size, accuracy drift, latency
+    static void quantization(const std::vector<std::vector<std::string>> &docs,
+                             const std::vector<std::string> &labels);
+
+    // Compare single models, sequential scoring and the fused ensemble (vote / stacking)
+    static void ensemble(const std::vector<std::vector<std::string>> &docs,
+                         const std::vector<std::string> &labels);
+
+    // Centroid VSM vs brute-force kNN vs WAND kNN at several prune factors: accuracy, recall, latency
+    static void knn(const std::vector<std::vector<std::string>> &docs,
+                    const std::vector<std::string> &labels);
+
+    /**
+     * Heap allocations and latency per document: allocating path vs the scratch-arena
+     * path, plus ModelSnapshot::predict() on served when it is not null
+     * @return false when a warm scratch path allocated (needs -DEMOTION_COUNT_ALLOCS)
+     */
+    static bool scratchAllocations(Preprocessor &pre,
+                                   const std::vector<std::string> &rawTexts,
+                                   const std::vector<std::string> &labels,
+                                   const ModelSnapshot *served);
+
+    // Concurrent readers while the model is republished: mutex + in-place copy vs RCU snapshot swap
+    static void snapshotServing(const ModelSnapshot &base,
+                                const std::vector<std::string> &rawTexts);
+
+    // FastMath kernels vs libm: worst relative error, special values and throughput per kernel
+    static void fastMath();
+
+    // Dense dot / axpy / norm / scale kernels vs plain loops, then dense VSM + LR training per kernel
+    static void denseKernels(const std::vector<std::vector<std::string>> &docs,
+                             const std::vector<std::string> &labels);
+
+    // L1 / elastic-net LR sweep: surviving weights, compact model size, accuracy and latency per penalty
+    static void sparseLogistic(const std::vector<std::vector<std::string>> &docs,
+                               const std::vector<std::string> &labels);
+
+    // First-seen vs frequency-ordered vocabulary ids (optionally hot/cold lookup tiers): lookup and
+    // NB + LR + VSM scoring throughput, with cache misses from perf_event_open where the kernel allows it
+    static void vocabularyOrder(const std::vector<std::vector<std::string>> &docs,
+                                const std::vector<std::string> &labels);
+
+    // Uncached serving vs the sharded prediction cache on a stream of case / punctuation variants,
+    // with and without model swaps: throughput, latency, hit rate and agreement with the uncached answers
+    static void predictionCache(const ModelSnapshot &base,
+                                const std::vector<std::string> &rawTexts);
+
+    // Exact-count NB vs count-min sketch NB (standard and conservative update) at several memory caps
+    static void countMinNaiveBayes(const std::vector<std::vector<std::string>> &docs,
+                                   const std::vector<std::string> &labels);
+
+private:
+    // Helper: split documents into train (4 of 5) and test (1 of 5) sets
+    static void splitTrainTest(const std::vector<std::vector<std::string>> &docs,
+                               const std::vector<std::string> &labels,
+                               std::vector<std::vector<std::string>> &trainDocs,
+                               std::vector<std::string> &trainLabels,
+                               std::vector<std::vector<std::string>> &testDocs,
+                               std::vector<std::string> &testLabels);
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class BoundedQueue
+ * @brief Fixed-capacity lock-free multi-producer / multi-consumer queue
+ *
+ * Ring buffer with a sequence number per cell (Vyukov's bounded MPMC
+ * queue): a push or pop is one CAS on the shared position plus one store
+ * to the cell, with no locks. A full queue refuses tryPush, which is what
+ * gives a pipeline its backpressure; push() / pop() wrap the try calls in a
+ * spin -> yield -> sleep backoff and report how long they waited.
+ *
+ * End of stream: every producer is registered with addProducer() before
+ * any consumer starts and calls producerDone() when finished; pop() returns
+ * false once all producers are done and the queue is drained.
+ */
+template <class T>
+class BoundedQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    Cell *cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+    alignas(64) std::atomic<int> producers;
+
+    BoundedQueue(const BoundedQueue &);
+    BoundedQueue &operator=(const BoundedQueue &);
+
+    // Helper: escalating wait used by the blocking push / pop
+    static void backoff(int &attempt) {
+        if (attempt >= 128) std::this_thread::sleep_for(std::chrono::microseconds(50));
+        else if (attempt >= 64) std::this_thread::yield();
+        attempt++;
+    }
+
+public:
+    // capacity is rounded up to a power of two (at least 2)
+    explicit BoundedQueue(size_t capacity) : enqueuePos(0), dequeuePos(0), producers(0) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells = new Cell[size];
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~BoundedQueue() {
+        delete[] cells;
+    }
+
+    // Moves value into the queue; false (value untouched) when full
+    bool tryPush(T &value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves the oldest element into out; false when empty
+    bool tryPop(T &out) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->data);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Push, waiting while the queue is full (backpressure)
+     * @param waitSeconds Incremented by the time spent blocked
+     */
+    void push(T &value, double &waitSeconds) {
+        if (tryPush(value)) return;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        int attempt = 0;
+        while (!tryPush(value)) backoff(attempt);
+        waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    /**
+     * Pop, waiting while the queue is empty but producers remain
+     * @param waitSeconds Incremented by the time spent starved
+     * @return false at end of stream
+     */
+    bool pop(T &out, double &waitSeconds) {
+        if (tryPop(out)) return true;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        int attempt = 0;
+        bool ok = true;
+        while (!tryPop(out)) {
+            if (producers.load(std::memory_order_acquire) == 0) {
+                // the last producer may have pushed just before leaving
+                ok = tryPop(out);
+                break;
+            }
+            backoff(attempt);
+        }
+        waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return ok;
+    }
+
+    void addProducer() {
+        producers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void producerDone() {
+        producers.fetch_sub(1, std::memory_order_release);
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef CORPUSCACHE_HPP
+#define CORPUSCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class CorpusCache
+ * @brief Memory-mapped binary cache of a tokenized corpus
+ *
+ * Stores the vocabulary, the class names, every document's token ids in
+ * CSR form (docOffsets + tokenIds) and one label id per document. The file
+ * is keyed by a content hash of the dataset, the stopword file and the
+ * preprocessing configuration; open() rejects a file whose key differs, so
+ * a stale cache is rebuilt rather than trusted.
+ *
+ * Token ids follow first-seen order, the same numbering as
+ * Vectorizer::buildVocabulary, so the cached vocabulary can be installed
+ * as is.
+ */
+class CorpusCache {
+private:
+    void *mapping;          // mmap'd file (or heap copy where mmap is unavailable)
+    size_t mappingSize;
+    bool mapped;
+
+    std::vector<std::string> vocabulary;
+    std::vector<std::string> classes;
+    const uint64_t *docOffsets;   // numDocs + 1 entries into tokenIds
+    const uint32_t *tokenIds;
+    const uint32_t *labelIds;
+    size_t numDocs;
+
+    CorpusCache(const CorpusCache &);
+    CorpusCache &operator=(const CorpusCache &);
+
+public:
+    CorpusCache();
+    ~CorpusCache();
+
+    // FNV-1a over the file contents, 0 if the file cannot be read
+    static uint64_t hashFile(const std::string &path);
+    static uint64_t hashString(const std::string &s, uint64_t seed = 1469598103934665603ULL);
+
+    // Cache key from the dataset, the stopword file and the preprocessing signature
+    static uint64_t computeKey(const std::string &dataPath, const std::string &stopPath,
+                               const std::string &configSignature);
+
+    /**
+     * Write a cache file
+     * @param docs Token ids per document (ids index into vocab)
+     * @param labelIds Class index per document (indexes into classList)
+     */
+    static bool write(const std::string &path, uint64_t key,
+                      const std::vector<std::string> &vocab,
+                      const std::vector<std::string> &classList,
+                      const std::vector<std::vector<uint32_t>> &docs,
+                      const std::vector<uint32_t> &labelIds);
+
+    // Map a cache file; false if missing, corrupt (offsets out of order, ids out of range)
+    // or built for a different key
+    bool open(const std::string &path, uint64_t key);
+    void close();
+    bool isOpen() const;
+
+    size_t getDocumentCount() const;
+    const std::vector<std::string> &getVocabulary() const;
+    const std::vector<std::string> &getClasses() const;
+
+    // Token ids of document i: pointer to the first id, count via tokenCount(i)
+    const uint32_t *tokens(size_t i) const;
+    size_t tokenCount(size_t i) const;
+    uint32_t label(size_t i) const;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef COUNTMINNAIVEBAYES_HPP
+#define COUNTMINNAIVEBAYES_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @class CountMinNaiveBayes
+ * @brief Multinomial Naive Bayes over a count-min sketch, for unbounded token streams
+ *
+ * Per-(class, token) counts live in one depth x width table of uint32
+ * counters sized from a hard memory cap at construction; new words never
+ * allocate. A count is the minimum over the depth rows, which can only
+ * over-estimate (collisions). With conservative update an increment
+ * raises only the counters at that minimum, which shrinks the error.
+ * The vocabulary size in the Laplace denominator is estimated with a
+ * 1 KB HyperLogLog. Class names, document counts and token totals are
+ * exact (a few bytes per class).
+ */
+class CountMinNaiveBayes {
+private:
+    int depth;
+    uint32_t width;
+    bool conservative;
+    std::vector<uint32_t> table;           // [row * width + column]
+    std::vector<uint8_t> distinctRegisters;   // HyperLogLog of the distinct tokens
+    std::vector<std::string> classes;
+    std::vector<int64_t> classDocCount;
+    std::vector<int64_t> classTokenTotal;
+    int64_t documentTotal;
+
+    // Helper: 64-bit hash of a token (FNV-1a plus a splitmix finaliser)
+    static uint64_t hashToken(const std::string &token);
+
+    // Helper: the depth columns of (class, token), by double hashing one mixed key
+    void cells(uint64_t tokenHash, int classId, uint32_t *columns) const;
+
+    uint32_t estimate(uint64_t tokenHash, int classId) const;
+    void addToken(uint64_t tokenHash, int classId, uint32_t count);
+    int classIndex(const std::string &label);
+
+public:
+    /**
+     * @param memoryBytes Hard cap for the counter table and the HyperLogLog
+     * @param sketchDepth Independent rows, 1..16 (more rows: fewer over-estimates, more probes)
+     * @param conservativeUpdate Raise only the minimum counters on insert
+     */
+    CountMinNaiveBayes(size_t memoryBytes, int sketchDepth = 4, bool conservativeUpdate = true);
+
+    // Count one labelled document (e.g. one row of a stream)
+    void addDocument(const std::vector<std::string> &tokens, const std::string &label);
+    void train(const std::vector<std::vector<std::string>> &docs, const std::vector<std::string> &labels);
+
+    std::string predict(const std::vector<std::string> &tokens) const;
+    double accuracy(const std::vector<std::vector<std::string>> &docs,
+                    const std::vector<std::string> &labels) const;
+
+    // Sketch estimate of count(word in class); >= the exact count
+    uint32_t getCount(const std::string &className, const std::string &word) const;
+    double estimateVocabularySize() const;
+
+    const std::vector<std::string> &getClasses() const;
+    uint32_t getWidth() const;
+    int getDepth() const;
+    size_t sizeBytes() const;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef CSVSTREAM_HPP
+#define CSVSTREAM_HPP
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+/**
+ * @class CsvStream
+ * @brief Row-at-a-time reader for the text,label dataset format
+ *
+ * Skips the header line and splits each row on its last comma, so the
+ * text itself may contain commas. Rows without a comma are skipped.
+ * Only the current line is held in memory.
+ */
+class CsvStream {
+private:
+    std::ifstream in;
+    std::string line;
+    bool headerSkipped;
+    size_t rows;
+    uint64_t bytes;
+
+public:
+    explicit CsvStream(const std::string &path);
+
+    bool isOpen() const;
+
+    // Read the next row; returns false at end of file
+    bool next(std::string &text, std::string &label);
+
+    size_t getRowCount() const;
+    uint64_t getBytesRead() const;
+};
+
+#endif
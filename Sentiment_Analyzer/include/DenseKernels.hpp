@@ -0,0 +1,78 @@
+#ifndef DENSEKERNELS_HPP
+#define DENSEKERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/**
+ * @class DenseKernels
+ * @brief BLAS-1 style dot / axpy / norm / scale over contiguous float and double buffers
+ *
+ * Every call dispatches on FastMath::getKernel(): AVX2+FMA (4 doubles or
+ * 8 floats per instruction, four independent accumulators), SSE2, or a
+ * plain scalar loop. EMOTION_SIMD therefore selects the kernel for both
+ * modules. Reductions change the summation order, so results can differ
+ * from a sequential loop in the last few bits. Float inputs accumulate in
+ * double. Unaligned buffers are accepted; AlignedVector keeps hot buffers
+ * on 32-byte boundaries so no load straddles a cache line.
+ */
+class DenseKernels {
+public:
+    static double dot(const double *a, const double *b, size_t n);
+    static double dot(const float *a, const float *b, size_t n);
+
+    // y += alpha * x
+    static void axpy(double alpha, const double *x, double *y, size_t n);
+    static void axpy(float alpha, const float *x, float *y, size_t n);
+
+    static double squaredNorm(const double *x, size_t n);
+    static double squaredNorm(const float *x, size_t n);
+    static double norm(const double *x, size_t n);
+    static double norm(const float *x, size_t n);
+
+    // x *= alpha
+    static void scale(double alpha, double *x, size_t n);
+    static void scale(float alpha, float *x, size_t n);
+};
+
+/**
+ * @class AlignedAllocator
+ * @brief std::vector allocator returning Alignment-byte aligned storage
+ */
+template <class T, size_t Alignment = 32>
+class AlignedAllocator {
+public:
+    typedef T value_type;
+    template <class U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+    AlignedAllocator() {}
+    template <class U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t n) {
+        // over-allocate, align, and keep the malloc pointer just below the aligned block
+        void *raw = std::malloc(n * sizeof(T) + Alignment + sizeof(void *));
+        if (!raw) throw std::bad_alloc();
+        uintptr_t aligned = ((uintptr_t)raw + sizeof(void *) + Alignment - 1) & ~(uintptr_t)(Alignment - 1);
+        reinterpret_cast<void **>(aligned)[-1] = raw;
+        return reinterpret_cast<T *>(aligned);
+    }
+
+    void deallocate(T *p, size_t) {
+        if (p) std::free(reinterpret_cast<void **>(p)[-1]);
+    }
+};
+
+template <class T, class U, size_t A>
+bool operator==(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return true; }
+template <class T, class U, size_t A>
+bool operator!=(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return false; }
+
+template <class T>
+struct AlignedVector {
+    typedef std::vector<T, AlignedAllocator<T> > type;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef EMBEDDEDPREDICTOR_HPP
+#define EMBEDDEDPREDICTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct EmbeddedHash
+ * @brief constexpr string hashing shared by the header exporter and the generated models
+ *
+ * Seeded FNV-1a with a murmur3 finaliser. Everything is a single-return
+ * recursive constexpr function, so C++11 can evaluate it at compile time.
+ */
+struct EmbeddedHash {
+    static constexpr uint32_t fnv1a(const char *s, uint32_t h) {
+        return *s ? fnv1a(s + 1, (h ^ (uint32_t)(unsigned char)*s) * 16777619u) : h;
+    }
+
+    static constexpr uint32_t shiftXor(uint32_t h, int shift) {
+        return h ^ (h >> shift);
+    }
+
+    static constexpr uint32_t hash(const char *s, uint32_t seed) {
+        return shiftXor(shiftXor(shiftXor(fnv1a(s, 2166136261u ^ (seed * 2654435769u)), 16) * 0x85ebca6bu, 13) * 0xc2b2ae35u, 16);
+    }
+
+    static constexpr bool equal(const char *a, const char *b) {
+        return *a == *b && (*a == '\0' || equal(a + 1, b + 1));
+    }
+};
+
+/**
+ * @class EmbeddedPredictor
+ * @brief Header-only Naive Bayes / Logistic Regression scoring over a generated constexpr model
+ *
+ * Model is the struct written by ModelHeaderExporter: class and word
+ * tables, a hash-and-displace perfect hash (bucket = hash(w, 0), slot =
+ * hash(w, displacement[bucket])) and [word][class] weight tables. The
+ * tables live in .rodata, so nothing is loaded or parsed at startup, and
+ * wordId() of a literal can be resolved by the compiler.
+ *
+ * Tokens must come from the same preprocessing as training
+ * (Preprocessor::process). Words outside the vocabulary score as unseen
+ * for Naive Bayes and are ignored by Logistic Regression.
+ */
+template <class Model>
+class EmbeddedPredictor {
+private:
+    static constexpr uint32_t slotOf(const char *word) {
+        return EmbeddedHash::hash(word, Model::displacement()[EmbeddedHash::hash(word, 0) % Model::NUM_BUCKETS]) % Model::TABLE_SIZE;
+    }
+
+    // the slot of an unknown word holds some other word (or -1), so the text is compared once
+    static constexpr int confirm(const char *word, int id) {
+        return id >= 0 && EmbeddedHash::equal(word, Model::words()[id]) ? id : -1;
+    }
+
+    static int argmax(const double *score) {
+        int best = 0;
+        for (int c = 1; c < Model::NUM_CLASSES; ++c) {
+            if (score[c] > score[best]) best = c;
+        }
+        return best;
+    }
+
+public:
+    // Vocabulary id of a word, -1 if unknown
+    static constexpr int wordId(const char *word) {
+        return confirm(word, Model::slotWord()[slotOf(word)]);
+    }
+
+    static int numClasses() { return Model::NUM_CLASSES; }
+    static int numWords() { return Model::NUM_WORDS; }
+    static const char *className(int classId) { return classId < 0 ? "" : Model::classes()[classId]; }
+
+    // Log prior plus one log P(w|c) row per token; returns the class index
+    static int predictNaiveBayes(const std::vector<std::string> &tokens) {
+        double score[Model::NUM_CLASSES];
+        for (int c = 0; c < Model::NUM_CLASSES; ++c) score[c] = Model::nbLogPrior()[c];
+        for (size_t t = 0; t < tokens.size(); ++t) {
+            int id = wordId(tokens[t].c_str());
+            const double *row = id < 0 ? Model::nbLogUnseen() : Model::nbLogCond() + (size_t)id * Model::NUM_CLASSES;
+            for (int c = 0; c < Model::NUM_CLASSES; ++c) score[c] += row[c];
+        }
+        return argmax(score);
+    }
+
+    // Linear scores z_c over the bag-of-words counts (argmax matches the sigmoid argmax)
+    static int predictLogistic(const std::vector<std::string> &tokens) {
+        double score[Model::NUM_CLASSES];
+        for (int c = 0; c < Model::NUM_CLASSES; ++c) score[c] = Model::lrBias()[c];
+        for (size_t t = 0; t < tokens.size(); ++t) {
+            int id = wordId(tokens[t].c_str());
+            if (id < 0) continue;
+            const double *row = Model::lrWeights() + (size_t)id * Model::NUM_CLASSES;
+            for (int c = 0; c < Model::NUM_CLASSES; ++c) score[c] += row[c];
+        }
+        return argmax(score);
+    }
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef ENSEMBLEPREDICTOR_HPP
+#define ENSEMBLEPREDICTOR_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "NaiveBayes.hpp"
+#include "LogisticRegression.hpp"
+#include "VSM.hpp"
+
+/**
+ * @class EnsemblePredictor
+ * @brief Scores NB, LR and VSM from a single fused sparse traversal
+ *
+ * At build time the three trained models are compiled into one term-major
+ * table: for every vocabulary id a row of 3 x classes doubles holding
+ * log P(w|c), the LR weight and the norm-divided VSM centroid value. A query is mapped token -> id once and each distinct id reads a
+ * single contiguous row, so the combined model costs about as much as one.
+ *
+ * Per-model scores are turned into class distributions (NB posterior,
+ * normalized LR sigmoids, normalized positive cosine) and combined either
+ * by weighted soft voting or by a stacked softmax layer fitted on them.
+ */
+class EnsemblePredictor {
+public:
+    enum CombineMode {
+        COMBINE_WEIGHTED_VOTE,
+        COMBINE_STACKING
+    };
+
+    struct Scores {
+        std::vector<double> nb;        // NB posterior P(c|doc)
+        std::vector<double> lr;        // normalized LR sigmoid outputs
+        std::vector<double> vsm;       // normalized positive cosine similarity
+        std::vector<double> combined;  // final class distribution
+    };
+
+private:
+    std::vector<std::string> classes;
+    int numClasses;
+    std::unordered_map<std::string, int> vocabIndex;
+
+    std::vector<double> termTable;     // [id * 3C]: NB log-prob | LR weight | VSM centroid / |centroid|
+    std::vector<double> idf;
+    std::vector<double> nbLogPrior;
+    std::vector<double> nbLogUnseen;
+    std::vector<double> lrBias;
+
+    CombineMode mode;
+    double weightNB, weightLR, weightVSM;
+    std::vector<double> stackWeights;  // C x (3C + 1), last column is the bias
+
+    // Helper: fused traversal producing the three per-model distributions.
+    // Id buffers come from the calling thread's scratch arena.
+    void scoreModels(const std::string *tokens, size_t count, Scores &out) const;
+
+    // Helper: apply the stacking layer to [nb | lr | vsm]
+    void stackedDistribution(const Scores &s, std::vector<double> &out) const;
+
+public:
+    EnsemblePredictor();
+
+    /**
+     * Compile the trained models into the fused table
+     * @param vocab Vocabulary shared by LR and VSM (id = position)
+     */
+    void build(const std::vector<std::string> &vocab,
+               const NaiveBayes &nb,
+               const LogisticRegression &lr,
+               const VSM &vsm);
+
+    void setWeights(double nb, double lr, double vsm);
+    void setMode(CombineMode m);
+
+    /**
+     * Fit the stacking layer (softmax regression over the 3C model outputs).
+     * Use documents the base models were not trained on to avoid overfitting.
+     */
+    void fitStacking(const std::vector<std::vector<std::string>> &docs,
+                     const std::vector<std::string> &labels,
+                     int epochs = 50, double learningRate = 0.1);
+
+    void score(const std::vector<std::string> &tokens, Scores &out) const;
+    void score(const std::string *tokens, size_t count, Scores &out) const;
+
+    /**
+     * Allocation-free once warmed up: scratch buffers are per-thread and reused.
+     * Pair with Preprocessor::processInto(text, ScratchContext::local()).
+     */
+    int predictId(const std::string *tokens, size_t count) const;
+    int predictId(const std::vector<std::string> &tokens) const;
+    std::string predict(const std::vector<std::string> &tokens) const;
+
+    const std::vector<std::string> &getClasses() const;
+    bool isBuilt() const;
+};
+
+#endif
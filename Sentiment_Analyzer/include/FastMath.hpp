@@ -0,0 +1,48 @@
+#ifndef FASTMATH_HPP
+#define FASTMATH_HPP
+
+#include <cstddef>
+
+/**
+ * @class FastMath
+ * @brief Vectorised exp / log / sigmoid / softmax kernels for the model hot loops
+ *
+ * exp reduces x = n*ln2 + r with |r| <= ln2/2 and evaluates a degree-10
+ * Chebyshev interpolant of e^r; log splits off the binary exponent and
+ * evaluates a degree-6 interpolant of atanh in s^2. Each polynomial is sized
+ * so its truncation stays below 4e-16, and the kernels stay within a few ulp
+ * of libm (relative error below 1e-14, see Benchmarks::fastMath) over the
+ * whole double range, including subnormals, +-inf and NaN.
+ *
+ * The array kernels process 4 lanes with AVX2+FMA or 2 with SSE2, chosen
+ * once from the CPU features; the scalar fallback is std::exp / std::log,
+ * since one lane of polynomial never beats libm. EMOTION_SIMD=scalar|sse2|avx2
+ * overrides the choice; DenseKernels follows the same selection.
+ */
+class FastMath {
+public:
+    enum Kernel { SCALAR = 0, SSE2 = 1, AVX2 = 2 };
+
+    static double exp(double x);
+    static double log(double x);
+    static double sigmoid(double x);
+
+    // out[i] = f(in[i]) for n values; in and out may be the same array
+    static void expArray(const double *in, double *out, size_t n);
+    static void logArray(const double *in, double *out, size_t n);
+    static void sigmoidArray(const double *in, double *out, size_t n);
+
+    // v[i] = exp(v[i] - max) / sum, in place; an all -inf vector becomes uniform
+    static void softmax(double *v, size_t n);
+
+    // log(sum(exp(v[i]))) without overflow; -inf for an empty or all -inf vector
+    static double logSumExp(const double *v, size_t n);
+
+    static bool supports(Kernel k);
+    static Kernel getKernel();
+    // Switch the array kernels (e.g. to compare them); false if the CPU lacks k
+    static bool setKernel(Kernel k);
+    static const char *kernelName(Kernel k);
+};
+
+#endif
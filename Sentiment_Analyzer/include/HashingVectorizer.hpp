@@ -0,0 +1,51 @@
+#ifndef HASHINGVECTORIZER_HPP
+#define HASHINGVECTORIZER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "SparseVector.hpp"
+
+/**
+ * @class HashingVectorizer
+ * @brief Vocabulary-free n-gram feature extraction via feature hashing
+ *
+ * Word n-grams (and optionally character n-grams inside each token) are
+ * hashed with MurmurHash3 into a fixed 2^numBits feature space. With signed
+ * hashing one hash bit picks +1/-1 so collisions cancel out in expectation.
+ * The vectorizer holds no mutable state, so documents can be transformed
+ * from several threads at once.
+ */
+class HashingVectorizer {
+private:
+    int numBits;
+    int wordMinN, wordMaxN;   // word n-gram range (1..3 by default)
+    int charMinN, charMaxN;   // char n-gram range (0 disables)
+    bool signedHash;
+    uint32_t seed;
+
+    // Helper: MurmurHash3 x86_32
+    static uint32_t murmur3(const char *key, int len, uint32_t seed);
+
+    // Helper: hash one feature string and append (index, sign) to features
+    void addFeature(const std::string &feature, uint32_t featureSeed,
+                    std::vector<std::pair<int, double> > &features) const;
+
+public:
+    HashingVectorizer(int bits = 18, int wordMin = 1, int wordMax = 3,
+                      int charMin = 0, int charMax = 0, bool signedHashing = true);
+
+    SparseVector transformSingle(const std::vector<std::string> &tokens) const;
+
+    // Same features into out; n-gram and sort buffers are per-thread, so a warm call does not allocate
+    void transformSingle(const std::string *tokens, size_t count, SparseVector &out) const;
+
+    // numThreads <= 1 runs serially, otherwise on the shared ThreadPool
+    std::vector<SparseVector> transform(const std::vector<std::vector<std::string>> &documents,
+                                        int numThreads = 1) const;
+
+    int getDimension() const;
+};
+
+#endif
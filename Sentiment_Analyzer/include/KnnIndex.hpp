@@ -0,0 +1,62 @@
+#ifndef KNNINDEX_HPP
+#define KNNINDEX_HPP
+
+#include <vector>
+#include <cstddef>
+#include "SparseVector.hpp"
+#include "PostingList.hpp"
+
+/**
+ * @class KnnIndex
+ * @brief Inverted index over unit-length TF-IDF documents with WAND top-k search
+ *
+ * Each term keeps a doc-id ordered, compressed posting list of (doc, weight)
+ * plus the largest weight in the list. A query walks the postings of its own terms
+ * only; WAND uses the per-term upper bounds to skip documents that cannot
+ * enter the current top-k, so most of the corpus is never scored.
+ *
+ * pruneFactor trades recall for speed: 1.0 returns the exact top-k, larger
+ * values raise the entry threshold and skip more candidates.
+ */
+class KnnIndex {
+public:
+    struct Neighbor {
+        int doc;
+        double score;   // cosine similarity (dot product of unit vectors)
+    };
+
+private:
+    std::vector<PostingList> postings;   // indexed by term id
+    int numDocs;
+    double pruneFactor;
+
+public:
+    KnnIndex();
+
+    /**
+     * Build the index from L2-normalized sparse documents (doc id = position)
+     * @param numTerms Vocabulary size; term ids outside [0, numTerms) are ignored
+     */
+    void build(const std::vector<SparseVector> &docs, int numTerms);
+    void clear();
+
+    void setPruneFactor(double factor);
+    double getPruneFactor() const;
+
+    /**
+     * Approximate top-k by similarity, best first. The heap is kept in out and
+     * the cursors in per-thread buffers, so a warm call does not allocate.
+     * @param docsScored Optional out-parameter: documents fully scored by this query
+     */
+    void search(const SparseVector &query, int k, std::vector<Neighbor> &out,
+                size_t *docsScored = 0) const;
+
+    // Exhaustive top-k over the same postings (term-at-a-time), for recall checks
+    void searchExact(const SparseVector &query, int k, std::vector<Neighbor> &out) const;
+
+    int getDocumentCount() const;
+    size_t getPostingCount() const;
+    size_t sizeBytes() const;
+};
+
+#endif
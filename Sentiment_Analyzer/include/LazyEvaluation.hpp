@@ -0,0 +1,49 @@
+#ifndef LAZYEVALUATION_HPP
+#define LAZYEVALUATION_HPP
+
+#include <string>
+#include <vector>
+#include <future>
+#include <functional>
+#include <memory>
+#include "ModelEvaluator.hpp"
+
+/**
+ * @class LazyEvaluation
+ * @brief Training-set metrics for one model, computed in the background or on first use
+ *
+ * schedule() captures how to predict the evaluation set. In async mode the
+ * predictions and metrics are computed on the shared ThreadPool right away, so
+ * they overlap with training the next model. In deferred mode nothing runs
+ * until get() is first called, and the result is cached after that.
+ */
+class LazyEvaluation {
+public:
+    typedef std::function<std::vector<std::string>()> PredictAll;
+
+private:
+    std::shared_future<ModelEvaluator::EvaluationMetrics> result;
+    bool scheduled;
+
+public:
+    LazyEvaluation();
+
+    /**
+     * @param predictAll Returns one predicted label per evaluation document
+     * @param labels True labels, shared so the caller may drop its copy
+     * @param async true = start now on a worker thread, false = run on first get()
+     */
+    void schedule(PredictAll predictAll,
+                  std::shared_ptr<const std::vector<std::string>> labels,
+                  const std::vector<std::string> &uniqueLabels,
+                  bool async);
+
+    // Forget the result (waits for a running evaluation, skips a deferred one)
+    void clear();
+
+    bool available() const;   // something has been scheduled
+    bool isReady() const;     // metrics already computed
+    const ModelEvaluator::EvaluationMetrics &get() const;
+};
+
+#endif
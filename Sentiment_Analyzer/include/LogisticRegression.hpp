@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include "SparseVector.hpp"
+#include "BatchPrediction.hpp"
 
 /**
  * @class LogisticRegression
@@ -11,6 +13,12 @@
  * 
  * Implements multi-class logistic regression with stochastic gradient descent
  * for emotion classification from text features.
+ *
+ * Optional elastic-net regularisation (L1 + L2) drives most weights to
+ * exactly zero: the sparse trainer applies the L1 part as a cumulative
+ * truncated gradient (Tsuruoka et al. 2009) and the L2 shrink lazily, so a
+ * step still only touches the active features. The dense trainer takes a
+ * proximal (soft-threshold) step after every sample.
  */
 class LogisticRegression {
 private:
@@ -19,21 +27,76 @@ private:
     std::map<std::string, double> bias;
     double learningRate;
     int epochs;
-    
-    // Helper: sigmoid function
-    double sigmoid(double x);
+    double l1Penalty;   // 0 = no L1
+    double l2Penalty;   // 0 = no L2
     
     // Helper: one-hot encode labels
     std::vector<std::vector<int>> oneHotEncode(const std::vector<std::string> &labels);
+
+    // Helper: append unseen classes (zero weights) and zero-pad every class to numFeatures
+    void growModel(const std::vector<std::string> &labels, int numFeatures);
     
 public:
     LogisticRegression(double lr = 0.01, int ep = 100);
+
+    // Elastic-net strengths for the next trainFromVectors / trainFromSparse (sgdStep is unregularised)
+    void setRegularization(double l1, double l2 = 0.0);
+    double getL1Penalty() const;
+    double getL2Penalty() const;
+
+    // Collect unique classes (first-seen order) and zero-initialize weights of the given width
+    void initModel(const std::vector<std::string> &labels, int numFeatures);
+
+    /**
+     * One SGD update on a single sample, for callers that stream their own
+     * data (call initModel first).
+     * @param classId Index of the true class in getClasses()
+     * @return Class index predicted before the update (for progressive validation)
+     */
+    int sgdStep(const SparseVector &x, int classId);
     
     void trainFromVectors(const std::vector<std::vector<int>> &vectors, 
                           const std::vector<std::string> &labels);
-    std::string predict(const std::vector<int> &vector);
+
+    /**
+     * Continue SGD from the current weights on a new mini-batch (unregularised,
+     * like sgdStep). New classes are appended and every weight row is
+     * zero-padded to numFeatures, so existing class and feature ids stay
+     * valid; a vocabulary only ever grows at the end (Vectorizer::extendVocabulary).
+     * @param passes Epochs over this batch
+     * @return Progressive accuracy of the first pass (each sample scored before its update)
+     */
+    double partialFit(const std::vector<SparseVector> &vectors,
+                      const std::vector<std::string> &labels,
+                      int numFeatures, int passes = 1);
+    double partialFit(const std::vector<std::vector<int>> &vectors,
+                      const std::vector<std::string> &labels, int passes = 1);
+    std::string predict(const std::vector<int> &vector) const;
+
+    // Sparse variants: cost per sample is O(nnz x classes) instead of O(vocab x classes)
+    void trainFromSparse(const std::vector<SparseVector> &vectors,
+                         const std::vector<std::string> &labels,
+                         int numFeatures);
+    std::string predictSparse(const SparseVector &vector) const;
+    int predictSparseId(const SparseVector &vector) const;   // index into getClasses(), -1 untrained
+
+    /**
+     * Score many documents per call. Scores are one-vs-rest sigmoid outputs.
+     * The dense path tiles documents x features so each weight block is
+     * reused across a block of documents while it is still in cache.
+     * @param docs Pointer to the first document, count documents are read
+     */
+    BatchPrediction predictBatch(const std::vector<int> *docs, size_t count) const;
+    BatchPrediction predictBatch(const std::vector<std::vector<int>> &docs) const;
+    BatchPrediction predictBatchSparse(const SparseVector *docs, size_t count) const;
+    BatchPrediction predictBatchSparse(const std::vector<SparseVector> &docs) const;
+
+    // Read-only access to the trained parameters (e.g. for quantized export)
+    const std::vector<std::string> &getClasses() const;
+    const std::vector<double> &getWeights(const std::string &className) const;
+    double getBias(const std::string &className) const;
     double accuracy(const std::vector<std::vector<int>> &vectors, 
-                    const std::vector<std::string> &labels);
+                    const std::vector<std::string> &labels) const;
 };
 
 #endif
@@ -0,0 +1,117 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @class Metrics
+ * @brief Process-wide registry of counters and latency histograms
+ *
+ * Hot paths record into counters and log-bucketed histograms through the
+ * METRIC_* macros below. Snapshots can be exported as Prometheus text or JSON.
+ * Build with -DEMOTION_METRICS to enable; otherwise the macros compile to nothing.
+ */
+class Metrics {
+public:
+    class Counter {
+    private:
+        std::atomic<uint64_t> value;
+    public:
+        Counter() : value(0) {}
+        void add(uint64_t delta) { value.fetch_add(delta, std::memory_order_relaxed); }
+        uint64_t get() const { return value.load(std::memory_order_relaxed); }
+        void reset() { value.store(0, std::memory_order_relaxed); }
+    };
+
+    /**
+     * Histogram over microsecond-scale values with power-of-two buckets.
+     * Bucket i counts observations in [2^(i-1), 2^i); bucket 0 holds values < 1.
+     */
+    class Histogram {
+    public:
+        static const int NUM_BUCKETS = 40;
+    private:
+        std::atomic<uint64_t> buckets[NUM_BUCKETS];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sumNanos;
+    public:
+        Histogram();
+        void observe(double micros);
+        uint64_t getCount() const;
+        double getSum() const;                 // in microseconds
+        double percentile(double p) const;     // p in [0, 1], interpolated within bucket
+        static double bucketUpperBound(int i);
+        uint64_t bucketCount(int i) const;
+        void reset();
+    };
+
+    /**
+     * RAII timer that records elapsed microseconds into a histogram
+     */
+    class ScopedTimer {
+    private:
+        Histogram &hist;
+        std::chrono::steady_clock::time_point start;
+    public:
+        explicit ScopedTimer(Histogram &h) : hist(h), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            std::chrono::steady_clock::duration d = std::chrono::steady_clock::now() - start;
+            hist.observe(std::chrono::duration<double, std::micro>(d).count());
+        }
+    };
+
+    static Metrics &instance();
+
+    // Registered objects live until process exit, so references can be cached
+    Counter &counter(const std::string &name);
+    Histogram &histogram(const std::string &name);
+
+    std::string toPrometheus();
+    std::string toJSON();
+    void reset();
+
+    static bool enabled();
+
+private:
+    Metrics() {}
+    Metrics(const Metrics &);
+    Metrics &operator=(const Metrics &);
+
+    std::mutex lock;
+    std::map<std::string, Counter *> counters;
+    std::map<std::string, Histogram *> histograms;
+};
+
+#define METRIC_CONCAT_INNER(a, b) a##b
+#define METRIC_CONCAT(a, b) METRIC_CONCAT_INNER(a, b)
+
+#ifdef EMOTION_METRICS
+// Time the enclosing scope into histogram `name` (microseconds)
+#define METRIC_TIMER(name) \
+    static Metrics::Histogram &METRIC_CONCAT(metricHist_, __LINE__) = Metrics::instance().histogram(name); \
+    Metrics::ScopedTimer METRIC_CONCAT(metricTimer_, __LINE__)(METRIC_CONCAT(metricHist_, __LINE__))
+// Add `delta` to counter `name`
+#define METRIC_COUNT(name, delta) \
+    do { \
+        static Metrics::Counter &metricCounter_ = Metrics::instance().counter(name); \
+        metricCounter_.add((uint64_t)(delta)); \
+    } while (0)
+// Record a raw value (microseconds) into histogram `name`
+#define METRIC_OBSERVE(name, value) \
+    do { \
+        static Metrics::Histogram &metricHist_ = Metrics::instance().histogram(name); \
+        metricHist_.observe((double)(value)); \
+    } while (0)
+#else
+#define METRIC_TIMER(name) do {} while (0)
+#define METRIC_COUNT(name, delta) do {} while (0)
+#define METRIC_OBSERVE(name, value) do {} while (0)
+#endif
+
+#endif
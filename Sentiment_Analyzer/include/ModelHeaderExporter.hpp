@@ -0,0 +1,53 @@
+#ifndef MODELHEADEREXPORTER_HPP
+#define MODELHEADEREXPORTER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "NaiveBayes.hpp"
+#include "LogisticRegression.hpp"
+
+/**
+ * @class ModelHeaderExporter
+ * @brief Writes trained NB + LR models and their vocabulary as a constexpr C++ header
+ *
+ * The generated header defines the tables as constexpr arrays plus a
+ * Model struct for EmbeddedPredictor<Model>, so an embedded binary starts
+ * with the model in .rodata: no file I/O, no parsing, no training.
+ * Vocabulary lookup is a hash-and-displace perfect hash built here:
+ * words are grouped into buckets of about four, and each bucket (largest
+ * first) gets the first seed that sends all of its words to free slots.
+ * Classes are the NB classes followed by any LR-only ones; a class one
+ * model does not know scores -inf in that model.
+ */
+class ModelHeaderExporter {
+public:
+    struct Report {
+        size_t words;
+        size_t classes;
+        uint32_t buckets;
+        uint32_t tableSize;
+        uint32_t maxDisplacement;
+        size_t tableBytes;   // rodata of the weight and hash tables (strings excluded)
+
+        Report() : words(0), classes(0), buckets(0), tableSize(0), maxDisplacement(0), tableBytes(0) {}
+    };
+
+    /**
+     * @param namespaceName C++ namespace for the generated tables (also names the include guard)
+     * @return false if the models are untrained, the namespace is not an identifier or the file cannot be written
+     */
+    static bool write(const std::string &path, const std::string &namespaceName,
+                      const std::vector<std::string> &vocab,
+                      const NaiveBayes &nb, const LogisticRegression &lr, Report &report);
+
+    /**
+     * Build the perfect hash for words
+     * @param displacement Seed per bucket
+     * @param slotWord Word id per slot, -1 for an empty slot
+     */
+    static void buildPerfectHash(const std::vector<std::string> &words,
+                                 std::vector<uint32_t> &displacement, std::vector<int32_t> &slotWord);
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef MODELSNAPSHOT_HPP
+#define MODELSNAPSHOT_HPP
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "Preprocessor.hpp"
+#include "Vectorizer.hpp"
+#include "NaiveBayes.hpp"
+#include "VSM.hpp"
+#include "LogisticRegression.hpp"
+#include "HashingVectorizer.hpp"
+#include "EnsemblePredictor.hpp"
+#include "ScratchArena.hpp"
+
+/**
+ * @struct ModelSnapshot
+ * @brief One frozen generation of the preprocessing pipeline and every model
+ *
+ * A snapshot is filled in once and then only reached through a
+ * shared_ptr<const ModelSnapshot>. Every query path is a const member call
+ * that reads shared state only (scratch buffers are per-thread), so any
+ * number of threads may score against the same snapshot without locks.
+ *
+ * The online path tokenizes into a ScratchContext and every model writes
+ * into reused buffers, so once the buffers are warm a prediction makes no
+ * heap allocation (Benchmarks::scratchAllocations checks it). Labels are
+ * copied into out's strings, which keep their capacity between calls.
+ */
+struct ModelSnapshot {
+    struct Predictions {
+        std::string nb;
+        std::string vsm;
+        std::string vsmKnn;
+        std::string lr;
+        std::string hashLr;
+        std::string ensemble;
+    };
+
+    Preprocessor pre;
+    Vectorizer vec;
+    NaiveBayes nb;
+    VSM vsm;
+    LogisticRegression lr;
+    HashingVectorizer hashVec;
+    LogisticRegression hashLr;
+    EnsemblePredictor ensemble;
+    unsigned long version;   // set by ModelRegistry::publish
+
+    ModelSnapshot();
+
+    /**
+     * Run every model on one raw text, through the calling thread's ScratchContext
+     * @return false when preprocessing leaves no tokens (out is untouched)
+     */
+    bool predict(const std::string &text, Predictions &out) const;
+    bool predict(const std::string &text, ScratchContext &ctx, Predictions &out) const;
+
+    // Run every model on already preprocessed tokens (e.g. ctx.tokens after Preprocessor::processInto)
+    void predictTokens(const std::string *tokens, size_t count, ScratchContext &ctx, Predictions &out) const;
+    void predictTokens(const std::vector<std::string> &tokens, Predictions &out) const;
+};
+
+/**
+ * @class ModelRegistry
+ * @brief RCU-style holder of the snapshot that is currently being served
+ *
+ * The current snapshot hangs off an immutable Slot reached through a plain
+ * std::atomic<Slot *>, which is lock-free on every target we build for
+ * (isLockFree() reports it). acquire() protects the slot with a hazard
+ * pointer: it claims a free hazard record with one CAS, re-checks that the
+ * slot is still current and copies the slot's shared_ptr (an atomic
+ * reference-count increment). No reader ever takes a lock, so a retrain
+ * causes no pause in serving. Readers keep using the snapshot they got
+ * for the whole request.
+ *
+ * publish() swaps in a new slot; the old slot is freed once no hazard
+ * record points at it, and the old snapshot is retired rather than
+ * dropped: the writer keeps it and frees it on a later publish once no
+ * reader holds it, so the cost of tearing a model down never lands on a
+ * serving thread.
+ */
+class ModelRegistry {
+private:
+    struct Slot {
+        std::shared_ptr<const ModelSnapshot> snapshot;   // never modified after publish
+    };
+
+    static const int NUM_HAZARDS = 64;   // concurrent acquire() calls beyond this spin for a record
+
+    std::atomic<Slot *> current;
+    mutable std::atomic<Slot *> hazards[NUM_HAZARDS];   // null = free record; written by readers
+    std::atomic<unsigned long> lastVersion;
+    std::mutex writerLock;                                       // serializes publishers only
+    std::vector<Slot *> retiredSlots;                            // replaced, maybe still protected
+    std::vector<std::shared_ptr<const ModelSnapshot> > retired;  // replaced, maybe still being read
+
+    // Helper: free retired slots no hazard points at and snapshots no reader holds (writerLock held)
+    void reclaim();
+
+    ModelRegistry(const ModelRegistry &);
+    ModelRegistry &operator=(const ModelRegistry &);
+
+public:
+    ModelRegistry();
+    ~ModelRegistry();
+
+    // Snapshot being served right now (null before the first publish); lock-free
+    std::shared_ptr<const ModelSnapshot> acquire() const;
+
+    // Stamp the next version on snapshot, make it current and return that version
+    unsigned long publish(std::shared_ptr<ModelSnapshot> snapshot);
+
+    unsigned long getVersion() const;
+    size_t getRetiredCount();
+
+    // True when the atomics on the read path need no hidden lock on this target
+    bool isLockFree() const;
+};
+
+#endif
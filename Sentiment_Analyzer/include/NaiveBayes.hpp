@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include "BatchPrediction.hpp"
+#include "NaiveBayesCounts.hpp"
 
 /**
  * @class NaiveBayes
@@ -16,25 +19,73 @@
 class NaiveBayes {
 private:
     std::vector<std::string> classes; // list of emotion labels
-    std::map<std::string, int> classDocCount;      // number of documents per class
-    std::map<std::string, int> totalWordsInClass;  // total word counts per class
+    std::map<std::string, int64_t> classDocCount;      // number of documents per class
+    std::map<std::string, int64_t> totalWordsInClass;  // total word counts per class
     std::map<std::string, std::map<std::string, int> > wordCountPerClass; // counts of each word per class
     std::map<std::string, double> priorProb;       // prior P(class)
-    std::map<std::string, std::map<std::string, double> > condProb; // P(word|class) (with Laplace)
+    std::map<std::string, std::map<std::string, double> > condProb; // P(word|class) (with Laplace); empty
+                                                                    // after trainFromCountTable, see getConditional
     int vocabSize;
 
+    // log-space scoring tables, filled with the batched FastMath::logArray after training
+    std::unordered_map<std::string, int> wordIds;   // word -> row of logCond
+    std::vector<double> logCond;                     // [word id * classes + class] = log P(w|c)
+    std::vector<double> logUnseen;                   // per class, log P(w|c) for count = 0
+    std::vector<double> logPrior;                    // per class
+
     // helper: check if class exists in classes vector
-    bool classExists(const std::string &c);
+    bool classExists(const std::string &c) const;
+
+    // helper: priors and Laplace-smoothed P(w|c) from the count maps
+    void computeProbabilities(const std::vector<std::string> &vocab, int64_t N);
+
+    // helper: the log tables straight from flat 64-bit count rows, no per-word maps
+    void computeLogTables(const NaiveBayesCounts &counts);
 
 public:
     NaiveBayes();
     void trainFromDocuments(const std::vector<std::vector<std::string>> &docs, 
                             const std::vector<std::string> &labels, 
                             const std::vector<std::string> &vocab);
-    std::string predict(const std::vector<std::string> &tokens);
+
+    /**
+     * Same model as trainFromDocuments, counted in parallel: each pool worker
+     * fills a private count shard and the shards are tree-merged
+     */
+    void trainParallel(const std::vector<std::vector<std::string>> &docs,
+                       const std::vector<std::string> &labels,
+                       const std::vector<std::string> &vocab);
+
+    // Train from merged sufficient statistics (e.g. count files from several machines)
+    void trainFromCountTable(const NaiveBayesCounts &counts);
+
+    std::string predict(const std::vector<std::string> &tokens) const;
+
+    // Index into getClasses() of the prediction (-1 untrained); scores go to a per-thread buffer
+    int predictId(const std::string *tokens, size_t count) const;
     
     double accuracy(const std::vector<std::vector<std::string>> &docs, 
-                    const std::vector<std::string> &labels);
+                    const std::vector<std::string> &labels) const;
+
+    /**
+     * Score many documents per call. Scores are posterior probabilities P(c|doc).
+     * Log-likelihood rows come from the precomputed log table, one lookup per token.
+     * @param docs Pointer to the first tokenized document, count documents are read
+     */
+    BatchPrediction predictBatch(const std::vector<std::string> *docs, size_t count) const;
+    BatchPrediction predictBatch(const std::vector<std::vector<std::string>> &docs) const;
+
+    // Read-only access to the trained model (e.g. for quantized export)
+    const std::vector<std::string> &getClasses() const;
+    double getPrior(const std::string &c) const;
+    // P(w|c) with Laplace smoothing; unseen words get the count=0 estimate
+    double getConditional(const std::string &c, const std::string &w) const;
+    double getUnseenConditional(const std::string &c) const;
+
+    // The precomputed log tables, same class order (e.g. for code generation); nullptr row = unseen word
+    const double *getLogConditionalRow(const std::string &w) const;
+    const std::vector<double> &getLogUnseen() const;
+    const std::vector<double> &getLogPrior() const;
 };
 
 #endif
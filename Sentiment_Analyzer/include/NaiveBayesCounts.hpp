@@ -0,0 +1,73 @@
+#ifndef NAIVEBAYESCOUNTS_HPP
+#define NAIVEBAYESCOUNTS_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * @class NaiveBayesCounts
+ * @brief Mergeable sufficient statistics of a multinomial Naive Bayes model
+ *
+ * Documents per class, tokens per class and a flat [class x word] count
+ * table. Counts are plain sums, so tables built from disjoint slices of a
+ * corpus merge by addition: fromDocuments() counts one slice per pool
+ * worker into a private table and combines them with a tree reduction, and
+ * the same merge() combines count files written by separate processes or
+ * machines. Tables with different class or word lists are aligned by name.
+ */
+class NaiveBayesCounts {
+private:
+    std::vector<std::string> classes;
+    std::vector<std::string> vocab;
+    std::unordered_map<std::string, int> classIndex;
+    std::unordered_map<std::string, int> wordIndex;
+    std::vector<int64_t> docCounts;     // per class
+    std::vector<int64_t> tokenTotals;   // per class, including tokens outside vocab
+    std::vector<int64_t> counts;        // [class * vocab.size() + word]
+
+    // Helper: make room for new classes / words, keeping existing ids
+    void grow(const std::vector<std::string> &moreClasses, const std::vector<std::string> &moreWords);
+
+public:
+    NaiveBayesCounts();
+    NaiveBayesCounts(const std::vector<std::string> &classList, const std::vector<std::string> &words);
+
+    /**
+     * Count a tokenized corpus on the shared ThreadPool (one shard per worker)
+     * Classes are numbered in first-seen order, words by their position in vocab.
+     */
+    static NaiveBayesCounts fromDocuments(const std::vector<std::vector<std::string>> &docs,
+                                          const std::vector<std::string> &labels,
+                                          const std::vector<std::string> &vocab);
+
+    // Add one document; wordIds < 0 are out of vocabulary and only raise the token total
+    void addDocument(int classId, const int *wordIds, size_t count);
+
+    /**
+     * Add a whole class's counts at once, e.g. rows accumulated while the
+     * vocabulary was still growing. Every counted token is in the
+     * vocabulary, so the token total grows by the row sum.
+     * @param width Words in wordCounts (<= vocabulary size; missing words count 0)
+     */
+    void addClassCounts(int classId, int64_t documents, const int64_t *wordCounts, size_t width);
+
+    // this += other (same layout: element-wise add; otherwise aligned by class / word name)
+    void merge(const NaiveBayesCounts &other);
+
+    // Merge a list of tables pairwise in log2(n) rounds on the shared ThreadPool
+    static NaiveBayesCounts reduce(std::vector<NaiveBayesCounts> &shards);
+
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    const std::vector<std::string> &getClasses() const;
+    const std::vector<std::string> &getVocabulary() const;
+    int64_t getDocCount(int classId) const;
+    int64_t getTokenTotal(int classId) const;
+    const int64_t *getRow(int classId) const;   // vocab.size() counts
+    int64_t getDocumentTotal() const;
+};
+
+#endif
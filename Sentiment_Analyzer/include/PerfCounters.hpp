@@ -0,0 +1,38 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <cstdint>
+
+/**
+ * @class PerfCounters
+ * @brief Hardware event counters for a code region via Linux perf_event_open
+ *
+ * Counts user-space events of the calling thread between start() and
+ * stop(). Each event is opened on its own; events the kernel refuses
+ * (no PMU in a VM, perf_event_paranoid, other platforms) report
+ * available() == false and the caller falls back to timing alone.
+ */
+class PerfCounters {
+public:
+    enum Event { L1D_READ_MISSES = 0, LLC_MISSES = 1, INSTRUCTIONS = 2, NUM_EVENTS = 3 };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    bool available(Event e) const;
+    bool anyAvailable() const;
+    void start();
+    void stop();
+    // Count from the last start() / stop() pair
+    uint64_t value(Event e) const;
+    static const char *eventName(Event e);
+
+private:
+    int fds[NUM_EVENTS];
+    uint64_t values[NUM_EVENTS];
+
+    PerfCounters(const PerfCounters &);
+    PerfCounters &operator=(const PerfCounters &);
+};
+
+#endif
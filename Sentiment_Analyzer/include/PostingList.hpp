@@ -0,0 +1,77 @@
+#ifndef POSTINGLIST_HPP
+#define POSTINGLIST_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class PostingList
+ * @brief Compressed (id, weight) postings for one term, laid out for sequential scans
+ *
+ * Ids are stored in blocks of BLOCK_SIZE as varint-encoded deltas followed
+ * by the block's weights as 16-bit fractions of the list maximum. A skip
+ * entry per block (last id, byte offset) lets a cursor jump over whole
+ * blocks without decoding them. Ids must be strictly increasing and weights
+ * non-negative.
+ */
+class PostingList {
+public:
+    static const int BLOCK_SIZE = 128;
+
+private:
+    struct Skip {
+        int lastId;
+        uint32_t offset;
+    };
+
+    std::vector<uint8_t> bytes;
+    std::vector<Skip> skips;
+    size_t length;
+    float maxWeight;
+
+public:
+    PostingList();
+
+    void build(const std::vector<int> &ids, const std::vector<float> &weights);
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    float getMaxWeight() const { return maxWeight; }
+    size_t sizeBytes() const;   // encoded payload plus skip table
+
+    /**
+     * @class Cursor
+     * @brief Forward iterator decoding one block at a time
+     */
+    class Cursor {
+    private:
+        const PostingList *list;
+        size_t block;       // index of the decoded block
+        size_t pos;         // position inside the decoded block
+        size_t blockLen;
+        int ids[BLOCK_SIZE];
+        float weights[BLOCK_SIZE];
+
+        // Helper: decode block b into ids / weights
+        void loadBlock(size_t b);
+
+    public:
+        Cursor();
+        explicit Cursor(const PostingList &l);
+
+        bool done() const { return list == 0 || block >= list->skips.size(); }
+        int id() const { return ids[pos]; }
+        float weight() const { return weights[pos]; }
+
+        void next();
+        // Move to the first posting with id >= target
+        void advance(int target);
+    };
+
+    // Varint helpers (7 bits per byte, high bit = continuation)
+    static void writeVarint(std::vector<uint8_t> &out, uint32_t value);
+    static uint32_t readVarint(const uint8_t *&p);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef PREDICTIONCACHE_HPP
+#define PREDICTIONCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include "ModelSnapshot.hpp"
+
+/**
+ * @class PredictionCache
+ * @brief Sharded CLOCK cache of ModelSnapshot predictions for repeated inputs
+ *
+ * A request is looked up twice, each time by a 64-bit key:
+ *   1. text key: Preprocessor::normalizedHash, one pass over the raw bytes.
+ *      Retweets and copies differing only in case / punctuation hit here
+ *      without running the preprocessor or any model.
+ *   2. token key: hash of the token-id sequence after preprocessing
+ *      (vocabulary id per known word, word hash otherwise). It also catches
+ *      texts that differ in stopwords. A hit stores the text key too.
+ * A full miss runs every model and stores both keys.
+ *
+ * Each shard has its own mutex, a fixed slot array swept by a CLOCK hand
+ * (a hit only sets a reference bit) and a key -> slot index. Entries carry
+ * the snapshot version they were computed from; an entry from another
+ * version is a miss, so a reader racing a model swap never sees stale
+ * results. invalidate() empties every shard at once, e.g. after publish.
+ * Keys are not verified against the text, so two inputs whose 64-bit keys
+ * collide share one answer.
+ */
+class PredictionCache {
+public:
+    struct Stats {
+        uint64_t textHits;
+        uint64_t tokenHits;
+        uint64_t misses;
+        uint64_t staleEntries;    // found but computed by an older snapshot
+        uint64_t evictions;
+        uint64_t invalidations;
+        size_t entries;
+        size_t capacity;
+        Stats() : textHits(0), tokenHits(0), misses(0), staleEntries(0), evictions(0),
+                  invalidations(0), entries(0), capacity(0) {}
+        uint64_t lookups() const { return textHits + tokenHits + misses; }
+        double hitRate() const { return lookups() ? (double)(textHits + tokenHits) / (double)lookups() : 0.0; }
+    };
+
+private:
+    struct Slot {
+        uint64_t key;
+        unsigned long version;
+        bool used;
+        bool referenced;   // CLOCK bit: set on every hit, cleared as the hand passes
+        ModelSnapshot::Predictions value;
+        Slot() : key(0), version(0), used(false), referenced(false) {}
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::vector<Slot> slots;
+        std::unordered_map<uint64_t, size_t> index;
+        size_t hand;
+        Stats stats;   // counters only; entries / capacity are filled in by getStats
+        Shard() : hand(0) {}
+    };
+
+    std::vector<Shard> shards;
+    size_t shardMask;
+
+    Shard &shardFor(uint64_t key);
+    bool lookup(uint64_t key, unsigned long version, ModelSnapshot::Predictions &out, bool textKey);
+    void insert(uint64_t key, unsigned long version, const ModelSnapshot::Predictions &value);
+
+    PredictionCache(const PredictionCache &);
+    PredictionCache &operator=(const PredictionCache &);
+
+public:
+    /**
+     * @param capacity Entries over all shards (two per distinct input on a full miss)
+     * @param numShards Rounded up to a power of two; more shards, less lock contention
+     */
+    explicit PredictionCache(size_t capacity = 65536, size_t numShards = 16);
+
+    /**
+     * Cached predictions of models for text, computed and stored on a miss
+     * @return false when preprocessing leaves no tokens (out is untouched, nothing is cached)
+     */
+    bool predict(const ModelSnapshot &models, const std::string &text, ModelSnapshot::Predictions &out);
+
+    // Key of a preprocessed token sequence under vec's word ids
+    static uint64_t tokenKey(const Vectorizer &vec, const std::vector<std::string> &tokens);
+    static uint64_t tokenKey(const Vectorizer &vec, const std::string *tokens, size_t count);
+
+    // Drop every entry (the next lookups miss); counters are kept
+    void invalidate();
+
+    Stats getStats();
+    void resetStats();
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include "ScratchArena.hpp"
 
 /**
  * @class Preprocessor
@@ -13,20 +15,34 @@
 class Preprocessor {
 private:
     std::vector<std::string> stopwords;
+    bool separator[256];   // is_space || is_punct per byte, for the one-pass text hash
 
     // helper utilities implemented manually
-    bool is_space(char c);
-    bool is_punct(char c);
-    char to_lower_char(char c);
-    bool equals_ignore_case(const std::string &a, const std::string &b);
-    bool is_stopword(const std::string &w);
-    bool is_negation_word(const std::string &w);
+    bool is_space(char c) const;
+    bool is_punct(char c) const;
+    char to_lower_char(char c) const;
+    bool equals_ignore_case(const std::string &a, const std::string &b) const;
+    bool is_stopword(const std::string &w) const;
+    bool is_negation_word(const std::string &w) const;
+    bool is_negation_range(const char *w, size_t n) const;   // same test on a slice, no copy
+
+    // tokenizer core; emit is called once per kept token
+    template <class Emit>
+    void tokenize(const std::string &text, std::string &word, std::string &neg, Emit &emit) const;
     
 public:
     Preprocessor();
     void loadStopWords(const std::string &filePath); // loads stopwords from file (one per line)
-    std::vector<std::string> process(const std::string &text); // tokenize + lowercase + remove stopwords
+    std::vector<std::string> process(const std::string &text) const; // tokenize + lowercase + remove stopwords
+    size_t processInto(const std::string &text, ScratchContext &ctx) const; // same, into ctx.tokens without heap churn
     
+    // 64-bit hash of the lowercased word sequence process() splits text into: texts that differ
+    // only in case, punctuation or spacing hash alike and tokenize alike (no allocation)
+    uint64_t normalizedHash(const std::string &text) const;
+
+    // Identifies the preprocessing output (rules version + stopword list), e.g. for cache keys
+    std::string getConfigSignature() const;
+
     int getVocabularySize() const;
     int getStopwordCount() const;
 };
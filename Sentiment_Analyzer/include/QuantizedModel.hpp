@@ -0,0 +1,101 @@
+#ifndef QUANTIZEDMODEL_HPP
+#define QUANTIZEDMODEL_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "SparseVector.hpp"
+#include "LogisticRegression.hpp"
+#include "NaiveBayes.hpp"
+
+/**
+ * @brief Storage precision for quantized weight tables
+ */
+enum QuantPrecision {
+    QUANT_INT8,     // 1 byte per weight, per-class scale, int32 accumulation
+    QUANT_FLOAT16   // 2 bytes per weight (IEEE half), float accumulation
+};
+
+/**
+ * @struct Float16
+ * @brief Minimal IEEE 754 half-precision conversion helpers
+ */
+struct Float16 {
+    static uint16_t fromFloat(float f);
+    static float toFloat(uint16_t h);
+};
+
+/**
+ * @class QuantizedLogisticRegression
+ * @brief Compact read-only inference copy of a trained LogisticRegression
+ *
+ * Weights are stored feature-major (all classes of one feature are adjacent),
+ * so a sparse input gathers one short row per active feature. Input values
+ * are expected to be integer counts; the int8 kernel accumulates
+ * q[f][c] * count in int32 and applies the per-class scale once at the end.
+ */
+class QuantizedLogisticRegression {
+private:
+    std::vector<std::string> classes;
+    QuantPrecision precision;
+    int numFeatures;
+    int numClasses;
+    std::vector<int8_t> weightsInt8;      // [feature * numClasses + class]
+    std::vector<uint16_t> weightsHalf;    // [feature * numClasses + class]
+    std::vector<float> scale;             // per class (int8 only)
+    std::vector<float> bias;              // per class
+
+public:
+    QuantizedLogisticRegression();
+
+    void quantize(const LogisticRegression &model, QuantPrecision p);
+
+    // Raw linear scores z_c (argmax matches the sigmoid argmax)
+    void scores(const SparseVector &vector, std::vector<float> &out) const;
+    int predictId(const SparseVector &vector) const;
+    std::string predict(const SparseVector &vector) const;
+
+    const std::vector<std::string> &getClasses() const;
+    size_t sizeBytes() const;
+};
+
+/**
+ * @class QuantizedNaiveBayes
+ * @brief Compact read-only inference copy of a trained NaiveBayes
+ *
+ * log P(w|c) is stored word-major. The int8 path uses an affine per-class
+ * mapping logp = offset_c + scale_c * q with q in [0, 255], so a document
+ * score is logPrior_c + offset_c * n + scale_c * sum(count * q) with the
+ * sum accumulated in int32.
+ */
+class QuantizedNaiveBayes {
+private:
+    std::vector<std::string> classes;
+    QuantPrecision precision;
+    int vocabSize;
+    int numClasses;
+    std::vector<uint8_t> logProbInt8;     // [word * numClasses + class]
+    std::vector<uint16_t> logProbHalf;    // [word * numClasses + class]
+    std::vector<float> scale;             // per class (int8 only)
+    std::vector<float> offset;            // per class (int8 only)
+    std::vector<float> logPrior;          // per class
+    std::vector<float> logUnseen;         // per class, for out-of-vocabulary tokens
+
+public:
+    QuantizedNaiveBayes();
+
+    void quantize(const NaiveBayes &model, const std::vector<std::string> &vocab, QuantPrecision p);
+
+    /**
+     * @param counts Bag-of-words counts keyed by vocabulary id
+     * @param oovTokens Number of document tokens not in the vocabulary
+     */
+    void scores(const SparseVector &counts, int oovTokens, std::vector<float> &out) const;
+    int predictId(const SparseVector &counts, int oovTokens) const;
+    std::string predict(const SparseVector &counts, int oovTokens) const;
+
+    const std::vector<std::string> &getClasses() const;
+    size_t sizeBytes() const;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef SCORINGPIPELINE_HPP
+#define SCORINGPIPELINE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "ModelSnapshot.hpp"
+
+/**
+ * @class ScoringPipeline
+ * @brief Batch scoring of a CSV with I/O, tokenization and scoring overlapped
+ *
+ * Five stages run on their own threads and hand rows to each other through
+ * bounded lock-free queues:
+ *
+ *   reader -> tokenizer pool -> vectorizer -> scorer pool -> writer
+ *
+ * A full queue stalls the stage feeding it (backpressure), so memory stays
+ * bounded by the queue capacities whatever the file size. The writer puts
+ * rows back in input order before writing them. Each stage records the
+ * time it spent working, waiting for input (starved) and waiting for room
+ * downstream (blocked); the stage with the highest busy share is the
+ * bottleneck.
+ */
+class ScoringPipeline {
+public:
+    struct Options {
+        int tokenizerThreads;
+        int scorerThreads;
+        size_t queueCapacity;   // rows per queue between two stages
+        Options() : tokenizerThreads(2), scorerThreads(2), queueCapacity(1024) {}
+    };
+
+    struct StageStats {
+        std::string name;
+        int workers;
+        size_t items;
+        double busySeconds;      // summed over the stage's workers
+        double starvedSeconds;   // waiting on an empty input queue
+        double blockedSeconds;   // waiting on a full output queue
+        StageStats() : workers(1), items(0), busySeconds(0.0), starvedSeconds(0.0), blockedSeconds(0.0) {}
+    };
+
+    struct Report {
+        size_t rows;
+        uint64_t bytesRead;
+        double seconds;
+        std::vector<StageStats> stages;   // pipeline order; empty for a sequential run
+        Report() : rows(0), bytesRead(0), seconds(0.0) {}
+    };
+
+private:
+    Options options;
+    std::shared_ptr<const ModelSnapshot> models;
+
+    // Helper: CSV line for one scored row
+    static std::string formatRow(size_t row, const std::string &label,
+                                 const std::string &nb, const std::string &vsm,
+                                 const std::string &lr, const std::string &ensemble);
+
+public:
+    ScoringPipeline(std::shared_ptr<const ModelSnapshot> snapshot, const Options &opts = Options());
+
+    /**
+     * Score every row of inputPath and write row,label,nb,vsm,lr,ensemble to outputPath
+     * @return false if either file cannot be opened
+     */
+    bool run(const std::string &inputPath, const std::string &outputPath, Report &report) const;
+
+    // Same work and output, one row at a time on the calling thread (baseline)
+    bool runSequential(const std::string &inputPath, const std::string &outputPath, Report &report) const;
+
+    static void printReport(const Report &report);
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SCRATCHARENA_HPP
+#define SCRATCHARENA_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "SparseVector.hpp"
+
+/**
+ * @class ScratchArena
+ * @brief Monotonic bump allocator for per-document scratch memory
+ *
+ * Allocation is a pointer bump inside the current block; nothing is freed
+ * individually. rewind() / reset() return the space in O(1) and keep the
+ * blocks, so after warm-up a request/response loop allocates nothing from
+ * the heap. Only trivially destructible types should live here.
+ */
+class ScratchArena {
+public:
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+
+private:
+    struct Block {
+        char *data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current;     // index of the block being bumped
+    size_t offset;      // bytes used in the current block
+    size_t blockSize;   // default size for new blocks
+
+    ScratchArena(const ScratchArena &);
+    ScratchArena &operator=(const ScratchArena &);
+
+public:
+    explicit ScratchArena(size_t initialBlockSize = 64 * 1024);
+    ~ScratchArena();
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <class T>
+    T *allocArray(size_t count) {
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    Marker mark() const;
+    void rewind(const Marker &m);
+    void reset();
+
+    size_t capacity() const;
+};
+
+/**
+ * @struct ScratchContext
+ * @brief Per-thread scratch state reused by the preprocess -> predict path
+ *
+ * tokens is a pool of string slots; only the first tokenCount are valid for
+ * the current document. Slots keep their capacity between documents, so
+ * re-tokenizing text of similar shape does not touch the heap. counts and
+ * hashed hold the feature vectors of the document being scored and keep
+ * their capacity the same way.
+ */
+struct ScratchContext {
+    ScratchArena arena;
+    std::vector<std::string> tokens;
+    size_t tokenCount;
+    std::string word;       // token being assembled
+    std::string negated;    // "NOT_" + word buffer
+    SparseVector counts;    // bag-of-words counts keyed by word id
+    SparseVector hashed;    // hashed n-gram features
+
+    ScratchContext() : tokenCount(0) {}
+
+    // Reset per-document state (keeps all capacity)
+    void beginDocument() {
+        arena.reset();
+        tokenCount = 0;
+    }
+
+    // Next free token slot, grown on demand
+    std::string &nextToken() {
+        if (tokenCount == tokens.size()) {
+            tokens.push_back(std::string());
+            tokens.back().reserve(32);
+        }
+        return tokens[tokenCount++];
+    }
+
+    // Scratch context of the calling thread
+    static ScratchContext &local();
+};
+
+#endif
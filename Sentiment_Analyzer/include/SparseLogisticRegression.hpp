@@ -0,0 +1,53 @@
+#ifndef SPARSELOGISTICREGRESSION_HPP
+#define SPARSELOGISTICREGRESSION_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "SparseVector.hpp"
+#include "LogisticRegression.hpp"
+
+/**
+ * @class SparseLogisticRegression
+ * @brief Compact read-only inference copy of an L1-regularised LogisticRegression
+ *
+ * Only non-zero weights are kept, feature-major: the sorted ids of features
+ * with at least one surviving weight, a row offset per such feature and
+ * (class, float weight) entries. A query walks its own sorted indices
+ * against the feature list, so features whose weights were all zeroed
+ * cost a failed search step and nothing else.
+ */
+class SparseLogisticRegression {
+private:
+    std::vector<std::string> classes;
+    int numFeatures;
+    std::vector<uint32_t> featureIds;   // features with a surviving weight, ascending
+    std::vector<uint32_t> rowStart;     // featureIds.size() + 1 offsets into entries
+    std::vector<uint16_t> entryClass;
+    std::vector<float> entryWeight;
+    std::vector<float> bias;            // per class
+
+public:
+    SparseLogisticRegression();
+
+    // Keep the weights with |w| > threshold (0 keeps every non-zero)
+    void compact(const LogisticRegression &model, double threshold = 0.0);
+
+    // Raw linear scores z_c (argmax matches the sigmoid argmax)
+    void scores(const SparseVector &vector, std::vector<double> &out) const;
+    int predictId(const SparseVector &vector) const;
+    std::string predict(const SparseVector &vector) const;
+
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    const std::vector<std::string> &getClasses() const;
+    int getNumFeatures() const;
+    size_t getActiveFeatureCount() const;
+    size_t getNonZeroCount() const;
+    size_t sizeBytes() const;
+    // Size of the same model as dense double weights (classes x features + bias)
+    size_t denseSizeBytes() const;
+};
+
+#endif
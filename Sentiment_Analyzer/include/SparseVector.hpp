@@ -0,0 +1,27 @@
+#ifndef SPARSEVECTOR_HPP
+#define SPARSEVECTOR_HPP
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @struct SparseVector
+ * @brief Sparse feature vector stored as parallel index/value arrays
+ *
+ * Indices are kept sorted and unique so vectors can be merged and
+ * traversed sequentially. Used wherever the feature space is too wide
+ * for a dense vocabulary-length vector (e.g. hashed n-gram features).
+ */
+struct SparseVector {
+    std::vector<int> indices;
+    std::vector<double> values;
+
+    size_t nnz() const { return indices.size(); }
+
+    void clear() {
+        indices.clear();
+        values.clear();
+    }
+};
+
+#endif
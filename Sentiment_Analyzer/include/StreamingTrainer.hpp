@@ -0,0 +1,85 @@
+#ifndef STREAMINGTRAINER_HPP
+#define STREAMINGTRAINER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Preprocessor.hpp"
+#include "Vectorizer.hpp"
+#include "NaiveBayes.hpp"
+#include "VSM.hpp"
+#include "LogisticRegression.hpp"
+#include "HashingVectorizer.hpp"
+
+/**
+ * @class StreamingTrainer
+ * @brief Out-of-core training for corpora that do not fit in memory
+ *
+ * Pass 1 streams the CSV once: it tokenizes each row, grows the vocabulary,
+ * accumulates Naive Bayes counts and document frequencies, and appends the
+ * document as (label, id:count..., hashed index:value...) to a binary
+ * sparse cache. Hashed n-gram features need no vocabulary, so they are
+ * computed from the tokens in the same pass. Docs are written in chunks
+ * that are shuffled before they are flushed.
+ *
+ * Each SGD epoch for both Logistic Regressions (vocabulary ids and hashed
+ * n-grams) then reads the cache one chunk at a time, with chunk order and
+ * in-chunk order reshuffled per epoch. The first epoch also folds each
+ * document into the VSM counts (VSM::addDocument).
+ *
+ * Peak memory is one chunk plus the models (vocabulary x classes), so the
+ * memory budget bounds the chunk size, not the corpus size.
+ */
+class StreamingTrainer {
+public:
+    struct Options {
+        size_t memoryBudgetBytes;   // total budget; a quarter goes to the chunk buffer
+        int epochs;                 // SGD passes over the cache (learning rate comes from the LR model)
+        std::string cachePath;      // binary sparse cache (default: <csv>.sgdcache)
+        bool keepCache;             // leave the cache on disk after training
+        unsigned seed;              // shuffling seed
+
+        Options() : memoryBudgetBytes((size_t)256 << 20), epochs(10), keepCache(false), seed(42) {}
+    };
+
+    struct Report {
+        size_t documents;
+        size_t vocabularySize;
+        size_t chunks;
+        uint64_t csvBytes;
+        uint64_t cacheBytes;
+        size_t chunkBudgetBytes;
+        size_t peakChunkBytes;
+        size_t modelBytes;              // NB counts + LR weights (both) + centroids + df
+        double pass1Seconds;
+        std::vector<double> epochSeconds;
+        std::vector<double> epochAccuracy;      // LR progressive validation (predict-then-update)
+        std::vector<double> epochHashAccuracy;  // same for the hashed n-gram LR
+
+        Report() : documents(0), vocabularySize(0), chunks(0), csvBytes(0), cacheBytes(0),
+                   chunkBudgetBytes(0), peakChunkBytes(0), modelBytes(0), pass1Seconds(0.0) {}
+    };
+
+private:
+    Options options;
+
+    // Helper: shuffle the records of one chunk and append them to the cache
+    static void flushChunk(std::ofstream &out, std::vector<uint32_t> &buffer,
+                           std::vector<size_t> &offsets, unsigned seed,
+                           std::vector<uint64_t> &chunkOffsets);
+
+public:
+    explicit StreamingTrainer(const Options &opts = Options());
+
+    /**
+     * Train NB, VSM, LR and the hashed n-gram LR from a CSV without loading it.
+     * The vectorizer receives the streamed vocabulary (id = first-seen order);
+     * hashLr is fitted on hashVec's features.
+     * @return false if the CSV or the cache file cannot be opened
+     */
+    bool train(const std::string &csvPath, Preprocessor &pre, Vectorizer &vec,
+               NaiveBayes &nb, VSM &vsm, LogisticRegression &lr,
+               const HashingVectorizer &hashVec, LogisticRegression &hashLr, Report &report);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+
+/**
+ * @class ThreadPool
+ * @brief Work-stealing task scheduler shared by every parallel stage
+ *
+ * Each worker owns a deque: it pushes and pops its own tasks at the back
+ * (LIFO, cache-warm) and, when it runs dry, steals from the front of a
+ * victim's deque (FIFO, the oldest and usually largest piece of work).
+ * Tasks submitted from outside the pool are spread round-robin. Idle
+ * workers sleep on a condition variable.
+ *
+ * parallelFor() splits a range into chunks that the calling thread and up
+ * to size() - 1 helper tasks claim from a shared counter. The caller always
+ * works through the chunks itself, so nested parallel loops and loops
+ * started from inside a task cannot deadlock and never start extra threads.
+ *
+ * One process-wide instance (shared()) holds the core budget; size it with
+ * configureShared() before first use or with the EMOTION_THREADS
+ * environment variable (EMOTION_PIN_THREADS=1 pins worker i to CPU i).
+ */
+class ThreadPool {
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct Worker {
+        std::deque<Task> tasks;
+        std::mutex lock;
+    };
+
+    std::vector<std::unique_ptr<Worker> > workers;
+    std::vector<std::thread> threads;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::atomic<size_t> pending;     // submitted but not yet started
+    std::atomic<size_t> nextVictim;  // round-robin target for external submits
+    std::atomic<bool> stopping;
+    std::atomic<size_t> stolen;
+    std::atomic<size_t> executed;
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    // Helper: index of the calling worker in this pool, -1 for other threads
+    int currentWorker() const;
+
+    // Helper: take one task (own deque first, then steal); false if none anywhere
+    bool takeTask(int self, Task &task);
+
+    // Helper: worker main loop
+    void workerLoop(int index, bool pin);
+
+public:
+    // numThreads <= 0 uses the hardware concurrency
+    explicit ThreadPool(int numThreads = 0, bool pinThreads = false);
+    ~ThreadPool();
+
+    void submit(const Task &task);
+
+    // Run task on the pool and return its result as a future
+    template <class R>
+    std::future<R> async(const std::function<R()> &fn) {
+        std::shared_ptr<std::packaged_task<R()> > job = std::make_shared<std::packaged_task<R()> >(fn);
+        std::future<R> result = job->get_future();
+        submit([job]() { (*job)(); });
+        return result;
+    }
+
+    // Run one pending task on the calling thread; false if there was none
+    bool runPendingTask();
+
+    /**
+     * body(chunkBegin, chunkEnd) over [begin, end) in chunks of about grain
+     * items (0 = pick one from the pool size). Returns once every chunk ran.
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)> &body);
+
+    int size() const;
+    size_t getStolenCount() const;
+    size_t getExecutedCount() const;
+
+    // Process-wide pool; created on first use
+    static ThreadPool &shared();
+
+    // Size of the shared pool; only effective before the first shared() call
+    static void configureShared(int numThreads, bool pinThreads);
+};
+
+#endif
@@ -5,35 +5,145 @@
 #include <vector>
 #include <map>
 #include <cmath>
+#include "BatchPrediction.hpp"
+#include "SparseVector.hpp"
+#include "KnnIndex.hpp"
 
 /**
  * @class VSM
  * @brief Vector Space Model with TF-IDF and Cosine Similarity
  * 
  * Implements TF-IDF vectorization and centroid-based classification
- * using cosine similarity for emotion detection.
+ * using cosine similarity for emotion detection. A class centroid is
+ * idf o (sum of the class's unit-length count vectors), so the model state
+ * is document frequencies plus IDF-free per-class sums: new documents are
+ * folded in at O(nnz x classes) and single queries apply the current IDF
+ * lazily while they walk a term-major [term][class] table, touching only
+ * their own terms. A k-nearest-neighbour mode votes over the training
+ * documents through an inverted index.
  */
 class VSM {
 private:
     std::vector<std::string> classes;
     std::map<std::string, std::vector<double>> classCentroids;
-    std::vector<std::vector<double>> trainVectors;
-    std::vector<std::string> trainLabels;
+    std::vector<double> idf;             // inverse document frequency as of the last refreshCentroids()
+    std::vector<double> centroidNorms;   // L2 norm per class, same order as classes
+    std::vector<int> trainClassIds;      // class index per training document
+    KnnIndex knnIndex;
+    int knnK;
+
+    // Incremental state; idf, classCentroids and centroidNorms are derived from it
+    int docCount;
+    std::vector<int> docFreq;            // documents containing each term
+    std::vector<int> classDocCounts;
+    std::vector<double> termClassSums;   // [term * classes + class], sum of unit-length count vectors
+    // Per class sum(s^2), sum(log df * s^2), sum(log df^2 * s^2) over s = termClassSums, so
+    // |idf o sum|^2 = log(N)^2 * a - 2 log(N) * b + c needs no pass over the vocabulary
+    std::vector<double> normSq, normLogDf, normLogDfSq;
     
     // Helper: compute cosine similarity between two vectors
-    double cosineSimilarity(const std::vector<double> &a, const std::vector<double> &b);
+    double cosineSimilarity(const std::vector<double> &a, const std::vector<double> &b) const;
     
-    // Helper: compute TF-IDF vectors
-    std::vector<std::vector<double>> computeTFIDF(const std::vector<std::vector<int>> &countVectors);
+    // Helper: L2-normalized TF-IDF of one count vector using the trained IDF
+    std::vector<double> toTFIDF(const std::vector<int> &countVector) const;
+
+    // Helper: widen the state to numClasses x numFeatures, keeping existing ids
+    void growModel(int numClasses, int numFeatures);
+
+    // Helper: add (sign = 1) or remove (sign = -1) one term's share of the norm sums
+    void addNormTerms(int term, double sign);
+
+    // Helper: |idf o class sum| at the current document count
+    double classSumNorm(int classId) const;
     
 public:
     VSM();
     
     void trainFromVectors(const std::vector<std::vector<int>> &vectors, 
                           const std::vector<std::string> &labels);
-    std::string predict(const std::vector<int> &vector);
+
+    // Start an empty incremental model with these classes and vocabulary width
+    void initModel(const std::vector<std::string> &classList, int numFeatures);
+
+    /**
+     * Fold one labelled count vector into the document frequencies and its
+     * class sum. Cost is O(nnz x classes), independent of the vocabulary.
+     * Sparse scoring (predict, predictSparse, centroidScores) sees it at
+     * once; the dense view (getCentroid, getIDF, predictBatch, kNN) is
+     * updated by refreshCentroids().
+     */
+    void addDocument(const SparseVector &counts, int classId);
+
+    /**
+     * addDocument for a labelled batch. Unseen classes are appended and the
+     * vocabulary may grow to numFeatures; existing class and term ids stay.
+     * The kNN index keeps the documents of the last full training.
+     */
+    void partialFit(const std::vector<SparseVector> &counts,
+                    const std::vector<std::string> &labels, int numFeatures);
+
+    // Recompute the dense view from the incremental state: O(vocabulary x classes)
+    void refreshCentroids();
+
+    std::string predict(const std::vector<int> &vector) const;
+
+    /**
+     * Centroid prediction from a sparse count vector. Cost is
+     * O(query terms x classes): one termClassSums row per query term,
+     * independent of the vocabulary size.
+     */
+    std::string predictSparse(const SparseVector &counts) const;
+    int predictSparseId(const SparseVector &counts) const;   // index into getClasses(), -1 untrained
+
+    // Cosine similarity to every class centroid (same order as getClasses()) from the term-major table
+    void centroidScores(const SparseVector &counts, std::vector<double> &scores) const;
     double accuracy(const std::vector<std::vector<int>> &vectors, 
-                    const std::vector<std::string> &labels);
+                    const std::vector<std::string> &labels) const;
+
+    /**
+     * Score many documents per call. Scores are cosine similarities to each
+     * class centroid. Documents x features are tiled so each centroid block
+     * is reused across a block of documents while it is still in cache.
+     * @param docs Pointer to the first count vector, count documents are read
+     */
+    BatchPrediction predictBatch(const std::vector<int> *docs, size_t count) const;
+    BatchPrediction predictBatch(const std::vector<std::vector<int>> &docs) const;
+
+    // Unit-length TF-IDF of a count vector, non-zeros only (the kNN query form)
+    SparseVector toTFIDFSparse(const std::vector<int> &countVector) const;
+    void toTFIDFSparse(const SparseVector &counts, SparseVector &out) const;
+
+    /**
+     * k-nearest-neighbour classification: the k most similar training
+     * documents vote for their class, weighted by cosine similarity.
+     * Falls back to the centroid rule when no training document shares a term.
+     */
+    std::string predictKnn(const std::vector<int> &vector) const;
+
+    /**
+     * predictKnn from sparse counts, as an index into getClasses() (-1 untrained).
+     * Query, neighbour and score buffers are per-thread, so a warm call does not
+     * allocate; the fallback is the term-table centroid rule of predictSparse.
+     */
+    int predictKnnId(const SparseVector &counts) const;
+
+    // Similarity-weighted class votes from the k nearest neighbours (same order as getClasses())
+    void knnScores(const std::vector<int> &vector, std::vector<double> &scores) const;
+
+    /**
+     * @param k Neighbours per query
+     * @param pruneFactor 1.0 = exact top-k; larger prunes harder (faster, lower recall)
+     */
+    void setKnnParameters(int k, double pruneFactor);
+    const KnnIndex &getKnnIndex() const;
+    size_t termTableSizeBytes() const;
+    int getDocumentCount() const;
+
+    // Read-only access to the trained model (e.g. for fused ensemble scoring)
+    const std::vector<std::string> &getClasses() const;
+    const std::vector<double> &getCentroid(const std::string &className) const;
+    double getCentroidNorm(const std::string &className) const;
+    const std::vector<double> &getIDF() const;
 };
 
 #endif
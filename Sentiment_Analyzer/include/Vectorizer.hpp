@@ -3,28 +3,94 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include "SparseVector.hpp"
 
 /**
  * @class Vectorizer
  * @brief Bag-of-words vectorization for text classification
- * 
+ *
  * Converts tokenized documents into numerical feature vectors
  * using vocabulary-based count representation.
+ *
+ * Ids are first-seen order by default. orderByFrequency() renumbers them
+ * by descending corpus frequency, so the rows the common words hit in the
+ * NB / LR / VSM tables share the first few KB; it can also split the
+ * lookup into a small hot-word hash map tried first and a cold one.
  */
 
 class Vectorizer {
+public:
+    enum FeatureSelection {
+        SELECT_FREQUENCY,     // keep the most frequent terms
+        SELECT_CHI_SQUARED,   // keep terms with the highest max-class chi-squared score
+        SELECT_MUTUAL_INFO    // keep terms with the highest mutual information with the label
+    };
+
+    /**
+     * Vocabulary pruning settings. Filters are applied in order:
+     * minDf / maxDfRatio first, then topK by the chosen selection score.
+     */
+    struct PruneOptions {
+        int minDf;                   // drop terms appearing in fewer documents
+        double maxDfRatio;           // drop terms appearing in more than this fraction of documents
+        int topK;                    // keep at most this many terms (0 = no limit)
+        FeatureSelection selection;
+
+        PruneOptions() : minDf(1), maxDfRatio(1.0), topK(0), selection(SELECT_FREQUENCY) {}
+    };
+
 private:
     std::vector<std::string> vocabulary; // list of unique words
+    std::unordered_map<std::string, int> wordIndex; // word -> position in vocabulary (cold tier only when split)
+    std::unordered_map<std::string, int> hotIndex;  // ids below hotSize when the lookup is split
+    int hotSize;                                    // 0 = one index for every word
 
     // helper: find index of word in vocabulary (-1 if not found)
-    int find_in_vocab(const std::string &word);
+    int find_in_vocab(const std::string &word) const;
+
+    // helper: rebuild wordIndex (and hotIndex) from vocabulary, inserting in id order
+    void rebuildIndex();
 
 public:
     Vectorizer();
     void buildVocabulary(const std::vector<std::vector<std::string>> &documents);
-    std::vector<int> transformSingle(const std::vector<std::string> &tokens); // bag-of-words counts
-    std::vector<std::vector<int>> transform(const std::vector<std::vector<std::string>> &documents);
-    std::vector<std::string> getVocabulary();
+
+    // Append words not seen before; existing ids never move. Returns the number of words added.
+    size_t extendVocabulary(const std::vector<std::vector<std::string>> &documents);
+    std::vector<int> transformSingle(const std::vector<std::string> &tokens) const; // bag-of-words counts
+    std::vector<std::vector<int>> transform(const std::vector<std::vector<std::string>> &documents) const;
+    SparseVector transformSparse(const std::vector<std::string> &tokens) const; // counts keyed by word id
+    void transformSparse(const std::string *tokens, size_t count, SparseVector &out) const; // same, reusing out
+    std::vector<std::string> getVocabulary() const;
+    void setVocabulary(const std::vector<std::string> &words); // e.g. a vocabulary built while streaming
+    int getVocabularySize() const;
+    int getWordId(const std::string &word) const; // -1 if not in the vocabulary
+
+    /**
+     * Prune the vocabulary and renumber the surviving words compactly,
+     * keeping their relative order.
+     * @param documents Tokenized training documents
+     * @param labels Class label per document (used by chi-squared / MI)
+     * @return old id -> new id mapping, -1 for removed words
+     */
+    std::vector<int> pruneVocabulary(const std::vector<std::vector<std::string>> &documents,
+                                     const std::vector<std::string> &labels,
+                                     const PruneOptions &options);
+
+    /**
+     * Renumber ids by descending token count in documents (ties keep their
+     * current order); words absent from documents go last.
+     * @param hotCoverage If > 0, the smallest id prefix covering this share
+     *        of the tokens becomes the hot lookup tier; 0 keeps one index
+     * @return old id -> new id mapping
+     */
+    std::vector<int> orderByFrequency(const std::vector<std::vector<std::string>> &documents,
+                                      double hotCoverage = 0.0);
+    int getHotSize() const;
+
+    // Drop tokens that are not in the vocabulary (e.g. after pruning)
+    std::vector<std::string> filterTokens(const std::vector<std::string> &tokens) const;
 };
 
 #endif
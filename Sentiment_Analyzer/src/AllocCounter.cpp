@@ -0,0 +1,55 @@
+#include "../include/AllocCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef EMOTION_COUNT_ALLOCS
+
+static std::atomic<uint64_t> g_allocCount(0);
+
+void *operator new(std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+bool AllocCounter::enabled() {
+    return true;
+}
+
+uint64_t AllocCounter::count() {
+    return g_allocCount.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocCounter::enabled() {
+    return false;
+}
+
+uint64_t AllocCounter::count() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,1336 @@
+#include "../include/Benchmarks.hpp"
+#include "../include/Vectorizer.hpp"
+#include "../include/NaiveBayes.hpp"
+#include "../include/LogisticRegression.hpp"
+#include "../include/QuantizedModel.hpp"
+#include "../include/VSM.hpp"
+#include "../include/EnsemblePredictor.hpp"
+#include "../include/Preprocessor.hpp"
+#include "../include/ScratchArena.hpp"
+#include "../include/AllocCounter.hpp"
+#include "../include/ModelSnapshot.hpp"
+#include "../include/FastMath.hpp"
+#include "../include/DenseKernels.hpp"
+#include "../include/SparseLogisticRegression.hpp"
+#include "../include/PerfCounters.hpp"
+#include "../include/CountMinNaiveBayes.hpp"
+#include "../include/PredictionCache.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <set>
+#include <map>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <cfloat>
+#include <cctype>
+#include <limits>
+
+void Benchmarks::splitTrainTest(const std::vector<std::vector<std::string>> &docs,
+                                const std::vector<std::string> &labels,
+                                std::vector<std::vector<std::string>> &trainDocs,
+                                std::vector<std::string> &trainLabels,
+                                std::vector<std::vector<std::string>> &testDocs,
+                                std::vector<std::string> &testLabels) {
+    for (size_t i = 0; i < docs.size(); ++i) {
+        if (i % 5 == 4) {
+            testDocs.push_back(docs[i]);
+            testLabels.push_back(labels[i]);
+        }
+        else {
+            trainDocs.push_back(docs[i]);
+            trainLabels.push_back(labels[i]);
+        }
+    }
+}
+
+void Benchmarks::vocabularyPruning(const std::vector<std::vector<std::string>> &docs,
+                                   const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.empty() || testDocs.empty()) {
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+
+    struct Config {
+        std::string name;
+        bool prune;
+        Vectorizer::PruneOptions options;
+    };
+
+    std::vector<Config> configs;
+    Config c;
+    c.name = "Full vocabulary"; c.prune = false;
+    configs.push_back(c);
+
+    c.prune = true;
+    c.name = "min-df 2";
+    c.options = Vectorizer::PruneOptions(); c.options.minDf = 2;
+    configs.push_back(c);
+
+    c.name = "min-df 2, max-df 0.5";
+    c.options.maxDfRatio = 0.5;
+    configs.push_back(c);
+
+    c.name = "top-1000 frequency";
+    c.options = Vectorizer::PruneOptions(); c.options.topK = 1000;
+    configs.push_back(c);
+
+    c.name = "top-500 chi-squared";
+    c.options = Vectorizer::PruneOptions(); c.options.topK = 500; c.options.selection = Vectorizer::SELECT_CHI_SQUARED;
+    configs.push_back(c);
+
+    c.name = "top-500 mutual info";
+    c.options.selection = Vectorizer::SELECT_MUTUAL_INFO;
+    configs.push_back(c);
+
+    c.name = "top-200 chi-squared";
+    c.options.topK = 200; c.options.selection = Vectorizer::SELECT_CHI_SQUARED;
+    configs.push_back(c);
+
+    std::cout << "\n╔══════════════════════════╦═══════╦══════════╦═════════╦═════════╦═════════╦═════════╗" << std::endl;
+    std::cout << "║ Pruning                  ║ Vocab ║ Model KB ║ NB acc  ║ LR acc  ║ NB us   ║ LR us   ║" << std::endl;
+    std::cout << "╠══════════════════════════╬═══════╬══════════╬═════════╬═════════╬═════════╬═════════╣" << std::endl;
+
+    for (size_t k = 0; k < configs.size(); ++k) {
+        Vectorizer vec;
+        vec.buildVocabulary(trainDocs);
+        if (configs[k].prune) vec.pruneVocabulary(trainDocs, trainLabels, configs[k].options);
+        std::vector<std::string> vocab = vec.getVocabulary();
+
+        // restrict documents to the surviving vocabulary
+        std::vector<std::vector<std::string>> trainFiltered, testFiltered;
+        for (size_t i = 0; i < trainDocs.size(); ++i) trainFiltered.push_back(vec.filterTokens(trainDocs[i]));
+        for (size_t i = 0; i < testDocs.size(); ++i) testFiltered.push_back(vec.filterTokens(testDocs[i]));
+
+        NaiveBayes nb;
+        nb.trainFromDocuments(trainFiltered, trainLabels, vocab);
+
+        std::vector<SparseVector> trainSparse, testSparse;
+        for (size_t i = 0; i < trainFiltered.size(); ++i) trainSparse.push_back(vec.transformSparse(trainFiltered[i]));
+        for (size_t i = 0; i < testFiltered.size(); ++i) testSparse.push_back(vec.transformSparse(testFiltered[i]));
+
+        LogisticRegression lr(0.01, 100);
+        lr.trainFromSparse(trainSparse, trainLabels, (int)vocab.size());
+
+        // held-out accuracy and per-document predict latency
+        int nbCorrect = 0, lrCorrect = 0;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < testFiltered.size(); ++i) {
+            if (nb.predict(testFiltered[i]) == testLabels[i]) nbCorrect++;
+        }
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < testSparse.size(); ++i) {
+            if (lr.predictSparse(testSparse[i]) == testLabels[i]) lrCorrect++;
+        }
+        std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+        double n = (double)testDocs.size();
+        double nbMicros = std::chrono::duration<double, std::micro>(t1 - t0).count() / n;
+        double lrMicros = std::chrono::duration<double, std::micro>(t2 - t1).count() / n;
+
+        // NB probability table + LR weights and biases, one double per (class, word)
+        size_t numClasses = std::set<std::string>(trainLabels.begin(), trainLabels.end()).size();
+        double modelKB = (double)(numClasses * vocab.size() * 2 + numClasses) * sizeof(double) / 1024.0;
+
+        std::cout << "║ " << std::left << std::setw(24) << configs[k].name
+                  << " ║ " << std::right << std::setw(5) << vocab.size()
+                  << " ║ " << std::fixed << std::setprecision(1) << std::setw(8) << modelKB
+                  << " ║ " << std::setprecision(2) << std::setw(6) << (100.0 * nbCorrect / n) << "%"
+                  << " ║ " << std::setw(6) << (100.0 * lrCorrect / n) << "%"
+                  << " ║ " << std::setw(7) << nbMicros
+                  << " ║ " << std::setw(7) << lrMicros << " ║" << std::endl;
+    }
+
+    std::cout << "╚══════════════════════════╩═══════╩══════════╩═════════╩═════════╩═════════╩═════════╝" << std::endl;
+    std::cout << "[INFO] Trained on " << trainDocs.size() << " documents, evaluated on " << testDocs.size() << " held-out documents." << std::endl;
+}
+
+void Benchmarks::quantization(const std::vector<std::vector<std::string>> &docs,
+                              const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.empty() || testDocs.empty()) {
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+
+    Vectorizer vec;
+    vec.buildVocabulary(trainDocs);
+    std::vector<std::string> vocab = vec.getVocabulary();
+
+    NaiveBayes nb;
+    nb.trainFromDocuments(trainDocs, trainLabels, vocab);
+
+    std::vector<SparseVector> trainSparse, testSparse;
+    std::vector<int> testOov;
+    for (size_t i = 0; i < trainDocs.size(); ++i) trainSparse.push_back(vec.transformSparse(trainDocs[i]));
+    for (size_t i = 0; i < testDocs.size(); ++i) {
+        testSparse.push_back(vec.transformSparse(testDocs[i]));
+        testOov.push_back((int)(testDocs[i].size() - vec.filterTokens(testDocs[i]).size()));
+    }
+
+    LogisticRegression lr(0.01, 100);
+    lr.trainFromSparse(trainSparse, trainLabels, (int)vocab.size());
+
+    // reference predictions from the double-precision models
+    double n = (double)testDocs.size();
+    std::vector<std::string> nbRef, lrRef;
+    int nbRefCorrect = 0, lrRefCorrect = 0;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testDocs.size(); ++i) nbRef.push_back(nb.predict(testDocs[i]));
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testSparse.size(); ++i) lrRef.push_back(lr.predictSparse(testSparse[i]));
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testDocs.size(); ++i) {
+        if (nbRef[i] == testLabels[i]) nbRefCorrect++;
+        if (lrRef[i] == testLabels[i]) lrRefCorrect++;
+    }
+
+    size_t numClasses = lr.getClasses().size();
+    double nbDoubleKB = (double)(numClasses * vocab.size()) * sizeof(double) / 1024.0;
+    double lrDoubleKB = (double)(numClasses * (vocab.size() + 1)) * sizeof(double) / 1024.0;
+
+    std::cout << "\n╔════════════════════╦══════════╦═════════╦═══════════╦═════════╗" << std::endl;
+    std::cout << "║ Model              ║ Size KB  ║ Acc     ║ Agreement ║ us/doc  ║" << std::endl;
+    std::cout << "╠════════════════════╬══════════╬═════════╬═══════════╬═════════╣" << std::endl;
+
+    std::cout << std::fixed;
+    std::cout << "║ " << std::left << std::setw(18) << "NB double"
+              << " ║ " << std::right << std::setprecision(1) << std::setw(8) << nbDoubleKB
+              << " ║ " << std::setprecision(2) << std::setw(6) << (100.0 * nbRefCorrect / n) << "%"
+              << " ║ " << std::setw(8) << 100.0 << "%"
+              << " ║ " << std::setw(7) << std::chrono::duration<double, std::micro>(t1 - t0).count() / n << " ║" << std::endl;
+
+    QuantPrecision precisions[2] = { QUANT_INT8, QUANT_FLOAT16 };
+    const char *precisionNames[2] = { "int8", "fp16" };
+
+    for (int p = 0; p < 2; ++p) {
+        QuantizedNaiveBayes qnb;
+        qnb.quantize(nb, vocab, precisions[p]);
+
+        int correct = 0, agree = 0;
+        std::chrono::steady_clock::time_point q0 = std::chrono::steady_clock::now();
+        std::vector<std::string> preds;
+        for (size_t i = 0; i < testSparse.size(); ++i) preds.push_back(qnb.predict(testSparse[i], testOov[i]));
+        std::chrono::steady_clock::time_point q1 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < preds.size(); ++i) {
+            if (preds[i] == testLabels[i]) correct++;
+            if (preds[i] == nbRef[i]) agree++;
+        }
+
+        std::cout << "║ " << std::left << std::setw(18) << (std::string("NB ") + precisionNames[p])
+                  << " ║ " << std::right << std::setprecision(1) << std::setw(8) << qnb.sizeBytes() / 1024.0
+                  << " ║ " << std::setprecision(2) << std::setw(6) << (100.0 * correct / n) << "%"
+                  << " ║ " << std::setw(8) << (100.0 * agree / n) << "%"
+                  << " ║ " << std::setw(7) << std::chrono::duration<double, std::micro>(q1 - q0).count() / n << " ║" << std::endl;
+    }
+
+    std::cout << "║ " << std::left << std::setw(18) << "LR double"
+              << " ║ " << std::right << std::setprecision(1) << std::setw(8) << lrDoubleKB
+              << " ║ " << std::setprecision(2) << std::setw(6) << (100.0 * lrRefCorrect / n) << "%"
+              << " ║ " << std::setw(8) << 100.0 << "%"
+              << " ║ " << std::setw(7) << std::chrono::duration<double, std::micro>(t2 - t1).count() / n << " ║" << std::endl;
+
+    for (int p = 0; p < 2; ++p) {
+        QuantizedLogisticRegression qlr;
+        qlr.quantize(lr, precisions[p]);
+
+        int correct = 0, agree = 0;
+        std::chrono::steady_clock::time_point q0 = std::chrono::steady_clock::now();
+        std::vector<std::string> preds;
+        for (size_t i = 0; i < testSparse.size(); ++i) preds.push_back(qlr.predict(testSparse[i]));
+        std::chrono::steady_clock::time_point q1 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < preds.size(); ++i) {
+            if (preds[i] == testLabels[i]) correct++;
+            if (preds[i] == lrRef[i]) agree++;
+        }
+
+        std::cout << "║ " << std::left << std::setw(18) << (std::string("LR ") + precisionNames[p])
+                  << " ║ " << std::right << std::setprecision(1) << std::setw(8) << qlr.sizeBytes() / 1024.0
+                  << " ║ " << std::setprecision(2) << std::setw(6) << (100.0 * correct / n) << "%"
+                  << " ║ " << std::setw(8) << (100.0 * agree / n) << "%"
+                  << " ║ " << std::setw(7) << std::chrono::duration<double, std::micro>(q1 - q0).count() / n << " ║" << std::endl;
+    }
+
+    std::cout << "╚════════════════════╩══════════╩═════════╩═══════════╩═════════╝" << std::endl;
+    std::cout << "[INFO] Agreement = share of held-out predictions identical to the double model." << std::endl;
+}
+
+void Benchmarks::ensemble(const std::vector<std::vector<std::string>> &docs,
+                          const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.size() < 8 || testDocs.empty()) {
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+
+    // base models see 3/4 of the training split, the stacker is fitted on the rest
+    std::vector<std::vector<std::string>> baseDocs, stackDocs;
+    std::vector<std::string> baseLabels, stackLabels;
+    for (size_t i = 0; i < trainDocs.size(); ++i) {
+        if (i % 4 == 3) {
+            stackDocs.push_back(trainDocs[i]);
+            stackLabels.push_back(trainLabels[i]);
+        }
+        else {
+            baseDocs.push_back(trainDocs[i]);
+            baseLabels.push_back(trainLabels[i]);
+        }
+    }
+
+    Vectorizer vec;
+    vec.buildVocabulary(baseDocs);
+    std::vector<std::string> vocab = vec.getVocabulary();
+
+    NaiveBayes nb;
+    nb.trainFromDocuments(baseDocs, baseLabels, vocab);
+
+    std::vector<SparseVector> baseSparse;
+    for (size_t i = 0; i < baseDocs.size(); ++i) baseSparse.push_back(vec.transformSparse(baseDocs[i]));
+    LogisticRegression lr(0.01, 100);
+    lr.trainFromSparse(baseSparse, baseLabels, (int)vocab.size());
+
+    VSM vsm;
+    vsm.trainFromVectors(vec.transform(baseDocs), baseLabels);
+
+    EnsemblePredictor ens;
+    ens.build(vocab, nb, lr, vsm);
+
+    double n = (double)testDocs.size();
+    std::cout << "\n╔══════════════════════════════╦═════════╦═════════╗" << std::endl;
+    std::cout << "║ Model                        ║ Acc     ║ us/doc  ║" << std::endl;
+    std::cout << "╠══════════════════════════════╬═════════╬═════════╣" << std::endl;
+    std::cout << std::fixed;
+
+    // single models through their own per-document APIs
+    int nbCorrect = 0, lrCorrect = 0, vsmCorrect = 0;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testDocs.size(); ++i) {
+        if (nb.predict(testDocs[i]) == testLabels[i]) nbCorrect++;
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testDocs.size(); ++i) {
+        std::vector<int> counts = vec.transformSingle(testDocs[i]);
+        if (lr.predict(counts) == testLabels[i]) lrCorrect++;
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testDocs.size(); ++i) {
+        std::vector<int> counts = vec.transformSingle(testDocs[i]);
+        if (vsm.predict(counts) == testLabels[i]) vsmCorrect++;
+    }
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+
+    double nbUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / n;
+    double lrUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / n;
+    double vsmUs = std::chrono::duration<double, std::micro>(t3 - t2).count() / n;
+
+    const char *names[3] = { "Naive Bayes", "Logistic Regression (dense)", "VSM (dense)" };
+    int correct[3] = { nbCorrect, lrCorrect, vsmCorrect };
+    double micros[3] = { nbUs, lrUs, vsmUs };
+    for (int k = 0; k < 3; ++k) {
+        std::cout << "║ " << std::left << std::setw(28) << names[k]
+                  << " ║ " << std::right << std::setprecision(2) << std::setw(6) << (100.0 * correct[k] / n) << "%"
+                  << " ║ " << std::setw(7) << micros[k] << " ║" << std::endl;
+    }
+    std::cout << "║ " << std::left << std::setw(28) << "All three, run separately"
+              << " ║ " << std::right << std::setw(7) << "-"
+              << " ║ " << std::setw(7) << (nbUs + lrUs + vsmUs) << " ║" << std::endl;
+
+    // fused ensemble in both combination modes
+    for (int m = 0; m < 2; ++m) {
+        if (m == 1) {
+            ens.fitStacking(stackDocs, stackLabels);
+            ens.setMode(EnsemblePredictor::COMBINE_STACKING);
+        }
+
+        int ensCorrect = 0;
+        std::chrono::steady_clock::time_point e0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < testDocs.size(); ++i) {
+            if (ens.predict(testDocs[i]) == testLabels[i]) ensCorrect++;
+        }
+        std::chrono::steady_clock::time_point e1 = std::chrono::steady_clock::now();
+
+        std::cout << "║ " << std::left << std::setw(28) << (m == 0 ? "Fused ensemble (soft vote)" : "Fused ensemble (stacking)")
+                  << " ║ " << std::right << std::setprecision(2) << std::setw(6) << (100.0 * ensCorrect / n) << "%"
+                  << " ║ " << std::setw(7) << std::chrono::duration<double, std::micro>(e1 - e0).count() / n << " ║" << std::endl;
+    }
+
+    std::cout << "╚══════════════════════════════╩═════════╩═════════╝" << std::endl;
+    std::cout << "[INFO] Base models: " << baseDocs.size() << " docs, stacker: " << stackDocs.size()
+              << " docs, held-out test: " << testDocs.size() << " docs." << std::endl;
+}
+
+void Benchmarks::knn(const std::vector<std::vector<std::string>> &docs,
+                     const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.empty() || testDocs.empty()) {
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+
+    const int k = 5;
+    Vectorizer vec;
+    vec.buildVocabulary(trainDocs);
+    VSM vsm;
+    vsm.trainFromVectors(vec.transform(trainDocs), trainLabels);
+    const KnnIndex &index = vsm.getKnnIndex();
+
+    std::vector<std::vector<int>> testCounts = vec.transform(testDocs);
+    std::vector<SparseVector> queries;
+    for (size_t i = 0; i < testCounts.size(); ++i) queries.push_back(vsm.toTFIDFSparse(testCounts[i]));
+    double n = (double)testDocs.size();
+
+    // exact neighbours, used as the recall reference
+    std::vector<std::vector<KnnIndex::Neighbor> > exact(queries.size());
+    std::chrono::steady_clock::time_point b0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i) index.searchExact(queries[i], k, exact[i]);
+    std::chrono::steady_clock::time_point b1 = std::chrono::steady_clock::now();
+    double exactUs = std::chrono::duration<double, std::micro>(b1 - b0).count() / n;
+
+    std::cout << "\n╔══════════════════════════════╦═════════╦═════════╦═══════════╦═════════╗" << std::endl;
+    std::cout << "║ VSM mode (k = " << k << ")             ║ Acc     ║ Recall  ║ Scored/q  ║ us/doc  ║" << std::endl;
+    std::cout << "╠══════════════════════════════╬═════════╬═════════╬═══════════╬═════════╣" << std::endl;
+    std::cout << std::fixed;
+
+    int centroidCorrect = 0;
+    std::chrono::steady_clock::time_point c0 = std::chrono::steady_clock::now();
+    BatchPrediction centroid = vsm.predictBatch(testCounts);
+    std::chrono::steady_clock::time_point c1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testCounts.size(); ++i) {
+        if (centroid.label(i) == testLabels[i]) centroidCorrect++;
+    }
+    std::cout << "║ " << std::left << std::setw(28) << "Centroids (dense, batched)"
+              << " ║ " << std::right << std::setprecision(2) << std::setw(6) << (100.0 * centroidCorrect / n) << "%"
+              << " ║ " << std::setw(7) << "-"
+              << " ║ " << std::setw(9) << vsm.getClasses().size()
+              << " ║ " << std::setw(7) << std::chrono::duration<double, std::micro>(c1 - c0).count() / n << " ║" << std::endl;
+
+    // the same centroid rule through the term -> class table with lazy IDF, one query at a time
+    std::vector<SparseVector> testSparse;
+    for (size_t i = 0; i < testDocs.size(); ++i) testSparse.push_back(vec.transformSparse(testDocs[i]));
+    int tableCorrect = 0, tableAgree = 0;
+    std::chrono::steady_clock::time_point p0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < testSparse.size(); ++i) {
+        std::string pred = vsm.predictSparse(testSparse[i]);
+        if (pred == testLabels[i]) tableCorrect++;
+        if (pred == centroid.label(i)) tableAgree++;
+    }
+    std::chrono::steady_clock::time_point p1 = std::chrono::steady_clock::now();
+    std::cout << "║ " << std::left << std::setw(28) << "Centroids (term table)"
+              << " ║ " << std::right << std::setprecision(2) << std::setw(6) << (100.0 * tableCorrect / n) << "%"
+              << " ║ " << std::setw(7) << "-"
+              << " ║ " << std::setw(9) << vsm.getClasses().size()
+              << " ║ " << std::setw(7) << std::chrono::duration<double, std::micro>(p1 - p0).count() / n << " ║" << std::endl;
+    std::cout << "║ " << std::left << std::setw(28) << "kNN exhaustive (postings)"
+              << " ║ " << std::right << std::setw(7) << "-"
+              << " ║ " << std::setw(6) << 100.0 << "%"
+              << " ║ " << std::setw(9) << "all"
+              << " ║ " << std::setw(7) << exactUs << " ║" << std::endl;
+
+    const double factors[4] = { 1.0, 1.5, 2.0, 3.0 };
+    for (int f = 0; f < 4; ++f) {
+        vsm.setKnnParameters(k, factors[f]);
+
+        // neighbour recall and work done
+        size_t found = 0, wanted = 0, scoredTotal = 0;
+        std::vector<KnnIndex::Neighbor> approx;
+        double searchUs = 0.0;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            size_t scored = 0;
+            std::chrono::steady_clock::time_point s0 = std::chrono::steady_clock::now();
+            index.search(queries[i], k, approx, &scored);
+            std::chrono::steady_clock::time_point s1 = std::chrono::steady_clock::now();
+            searchUs += std::chrono::duration<double, std::micro>(s1 - s0).count();
+            scoredTotal += scored;
+            wanted += exact[i].size();
+            for (size_t a = 0; a < approx.size(); ++a) {
+                for (size_t e = 0; e < exact[i].size(); ++e) {
+                    if (approx[a].doc == exact[i][e].doc) {
+                        found++;
+                        break;
+                    }
+                }
+            }
+        }
+
+        int correct = 0;
+        for (size_t i = 0; i < testCounts.size(); ++i) {
+            if (vsm.predictKnn(testCounts[i]) == testLabels[i]) correct++;
+        }
+
+        std::ostringstream name;
+        name << std::fixed << std::setprecision(1) << "kNN WAND (prune x" << factors[f] << ")";
+        std::cout << "║ " << std::left << std::setw(28) << name.str()
+                  << " ║ " << std::right << std::setprecision(2) << std::setw(6) << (100.0 * correct / n) << "%"
+                  << " ║ " << std::setw(6) << (wanted ? 100.0 * found / wanted : 100.0) << "%"
+                  << " ║ " << std::setw(9) << std::setprecision(1) << (double)scoredTotal / n
+                  << " ║ " << std::setprecision(2) << std::setw(7) << searchUs / n << " ║" << std::endl;
+    }
+
+    std::cout << "╚══════════════════════════════╩═════════╩═════════╩═══════════╩═════════╝" << std::endl;
+    std::cout << "[INFO] kNN latency is index search only; the centroid row includes TF-IDF conversion." << std::endl;
+    std::cout << "[INFO] Term table vs dense centroids agree on " << tableAgree << " / " << testDocs.size()
+              << " test docs. Term table + df: " << vsm.termTableSizeBytes() / 1024 << " KiB (dense centroids: "
+              << vsm.getClasses().size() * vec.getVocabularySize() * sizeof(double) / 1024 << " KiB)." << std::endl;
+    std::cout << "[INFO] kNN index: " << index.getDocumentCount() << " docs, " << index.getPostingCount()
+              << " postings in " << index.sizeBytes() / 1024 << " KiB (uncompressed: "
+              << index.getPostingCount() * (sizeof(int) + sizeof(float)) / 1024 << " KiB); held-out test: "
+              << testDocs.size() << " docs." << std::endl;
+}
+
+bool Benchmarks::scratchAllocations(Preprocessor &pre,
+                                    const std::vector<std::string> &rawTexts,
+                                    const std::vector<std::string> &labels,
+                                    const ModelSnapshot *served) {
+    if (rawTexts.empty()) {
+        std::cerr << "Error: no documents loaded.\n";
+        return true;
+    }
+    if (!AllocCounter::enabled()) {
+        std::cout << "[INFO] Allocation counting is off; rebuild with -DEMOTION_COUNT_ALLOCS"
+                  << " to see allocations per document. Timings are still reported.\n";
+    }
+
+    std::vector<std::vector<std::string>> docs;
+    for (size_t i = 0; i < rawTexts.size(); ++i) docs.push_back(pre.process(rawTexts[i]));
+
+    Vectorizer vec;
+    vec.buildVocabulary(docs);
+    std::vector<std::string> vocab = vec.getVocabulary();
+
+    NaiveBayes nb;
+    nb.trainFromDocuments(docs, labels, vocab);
+    std::vector<SparseVector> sparse;
+    for (size_t i = 0; i < docs.size(); ++i) sparse.push_back(vec.transformSparse(docs[i]));
+    LogisticRegression lr(0.01, 20);
+    lr.trainFromSparse(sparse, labels, (int)vocab.size());
+    VSM vsm;
+    vsm.trainFromVectors(vec.transform(docs), labels);
+
+    EnsemblePredictor ens;
+    ens.build(vocab, nb, lr, vsm);
+
+    double n = (double)rawTexts.size();
+    ScratchContext &ctx = ScratchContext::local();
+
+    // warm-up: grow the token slots, arena and score buffers to their steady-state size
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < rawTexts.size(); ++i) {
+            size_t count = pre.processInto(rawTexts[i], ctx);
+            ens.predictId(ctx.tokens.data(), count);
+        }
+    }
+
+    // allocating path: fresh token vector and score buffers per document
+    int heapAgree = 0;
+    uint64_t a0 = AllocCounter::count();
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    std::vector<int> heapIds(rawTexts.size());
+    for (size_t i = 0; i < rawTexts.size(); ++i) {
+        std::vector<std::string> tokens = pre.process(rawTexts[i]);
+        EnsemblePredictor::Scores s;
+        ens.score(tokens, s);
+        heapIds[i] = (int)(std::max_element(s.combined.begin(), s.combined.end()) - s.combined.begin());
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    uint64_t a1 = AllocCounter::count();
+
+    // scratch path: reused token slots, arena id buffer, thread-local scores
+    for (size_t i = 0; i < rawTexts.size(); ++i) {
+        size_t count = pre.processInto(rawTexts[i], ctx);
+        if (ens.predictId(ctx.tokens.data(), count) == heapIds[i]) heapAgree++;
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    uint64_t a2 = AllocCounter::count();
+
+    // served snapshot: every model through the scratch context, warmed the same way
+    int rows = 2;
+    double snapshotAllocs = 0.0, snapshotMicros = 0.0;
+    if (served) {
+        rows = 3;
+        ModelSnapshot::Predictions pred;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < rawTexts.size(); ++i) served->predict(rawTexts[i], ctx, pred);
+        }
+        uint64_t a3 = AllocCounter::count();
+        std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rawTexts.size(); ++i) served->predict(rawTexts[i], ctx, pred);
+        snapshotMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t3).count() / n;
+        snapshotAllocs = (double)(AllocCounter::count() - a3) / n;
+    }
+
+    std::cout << "\n╔══════════════════════════════╦═════════════╦═════════╗" << std::endl;
+    std::cout << "║ Predict path                 ║ allocs/doc  ║ us/doc  ║" << std::endl;
+    std::cout << "╠══════════════════════════════╬═════════════╬═════════╣" << std::endl;
+    std::cout << std::fixed;
+    const char *names[3] = { "process() + score()", "processInto() + predictId()", "ModelSnapshot::predict()" };
+    double allocs[3] = { (double)(a1 - a0) / n, (double)(a2 - a1) / n, snapshotAllocs };
+    double micros[3] = { std::chrono::duration<double, std::micro>(t1 - t0).count() / n,
+                         std::chrono::duration<double, std::micro>(t2 - t1).count() / n, snapshotMicros };
+    for (int k = 0; k < rows; ++k) {
+        std::cout << "║ " << std::left << std::setw(28) << names[k] << " ║ " << std::right;
+        if (AllocCounter::enabled()) std::cout << std::setprecision(2) << std::setw(11) << allocs[k];
+        else std::cout << std::setw(11) << "n/a";
+        std::cout << " ║ " << std::setprecision(2) << std::setw(7) << micros[k] << " ║" << std::endl;
+    }
+    std::cout << "╚══════════════════════════════╩═════════════╩═════════╝" << std::endl;
+    std::cout << "[INFO] " << heapAgree << " / " << rawTexts.size()
+              << " predictions identical across paths; scratch arena holds "
+              << ctx.arena.capacity() / 1024 << " KiB, " << ctx.tokens.size() << " token slots." << std::endl;
+    if (!served) std::cout << "[INFO] Train the models to also check ModelSnapshot::predict()." << std::endl;
+
+    // the warm scratch paths must not touch the heap at all
+    if (!AllocCounter::enabled()) {
+        std::cout << "[INFO] Zero-allocation check skipped (allocation counting is off)." << std::endl;
+        return true;
+    }
+    bool allocationFree = allocs[1] == 0.0 && allocs[2] == 0.0;
+    if (allocationFree) std::cout << "[PASS] Warm scratch paths make 0 allocations per document." << std::endl;
+    else std::cout << "[FAIL] Warm scratch paths allocate: " << std::setprecision(2) << allocs[1]
+                   << " (predictId) / " << allocs[2] << " (snapshot) allocations per document." << std::endl;
+    return allocationFree;
+}
+
+// Helper: latency percentile (microseconds) of a sorted sample
+static double percentile(const std::vector<double> &sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)(q * (double)(sorted.size() - 1));
+    return sorted[i];
+}
+
+void Benchmarks::snapshotServing(const ModelSnapshot &base,
+                                 const std::vector<std::string> &rawTexts) {
+    if (rawTexts.empty()) {
+        std::cerr << "Error: no documents loaded.\n";
+        return;
+    }
+
+    int readers = (int)std::thread::hardware_concurrency() - 1;
+    if (readers < 2) readers = 2;
+    if (readers > 8) readers = 8;
+    const int swaps = 10;
+    const std::chrono::milliseconds swapInterval(100);
+
+    const char *names[2] = { "mutex + in-place copy", "RCU snapshot swap" };
+    double qps[2], p50[2], p99[2], pmax[2];
+    std::atomic<bool> monotonic(true);
+    bool lockFree = false;
+
+    for (int mode = 0; mode < 2; ++mode) {
+        // mode 0: one shared model guarded by a mutex, overwritten under the lock
+        ModelSnapshot locked = base;
+        std::mutex lock;
+        // mode 1: readers pin the current snapshot, the writer publishes a fresh copy
+        ModelRegistry registry;
+        registry.publish(std::make_shared<ModelSnapshot>(base));
+        lockFree = registry.isLockFree();
+
+        std::atomic<bool> stop(false);
+        std::vector<std::vector<double> > latency(readers);
+        std::vector<std::thread> threads;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int r = 0; r < readers; ++r) {
+            threads.push_back(std::thread([&, r]() {
+                ModelSnapshot::Predictions out;
+                unsigned long lastVersion = 0;
+                size_t i = (size_t)r * 7919;
+                while (!stop.load()) {
+                    const std::string &text = rawTexts[i++ % rawTexts.size()];
+                    std::chrono::steady_clock::time_point q0 = std::chrono::steady_clock::now();
+                    if (mode == 0) {
+                        std::lock_guard<std::mutex> guard(lock);
+                        locked.predict(text, out);
+                    }
+                    else {
+                        std::shared_ptr<const ModelSnapshot> snap = registry.acquire();
+                        if (snap->version < lastVersion) monotonic.store(false);
+                        lastVersion = snap->version;
+                        snap->predict(text, out);
+                    }
+                    latency[r].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - q0).count());
+                }
+            }));
+        }
+
+        // writer: republish the model a fixed number of times
+        for (int k = 0; k < swaps; ++k) {
+            std::this_thread::sleep_for(swapInterval);
+            if (mode == 0) {
+                std::lock_guard<std::mutex> guard(lock);
+                locked = base;
+            }
+            else {
+                registry.publish(std::make_shared<ModelSnapshot>(base));
+            }
+        }
+        std::this_thread::sleep_for(swapInterval);
+        stop.store(true);
+        for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<double> all;
+        for (int r = 0; r < readers; ++r) all.insert(all.end(), latency[r].begin(), latency[r].end());
+        std::sort(all.begin(), all.end());
+        qps[mode] = (double)all.size() / seconds;
+        p50[mode] = percentile(all, 0.50);
+        p99[mode] = percentile(all, 0.99);
+        pmax[mode] = all.empty() ? 0.0 : all.back();
+    }
+
+    std::cout << "\n╔═══════════════════════════╦═══════════╦═════════╦═════════╦═══════════╗" << std::endl;
+    std::cout << "║ Serving model             ║ queries/s ║ p50 us  ║ p99 us  ║ max us    ║" << std::endl;
+    std::cout << "╠═══════════════════════════╬═══════════╬═════════╬═════════╬═══════════╣" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int k = 0; k < 2; ++k) {
+        std::cout << "║ " << std::left << std::setw(25) << names[k] << " ║ " << std::right
+                  << std::setw(9) << qps[k] << " ║ " << std::setw(7) << p50[k] << " ║ "
+                  << std::setw(7) << p99[k] << " ║ " << std::setw(9) << pmax[k] << " ║" << std::endl;
+    }
+    std::cout << "╚═══════════════════════════╩═══════════╩═════════╩═════════╩═══════════╝" << std::endl;
+    std::cout << "[INFO] " << readers << " reader threads, " << swaps << " model swaps per run; "
+              << "snapshot versions seen by each reader were "
+              << (monotonic.load() ? "monotonic" : "NOT monotonic!") << "; snapshot reads are "
+              << (lockFree ? "lock-free." : "NOT lock-free on this target.") << std::endl;
+}
+
+// Helper: libm reference for one FastMath function (0 = exp, 1 = log, 2 = sigmoid)
+static double referenceValue(int fn, double x) {
+    if (fn == 0) return std::exp(x);
+    if (fn == 1) return std::log(x);
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+static void fastMathArray(int fn, const double *in, double *out, size_t n) {
+    if (fn == 0) FastMath::expArray(in, out, n);
+    else if (fn == 1) FastMath::logArray(in, out, n);
+    else FastMath::sigmoidArray(in, out, n);
+}
+
+// Helper: same value, treating every NaN as equal
+static bool sameValue(double a, double b) {
+    if (a != a || b != b) return a != a && b != b;
+    return a == b;
+}
+
+void Benchmarks::fastMath() {
+    struct Range {
+        const char *name;
+        int fn;
+        double lo, hi;
+        bool logUniform;
+    };
+    const Range ranges[] = {
+        { "exp   [-745, 709]", 0, -745.0, 709.0, false },
+        { "exp   [-50, 0]", 0, -50.0, 0.0, false },
+        { "log   [1e-300, 1e300]", 1, 1e-300, 1e300, true },
+        { "log   [0.5, 2]", 1, 0.5, 2.0, false },
+        { "sigmoid [-40, 40]", 2, -40.0, 40.0, false },
+    };
+    const size_t numRanges = sizeof(ranges) / sizeof(ranges[0]);
+    const size_t n = 1 << 18;
+    const int reps = 8;
+    const double bound = 1e-14;
+
+    std::vector<FastMath::Kernel> kernels;
+    for (int k = FastMath::SCALAR; k <= FastMath::AVX2; ++k) {
+        if (FastMath::supports((FastMath::Kernel)k)) kernels.push_back((FastMath::Kernel)k);
+    }
+    FastMath::Kernel active = FastMath::getKernel();
+
+    std::mt19937 rng(42);
+    std::vector<double> in(n), ref(n), out(n);
+    bool allWithinBound = true;
+
+    std::cout << "\n╔═══════════════════════╦═════════╦═══════════════╦══════════╦═════════╗" << std::endl;
+    std::cout << "║ Function              ║ Kernel  ║ max rel error ║ ns/value ║ vs libm ║" << std::endl;
+    std::cout << "╠═══════════════════════╬═════════╬═══════════════╬══════════╬═════════╣" << std::endl;
+    for (size_t r = 0; r < numRanges; ++r) {
+        const Range &range = ranges[r];
+        std::uniform_real_distribution<double> dist(range.logUniform ? std::log(range.lo) : range.lo,
+                                                    range.logUniform ? std::log(range.hi) : range.hi);
+        for (size_t i = 0; i < n; ++i) {
+            double u = dist(rng);
+            in[i] = range.logUniform ? std::exp(u) : u;
+        }
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < reps; ++rep) {
+            for (size_t i = 0; i < n; ++i) ref[i] = referenceValue(range.fn, in[i]);
+        }
+        double libmNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (double)(n * reps);
+
+        std::cout << std::fixed << std::setprecision(2) << "║ " << std::left << std::setw(21) << range.name << " ║ "
+                  << std::setw(7) << "libm" << " ║ " << std::right << std::setw(13) << "-" << " ║ "
+                  << std::setw(8) << libmNs << " ║ " << std::setw(6) << 1.0 << "x ║" << std::endl;
+
+        for (size_t k = 0; k < kernels.size(); ++k) {
+            FastMath::setKernel(kernels[k]);
+            t0 = std::chrono::steady_clock::now();
+            for (int rep = 0; rep < reps; ++rep) fastMathArray(range.fn, &in[0], &out[0], n);
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (double)(n * reps);
+
+            // relative error over normal results; subnormal results carry fewer significant bits by definition
+            double maxErr = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                double mag = std::fabs(ref[i]);
+                double err = mag >= DBL_MIN ? std::fabs(out[i] - ref[i]) / mag : (ref[i] == 0.0 ? std::fabs(out[i]) : 0.0);
+                if (err > maxErr || err != err) maxErr = err != err ? HUGE_VAL : err;
+            }
+            if (!(maxErr <= bound)) allWithinBound = false;
+
+            std::cout << "║ " << std::left << std::setw(21) << "" << " ║ " << std::setw(7) << FastMath::kernelName(kernels[k])
+                      << " ║ " << std::right << std::scientific << std::setprecision(3) << std::setw(13) << maxErr
+                      << std::fixed << std::setprecision(2) << " ║ " << std::setw(8) << ns << " ║ "
+                      << std::setw(6) << libmNs / ns << "x ║" << std::endl;
+        }
+    }
+    std::cout << "╚═══════════════════════╩═════════╩═══════════════╩══════════╩═════════╝" << std::endl;
+
+    // special values go through every kernel, including its padded tail path
+    const double inf = HUGE_VAL, nan = std::numeric_limits<double>::quiet_NaN();
+    const double specials[] = { 0.0, -0.0, 1.0, -1.0, inf, -inf, nan, 710.0, -746.0, 4.9e-324, DBL_MIN, DBL_MAX };
+    const size_t numSpecials = sizeof(specials) / sizeof(specials[0]);
+    int specialFailures = 0;
+    for (size_t k = 0; k < kernels.size(); ++k) {
+        FastMath::setKernel(kernels[k]);
+        for (int fn = 0; fn < 3; ++fn) {
+            for (size_t i = 0; i < numSpecials; ++i) {
+                double y = 0.0, want = referenceValue(fn, specials[i]);
+                fastMathArray(fn, &specials[i], &y, 1);
+                bool ok = sameValue(y, want) ||
+                          (std::fabs(want) >= DBL_MIN && std::fabs(want) < inf && std::fabs(y - want) <= bound * std::fabs(want));
+                if (!ok) {
+                    specialFailures++;
+                    std::cout << "[WARN] " << FastMath::kernelName(kernels[k]) << " fn " << fn << "(" << specials[i]
+                              << ") = " << y << ", libm " << want << std::endl;
+                }
+            }
+        }
+    }
+
+    // softmax / log-sum-exp over class-sized vectors against the two-pass libm version
+    double softmaxErr = 0.0, lseErr = 0.0;
+    std::uniform_real_distribution<double> scoreDist(-400.0, 0.0);
+    std::vector<double> scores(7), probs(7);
+    for (int trial = 0; trial < 10000; ++trial) {
+        for (size_t c = 0; c < scores.size(); ++c) scores[c] = scoreDist(rng);
+        double maxScore = *std::max_element(scores.begin(), scores.end());
+        double sum = 0.0;
+        for (size_t c = 0; c < scores.size(); ++c) sum += std::exp(scores[c] - maxScore);
+        double lse = maxScore + std::log(sum);
+        lseErr = std::max(lseErr, std::fabs(FastMath::logSumExp(&scores[0], scores.size()) - lse) / std::fabs(lse));
+
+        probs = scores;
+        FastMath::softmax(&probs[0], probs.size());
+        for (size_t c = 0; c < scores.size(); ++c) {
+            softmaxErr = std::max(softmaxErr, std::fabs(probs[c] - std::exp(scores[c] - maxScore) / sum));
+        }
+    }
+    FastMath::setKernel(active);
+
+    std::cout << std::scientific << std::setprecision(3)
+              << "[INFO] softmax max abs error " << softmaxErr << ", log-sum-exp max rel error " << lseErr << std::endl;
+    std::cout << std::fixed << "[INFO] Active kernel: " << FastMath::kernelName(active) << "; "
+              << specialFailures << " special-value mismatches; accuracy "
+              << (allWithinBound && specialFailures == 0 ? "within" : "OUTSIDE") << " the 1e-14 bound." << std::endl;
+}
+
+// Helper: one dense operation over n elements through the plain loop (kernel < 0) or DenseKernels
+template <class T>
+static double runDenseOp(int op, int kernel, const T *x, T *y, size_t n) {
+    if (kernel < 0) {
+        double sum = 0.0;
+        switch (op) {
+            case 0: for (size_t i = 0; i < n; ++i) sum += (double)x[i] * (double)y[i]; break;
+            case 1: for (size_t i = 0; i < n; ++i) y[i] += (T)1e-9 * x[i]; break;
+            case 2: for (size_t i = 0; i < n; ++i) sum += (double)x[i] * (double)x[i]; sum = std::sqrt(sum); break;
+            default: for (size_t i = 0; i < n; ++i) y[i] *= (T)1.0000001; break;
+        }
+        return sum;
+    }
+    switch (op) {
+        case 0: return DenseKernels::dot(x, y, n);
+        case 1: DenseKernels::axpy((T)1e-9, x, y, n); return 0.0;
+        case 2: return DenseKernels::norm(x, n);
+        default: DenseKernels::scale((T)1.0000001, y, n); return 0.0;
+    }
+}
+
+template <class T>
+static void denseOpRows(const char *typeName, std::mt19937 &rng) {
+    const char *opNames[4] = { "dot", "axpy", "norm", "scale" };
+    const size_t sizes[3] = { 1024, 16384, 262144 };
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    for (size_t s = 0; s < 3; ++s) {
+        size_t n = sizes[s];
+        typename AlignedVector<T>::type x(n), y(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = (T)dist(rng);
+            y[i] = (T)dist(rng);
+        }
+        // about 64M elements per measurement
+        int reps = (int)std::max<size_t>(1, ((size_t)1 << 26) / n);
+
+        for (int op = 0; op < 4; ++op) {
+            double ns[3] = { 0.0, 0.0, 0.0 };   // loop, sse2, avx2
+            const int kernels[3] = { -1, FastMath::SSE2, FastMath::AVX2 };
+            volatile double sink = 0.0;
+            for (int k = 0; k < 3; ++k) {
+                if (kernels[k] >= 0 && !FastMath::setKernel((FastMath::Kernel)kernels[k])) {
+                    ns[k] = -1.0;
+                    continue;
+                }
+                std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+                for (int r = 0; r < reps; ++r) sink = sink + runDenseOp(op, kernels[k], x.data(), y.data(), n);
+                ns[k] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / ((double)n * reps);
+            }
+            double best = ns[2] > 0.0 ? ns[2] : ns[1] > 0.0 ? ns[1] : ns[0];
+
+            std::ostringstream name;
+            name << opNames[op] << " " << typeName;
+            std::cout << "║ " << std::left << std::setw(13) << name.str() << " ║ " << std::right << std::setw(7) << n
+                      << " ║ " << std::fixed << std::setprecision(3) << std::setw(9) << ns[0] << " ║ ";
+            for (int k = 1; k < 3; ++k) {
+                if (ns[k] < 0.0) std::cout << std::setw(9) << "n/a" << " ║ ";
+                else std::cout << std::setw(9) << ns[k] << " ║ ";
+            }
+            std::cout << std::setprecision(2) << std::setw(6) << ns[0] / best << "x ║" << std::endl;
+        }
+    }
+}
+
+void Benchmarks::denseKernels(const std::vector<std::vector<std::string>> &docs,
+                              const std::vector<std::string> &labels) {
+    FastMath::Kernel active = FastMath::getKernel();
+    std::mt19937 rng(7);
+
+    std::cout << "\n╔═══════════════╦═════════╦═══════════╦═══════════╦═══════════╦═════════╗" << std::endl;
+    std::cout << "║ Operation     ║ n       ║ loop ns/e ║ sse2 ns/e ║ avx2 ns/e ║ speedup ║" << std::endl;
+    std::cout << "╠═══════════════╬═════════╬═══════════╬═══════════╬═══════════╬═════════╣" << std::endl;
+    denseOpRows<double>("double", rng);
+    denseOpRows<float>("float", rng);
+    std::cout << "╚═══════════════╩═════════╩═══════════╩═══════════╩═══════════╩═════════╝" << std::endl;
+
+    // end to end: the dense VSM and LR training paths, scalar loops vs each vector kernel
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.empty() || testDocs.empty()) {
+        FastMath::setKernel(active);
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+    Vectorizer vec;
+    vec.buildVocabulary(trainDocs);
+    std::vector<std::vector<int>> trainVectors = vec.transform(trainDocs);
+    std::vector<std::vector<int>> testVectors = vec.transform(testDocs);
+    const int epochs = 5;
+
+    std::cout << "\n╔═════════╦══════════════╦══════════════╦════════════╦════════════╗" << std::endl;
+    std::cout << "║ Kernel  ║ VSM train ms ║ LR train ms  ║ VSM acc. % ║ LR acc. %  ║" << std::endl;
+    std::cout << "╠═════════╬══════════════╬══════════════╬════════════╬════════════╣" << std::endl;
+    for (int k = FastMath::SCALAR; k <= FastMath::AVX2; ++k) {
+        if (!FastMath::setKernel((FastMath::Kernel)k)) continue;
+
+        VSM vsm;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        vsm.trainFromVectors(trainVectors, trainLabels);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        LogisticRegression lr(0.01, epochs);
+        lr.trainFromVectors(trainVectors, trainLabels);
+        std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+        std::cout << "║ " << std::left << std::setw(7) << FastMath::kernelName((FastMath::Kernel)k) << std::right << " ║ "
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ║ "
+                  << std::setw(12) << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ║ "
+                  << std::setprecision(2) << std::setw(10) << vsm.accuracy(testVectors, testLabels) * 100.0 << " ║ "
+                  << std::setw(10) << lr.accuracy(testVectors, testLabels) * 100.0 << " ║" << std::endl;
+    }
+    std::cout << "╚═════════╩══════════════╩══════════════╩════════════╩════════════╝" << std::endl;
+    FastMath::setKernel(active);
+    std::cout << "[INFO] " << trainDocs.size() << " training documents, " << vec.getVocabulary().size()
+              << " features, LR " << epochs << " epochs; scalar = the plain loops." << std::endl;
+}
+
+void Benchmarks::sparseLogistic(const std::vector<std::vector<std::string>> &docs,
+                                const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.empty() || testDocs.empty()) {
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+
+    Vectorizer vec;
+    vec.buildVocabulary(trainDocs);
+    int numFeatures = (int)vec.getVocabulary().size();
+    std::vector<SparseVector> trainSparse, testSparse;
+    for (size_t i = 0; i < trainDocs.size(); ++i) trainSparse.push_back(vec.transformSparse(trainDocs[i]));
+    for (size_t i = 0; i < testDocs.size(); ++i) testSparse.push_back(vec.transformSparse(testDocs[i]));
+
+    // l1, l2 pairs; the first row is the unregularised baseline
+    const double penalties[][2] = {
+        { 0.0, 0.0 }, { 1e-4, 0.0 }, { 3e-4, 0.0 }, { 1e-3, 0.0 }, { 3e-3, 0.0 }, { 1e-2, 0.0 },
+        { 1e-3, 1e-3 }, { 3e-3, 1e-3 }
+    };
+    const size_t numRuns = sizeof(penalties) / sizeof(penalties[0]);
+
+    std::cout << "\n╔════════╦════════╦═══════════╦══════════╦══════════╦═════════╦═════════╦═════════╗" << std::endl;
+    std::cout << "║ L1     ║ L2     ║ non-zero  ║ features ║ size KB  ║ smaller ║ acc. %  ║ us/doc  ║" << std::endl;
+    std::cout << "╠════════╬════════╬═══════════╬══════════╬══════════╬═════════╬═════════╬═════════╣" << std::endl;
+    for (size_t r = 0; r < numRuns; ++r) {
+        LogisticRegression lr(0.01, 100);
+        lr.setRegularization(penalties[r][0], penalties[r][1]);
+        lr.trainFromSparse(trainSparse, trainLabels, numFeatures);
+
+        SparseLogisticRegression sparse;
+        sparse.compact(lr);
+
+        int correct = 0;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < testSparse.size(); ++i) {
+            if (sparse.predict(testSparse[i]) == testLabels[i]) correct++;
+        }
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / (double)testSparse.size();
+
+        size_t weightsTotal = (size_t)numFeatures * sparse.getClasses().size();
+        std::cout << std::scientific << std::setprecision(0)
+                  << "║ " << std::setw(6) << penalties[r][0] << " ║ " << std::setw(6) << penalties[r][1] << " ║ "
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(8) << (weightsTotal ? 100.0 * (double)sparse.getNonZeroCount() / (double)weightsTotal : 0.0) << "% ║ "
+                  << std::setw(8) << sparse.getActiveFeatureCount() << " ║ "
+                  << std::setprecision(1) << std::setw(8) << sparse.sizeBytes() / 1024.0 << " ║ "
+                  << std::setw(6) << (double)sparse.denseSizeBytes() / (double)std::max<size_t>(1, sparse.sizeBytes()) << "x ║ "
+                  << std::setprecision(2) << std::setw(7) << 100.0 * correct / (double)testSparse.size() << " ║ "
+                  << std::setw(7) << micros << " ║" << std::endl;
+    }
+    std::cout << "╚════════╩════════╩═══════════╩══════════╩══════════╩═════════╩═════════╩═════════╝" << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "[INFO] " << trainDocs.size() << " training documents, "
+              << numFeatures << " features; 'smaller' compares with dense double weights ("
+              << (double)numFeatures * 8.0 / 1024.0 << " KB per class)." << std::endl;
+}
+
+// Helper: per-document count of one hardware event, or n/a
+static std::string perDocEvent(const PerfCounters &counters, PerfCounters::Event e, size_t docs) {
+    if (!counters.available(e) || docs == 0) return "n/a";
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << (double)counters.value(e) / (double)docs;
+    return out.str();
+}
+
+void Benchmarks::vocabularyOrder(const std::vector<std::vector<std::string>> &docs,
+                                 const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.empty() || testDocs.empty()) {
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+
+    struct OrderConfig {
+        const char *name;
+        bool reorder;
+        double hotCoverage;
+    };
+    const OrderConfig configs[] = {
+        { "First-seen ids", false, 0.0 },
+        { "Frequency ids", true, 0.0 },
+        { "Frequency + hot tier (90%)", true, 0.9 }
+    };
+    const size_t numConfigs = sizeof(configs) / sizeof(configs[0]);
+
+    // enough repetitions that each timing covers at least ~100k documents
+    size_t reps = std::max<size_t>(1, (100000 + testDocs.size() - 1) / testDocs.size());
+    size_t scored = reps * testDocs.size();
+    std::vector<std::string> baseline(testDocs.size());
+    int vocabSize = 0;
+    size_t sink = 0;
+    PerfCounters counters;
+
+    std::cout << "\n╔══════════════════════════════╦═════════╦═══════════╦══════════╦══════════╦══════════╦══════════╗" << std::endl;
+    std::cout << "║ Vocabulary ids               ║ hot ids ║ lookup ns ║ score ns ║ L1D miss ║ LLC miss ║ same     ║" << std::endl;
+    std::cout << "╠══════════════════════════════╬═════════╬═══════════╬══════════╬══════════╬══════════╬══════════╣" << std::endl;
+    for (size_t k = 0; k < numConfigs; ++k) {
+        Vectorizer vec;
+        vec.buildVocabulary(trainDocs);
+        if (configs[k].reorder) vec.orderByFrequency(trainDocs, configs[k].hotCoverage);
+        vocabSize = vec.getVocabularySize();
+
+        std::vector<SparseVector> trainSparse(trainDocs.size());
+        for (size_t i = 0; i < trainDocs.size(); ++i) trainSparse[i] = vec.transformSparse(trainDocs[i]);
+        NaiveBayes nb;
+        nb.trainFromDocuments(trainDocs, trainLabels, vec.getVocabulary());
+        LogisticRegression lr(0.01, 5);
+        lr.trainFromSparse(trainSparse, trainLabels, vocabSize);
+        VSM vsm;
+        vsm.partialFit(trainSparse, trainLabels, vocabSize);
+
+        // word -> id lookups alone
+        sink = 0;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < reps; ++r) {
+            for (size_t i = 0; i < testDocs.size(); ++i) sink += vec.transformSparse(testDocs[i]).nnz();
+        }
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+        // lookup plus NB, LR and VSM scoring, the serving path
+        std::vector<std::string> combined(testDocs.size());
+        counters.start();
+        for (size_t r = 0; r < reps; ++r) {
+            for (size_t i = 0; i < testDocs.size(); ++i) {
+                SparseVector x = vec.transformSparse(testDocs[i]);
+                std::string nbLabel = nb.predict(testDocs[i]);
+                std::string lrLabel = lr.predictSparse(x);
+                std::string vsmLabel = vsm.predictSparse(x);
+                if (r == 0) combined[i] = nbLabel + "|" + lrLabel + "|" + vsmLabel;
+            }
+        }
+        counters.stop();
+        std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+        if (k == 0) baseline = combined;
+        size_t same = 0;
+        for (size_t i = 0; i < combined.size(); ++i) same += combined[i] == baseline[i] ? 1 : 0;
+
+        std::cout << "║ " << std::left << std::setw(28) << configs[k].name << std::right
+                  << " ║ " << std::setw(7) << vec.getHotSize()
+                  << " ║ " << std::fixed << std::setprecision(1) << std::setw(9)
+                  << std::chrono::duration<double, std::nano>(t1 - t0).count() / (double)scored
+                  << " ║ " << std::setw(8) << std::chrono::duration<double, std::nano>(t2 - t1).count() / (double)scored
+                  << " ║ " << std::setw(8) << perDocEvent(counters, PerfCounters::L1D_READ_MISSES, scored)
+                  << " ║ " << std::setw(8) << perDocEvent(counters, PerfCounters::LLC_MISSES, scored)
+                  << " ║ " << std::setprecision(2) << std::setw(7) << 100.0 * (double)same / (double)combined.size() << "% ║" << std::endl;
+    }
+    std::cout << "╚══════════════════════════════╩═════════╩═══════════╩══════════╩══════════╩══════════╩══════════╝" << std::endl;
+    std::cout << "[INFO] " << trainDocs.size() << " training / " << testDocs.size() << " test documents x " << reps
+              << " passes, " << vocabSize << " words, " << sink / reps << " known tokens per pass. ns and misses are\n"
+              << "       per document; 'same' = NB, LR and VSM labels all equal to the first-seen run." << std::endl;
+    if (!counters.anyAvailable()) {
+        std::cout << "[INFO] Hardware counters unavailable (no PMU or perf_event_paranoid); timings only." << std::endl;
+    }
+}
+
+void Benchmarks::countMinNaiveBayes(const std::vector<std::vector<std::string>> &docs,
+                                    const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> trainDocs, testDocs;
+    std::vector<std::string> trainLabels, testLabels;
+    splitTrainTest(docs, labels, trainDocs, trainLabels, testDocs, testLabels);
+    if (trainDocs.empty() || testDocs.empty()) {
+        std::cerr << "Error: not enough documents for a train/test split.\n";
+        return;
+    }
+
+    Vectorizer vec;
+    vec.buildVocabulary(trainDocs);
+    NaiveBayes nb;
+    nb.trainFromDocuments(trainDocs, trainLabels, vec.getVocabulary());
+    std::vector<std::string> exact(testDocs.size());
+    size_t exactCorrect = 0;
+    for (size_t i = 0; i < testDocs.size(); ++i) {
+        exact[i] = nb.predict(testDocs[i]);
+        if (exact[i] == testLabels[i]) exactCorrect++;
+    }
+
+    // exact (class, word) counts: the sketch error reference and the size of the exact counters
+    std::map<std::pair<std::string, std::string>, uint32_t> pairCounts;
+    for (size_t i = 0; i < trainDocs.size(); ++i) {
+        for (size_t t = 0; t < trainDocs[i].size(); ++t) pairCounts[std::make_pair(trainLabels[i], trainDocs[i][t])]++;
+    }
+    size_t exactBytes = pairCounts.size() * sizeof(uint32_t);
+
+    // caps relative to the exact counters stored as bare uint32 (map overhead not counted)
+    const double fractions[] = { 0.25, 1.0, 4.0, 16.0, 64.0 };
+    const size_t numFractions = sizeof(fractions) / sizeof(fractions[0]);
+    const int depth = 4;
+
+    std::cout << "\n╔═══════════════╦══════════╦═════════════╦═══════════╦═════════╦═════════╦═════════╗" << std::endl;
+    std::cout << "║ Model         ║ size KB  ║ width x d   ║ overcount ║ V est.  ║ acc. %  ║ same %  ║" << std::endl;
+    std::cout << "╠═══════════════╬══════════╬═════════════╬═══════════╬═════════╬═════════╬═════════╣" << std::endl;
+    std::cout << "║ " << std::left << std::setw(13) << "Exact counts" << std::right
+              << " ║ " << std::fixed << std::setprecision(1) << std::setw(8) << exactBytes / 1024.0
+              << " ║ " << std::setw(11) << "-" << " ║ " << std::setw(9) << "0.00"
+              << " ║ " << std::setw(7) << vec.getVocabularySize()
+              << " ║ " << std::setprecision(2) << std::setw(7) << 100.0 * exactCorrect / (double)testDocs.size()
+              << " ║ " << std::setw(7) << 100.0 << " ║" << std::endl;
+    for (size_t f = 0; f < numFractions; ++f) {
+        for (int conservative = 0; conservative <= 1; ++conservative) {
+            // the HyperLogLog takes 1 KB of the cap, so every row keeps some counters
+            size_t cap = std::max<size_t>(2048, (size_t)(fractions[f] * (double)exactBytes) + 1024);
+            CountMinNaiveBayes cms(cap, depth, conservative != 0);
+            cms.train(trainDocs, trainLabels);
+
+            double overcount = 0.0;
+            for (std::map<std::pair<std::string, std::string>, uint32_t>::const_iterator it = pairCounts.begin();
+                 it != pairCounts.end(); ++it) {
+                overcount += (double)cms.getCount(it->first.first, it->first.second) - (double)it->second;
+            }
+            overcount /= (double)std::max<size_t>(1, pairCounts.size());
+
+            size_t correct = 0, same = 0;
+            for (size_t i = 0; i < testDocs.size(); ++i) {
+                std::string label = cms.predict(testDocs[i]);
+                if (label == testLabels[i]) correct++;
+                if (label == exact[i]) same++;
+            }
+
+            std::ostringstream shape;
+            shape << cms.getWidth() << " x " << cms.getDepth();
+            std::cout << "║ " << std::left << std::setw(13) << (conservative ? "CMS conserv." : "CMS") << std::right
+                      << " ║ " << std::setprecision(1) << std::setw(8) << cms.sizeBytes() / 1024.0
+                      << " ║ " << std::setw(11) << shape.str()
+                      << " ║ " << std::setprecision(2) << std::setw(9) << overcount
+                      << " ║ " << std::setprecision(0) << std::setw(7) << cms.estimateVocabularySize()
+                      << " ║ " << std::setprecision(2) << std::setw(7) << 100.0 * correct / (double)testDocs.size()
+                      << " ║ " << std::setw(7) << 100.0 * same / (double)testDocs.size() << " ║" << std::endl;
+        }
+    }
+    std::cout << "╚═══════════════╩══════════╩═════════════╩═══════════╩═════════╩═════════╩═════════╝" << std::endl;
+    std::cout << "[INFO] " << trainDocs.size() << " training documents, " << pairCounts.size()
+              << " (class, word) pairs; overcount = mean sketch estimate minus exact count, "
+              << "same = predictions equal to the exact model." << std::endl;
+}
+
+// Helper: the same text as a retweet-style variant that tokenizes identically
+static std::string textVariant(const std::string &text, int kind) {
+    std::string out = text;
+    if (kind == 1) {
+        for (size_t i = 0; i < out.size(); ++i) out[i] = (char)std::toupper((unsigned char)out[i]);
+    }
+    else if (kind == 2) {
+        out = "... " + out + " !!!";
+    }
+    else if (kind == 3) {
+        out.clear();
+        for (size_t i = 0; i < text.size(); ++i) {
+            out += text[i];
+            if (text[i] == ' ') out += "  ";
+        }
+    }
+    return out;
+}
+
+static bool samePredictions(const ModelSnapshot::Predictions &a, const ModelSnapshot::Predictions &b) {
+    return a.nb == b.nb && a.vsm == b.vsm && a.vsmKnn == b.vsmKnn && a.lr == b.lr &&
+           a.hashLr == b.hashLr && a.ensemble == b.ensemble;
+}
+
+void Benchmarks::predictionCache(const ModelSnapshot &base,
+                                 const std::vector<std::string> &rawTexts) {
+    if (rawTexts.empty()) {
+        std::cerr << "Error: no documents loaded.\n";
+        return;
+    }
+
+    int readers = (int)std::thread::hardware_concurrency() - 1;
+    if (readers < 2) readers = 2;
+    if (readers > 8) readers = 8;
+
+    // skewed traffic: half the requests repeat a "viral" 5% of the texts, each request in one of 4 spellings
+    const size_t numRequests = 50000;
+    std::mt19937 rng(42);
+    size_t viral = std::max<size_t>(1, rawTexts.size() / 20);
+    std::vector<std::string> requests(numRequests);
+    for (size_t q = 0; q < numRequests; ++q) {
+        size_t doc = (rng() % 2 == 0) ? rng() % viral : rng() % rawTexts.size();
+        requests[q] = textVariant(rawTexts[doc], (int)(rng() % 4));
+    }
+
+    // reference answers, uncached and sequential
+    std::vector<ModelSnapshot::Predictions> expected(numRequests);
+    std::vector<char> scorable(numRequests);
+    for (size_t q = 0; q < numRequests; ++q) scorable[q] = base.predict(requests[q], expected[q]) ? 1 : 0;
+
+    const char *names[3] = { "Uncached", "Cached", "Cached + 10 model swaps" };
+    double qps[3], p50[3], p99[3], hitRate[3];
+    size_t mismatches[3];
+    PredictionCache::Stats stats[3];
+
+    for (int mode = 0; mode < 3; ++mode) {
+        ModelRegistry registry;
+        registry.publish(std::make_shared<ModelSnapshot>(base));
+        PredictionCache cache(16384, 16);
+
+        std::atomic<size_t> next(0), wrong(0);
+        std::atomic<bool> stop(false);
+        std::vector<std::vector<double> > latency(readers);
+        std::vector<std::thread> threads;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int r = 0; r < readers; ++r) {
+            threads.push_back(std::thread([&, r]() {
+                ModelSnapshot::Predictions out;
+                size_t q;
+                while ((q = next.fetch_add(1)) < numRequests) {
+                    std::chrono::steady_clock::time_point q0 = std::chrono::steady_clock::now();
+                    std::shared_ptr<const ModelSnapshot> snap = registry.acquire();
+                    bool ok = mode == 0 ? snap->predict(requests[q], out) : cache.predict(*snap, requests[q], out);
+                    latency[r].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - q0).count());
+                    if (ok != (scorable[q] != 0) || (ok && !samePredictions(out, expected[q]))) wrong++;
+                }
+            }));
+        }
+
+        // writer: republish the same models and drop the cache, as a retrain would
+        std::thread writer;
+        if (mode == 2) {
+            writer = std::thread([&]() {
+                for (int k = 0; k < 10 && !stop.load(); ++k) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    registry.publish(std::make_shared<ModelSnapshot>(base));
+                    cache.invalidate();
+                }
+            });
+        }
+        for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+        stop.store(true);
+        if (writer.joinable()) writer.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<double> all;
+        for (int r = 0; r < readers; ++r) all.insert(all.end(), latency[r].begin(), latency[r].end());
+        std::sort(all.begin(), all.end());
+        qps[mode] = (double)all.size() / seconds;
+        p50[mode] = percentile(all, 0.50);
+        p99[mode] = percentile(all, 0.99);
+        stats[mode] = cache.getStats();
+        hitRate[mode] = stats[mode].hitRate();
+        mismatches[mode] = wrong.load();
+    }
+
+    std::cout << "\n╔═══════════════════════════╦═══════════╦═════════╦═════════╦═════════╦═══════════╗" << std::endl;
+    std::cout << "║ Serving path              ║ queries/s ║ p50 us  ║ p99 us  ║ hits %  ║ wrong     ║" << std::endl;
+    std::cout << "╠═══════════════════════════╬═══════════╬═════════╬═════════╬═════════╬═══════════╣" << std::endl;
+    for (int k = 0; k < 3; ++k) {
+        std::cout << "║ " << std::left << std::setw(25) << names[k] << " ║ " << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(9) << qps[k] << " ║ " << std::setprecision(2)
+                  << std::setw(7) << p50[k] << " ║ " << std::setw(7) << p99[k] << " ║ "
+                  << std::setw(7) << (k == 0 ? 0.0 : 100.0 * hitRate[k]) << " ║ "
+                  << std::setw(9) << mismatches[k] << " ║" << std::endl;
+    }
+    std::cout << "╚═══════════════════════════╩═══════════╩═════════╩═════════╩═════════╩═══════════╝" << std::endl;
+    for (int k = 1; k < 3; ++k) {
+        std::cout << "[INFO] " << names[k] << ": " << stats[k].textHits << " text-key hits, " << stats[k].tokenHits
+                  << " token-key hits, " << stats[k].misses << " misses, " << stats[k].staleEntries
+                  << " stale, " << stats[k].evictions << " evictions, " << stats[k].invalidations << " invalidations" << std::endl;
+    }
+    std::cout << "[INFO] " << readers << " reader threads, " << numRequests << " requests over " << rawTexts.size()
+              << " texts; 'wrong' counts answers that differ from the uncached models." << std::endl;
+}
@@ -0,0 +1,277 @@
+#include "../include/CorpusCache.hpp"
+#include "../include/Metrics.hpp"
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CORPUSCACHE_HAVE_MMAP 1
+#endif
+
+// File layout (all sections 8-byte aligned):
+//   Header | docOffsets[numDocs + 1] (u64) | tokenIds[numTokens] (u32) | labelIds[numDocs] (u32)
+//   | string table: vocab then classes, each as u32 length + bytes
+static const char CACHE_MAGIC[8] = { 'E', 'M', 'O', 'C', 'S', 'R', '0', '1' };
+
+struct CacheHeader {
+    char magic[8];
+    uint64_t key;
+    uint64_t numDocs;
+    uint64_t numTokens;
+    uint64_t vocabSize;
+    uint64_t numClasses;
+    uint64_t stringsOffset;
+    uint64_t fileSize;
+};
+
+// Helper: round up to a multiple of 8
+static uint64_t align8(uint64_t n) {
+    return (n + 7) & ~(uint64_t)7;
+}
+
+CorpusCache::CorpusCache()
+    : mapping(0), mappingSize(0), mapped(false), docOffsets(0), tokenIds(0), labelIds(0), numDocs(0) {
+}
+
+CorpusCache::~CorpusCache() {
+    close();
+}
+
+uint64_t CorpusCache::hashString(const std::string &s, uint64_t seed) {
+    uint64_t h = seed;
+    for (size_t i = 0; i < s.size(); ++i) {
+        h ^= (unsigned char)s[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t CorpusCache::hashFile(const std::string &path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in.is_open()) return 0;
+
+    uint64_t h = 1469598103934665603ULL;
+    std::vector<char> buf(1 << 16);
+    while (in) {
+        in.read(&buf[0], (std::streamsize)buf.size());
+        std::streamsize got = in.gcount();
+        for (std::streamsize i = 0; i < got; ++i) {
+            h ^= (unsigned char)buf[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+uint64_t CorpusCache::computeKey(const std::string &dataPath, const std::string &stopPath,
+                                 const std::string &configSignature) {
+    METRIC_TIMER("corpus_cache_hash");
+    uint64_t h = hashFile(dataPath);
+    h = hashString(std::string(reinterpret_cast<const char *>(&h), sizeof(h)), hashFile(stopPath));
+    return hashString(configSignature, h);
+}
+
+bool CorpusCache::write(const std::string &path, uint64_t key,
+                        const std::vector<std::string> &vocab,
+                        const std::vector<std::string> &classList,
+                        const std::vector<std::vector<uint32_t>> &docs,
+                        const std::vector<uint32_t> &labelIds) {
+    METRIC_TIMER("corpus_cache_write");
+    // write to a temporary name and rename, so a crash never leaves a half file behind
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    CacheHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, CACHE_MAGIC, sizeof(h.magic));
+    h.key = key;
+    h.numDocs = docs.size();
+    for (size_t i = 0; i < docs.size(); ++i) h.numTokens += docs[i].size();
+    h.vocabSize = vocab.size();
+    h.numClasses = classList.size();
+    h.stringsOffset = sizeof(CacheHeader) + (h.numDocs + 1) * sizeof(uint64_t)
+                    + align8(h.numTokens * sizeof(uint32_t)) + align8(h.numDocs * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+    uint64_t offset = 0;
+    out.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    for (size_t i = 0; i < docs.size(); ++i) {
+        offset += docs[i].size();
+        out.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    }
+
+    const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    for (size_t i = 0; i < docs.size(); ++i) {
+        if (!docs[i].empty()) {
+            out.write(reinterpret_cast<const char *>(&docs[i][0]), docs[i].size() * sizeof(uint32_t));
+        }
+    }
+    out.write(zeros, align8(h.numTokens * sizeof(uint32_t)) - h.numTokens * sizeof(uint32_t));
+
+    if (!labelIds.empty()) {
+        out.write(reinterpret_cast<const char *>(&labelIds[0]), labelIds.size() * sizeof(uint32_t));
+    }
+    out.write(zeros, align8(h.numDocs * sizeof(uint32_t)) - h.numDocs * sizeof(uint32_t));
+
+    for (int table = 0; table < 2; ++table) {
+        const std::vector<std::string> &strings = table == 0 ? vocab : classList;
+        for (size_t i = 0; i < strings.size(); ++i) {
+            uint32_t len = (uint32_t)strings[i].size();
+            out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+            out.write(strings[i].data(), len);
+        }
+    }
+
+    // patch in the final size so open() can detect truncation
+    h.fileSize = (uint64_t)out.tellp();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.close();
+    if (!out) return false;
+
+    std::remove(path.c_str());
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+bool CorpusCache::open(const std::string &path, uint64_t key) {
+    METRIC_TIMER("corpus_cache_open");
+    close();
+
+#ifdef CORPUSCACHE_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CacheHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void *view = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    mapping = view;
+    mappingSize = (size_t)st.st_size;
+    mapped = true;
+#else
+    std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    mappingSize = (size_t)in.tellg();
+    if (mappingSize < sizeof(CacheHeader)) return false;
+    mapping = std::malloc(mappingSize);
+    in.seekg(0);
+    in.read(static_cast<char *>(mapping), (std::streamsize)mappingSize);
+    mapped = false;
+#endif
+
+    const char *base = static_cast<const char *>(mapping);
+    CacheHeader h;
+    std::memcpy(&h, base, sizeof(h));
+    // counts larger than the file could hold would overflow the offset arithmetic below
+    if (h.numDocs >= mappingSize / sizeof(uint64_t) || h.numTokens > mappingSize / sizeof(uint32_t)) {
+        close();
+        return false;
+    }
+    uint64_t expectedStrings = sizeof(CacheHeader) + (h.numDocs + 1) * sizeof(uint64_t)
+                             + align8(h.numTokens * sizeof(uint32_t)) + align8(h.numDocs * sizeof(uint32_t));
+    if (std::memcmp(h.magic, CACHE_MAGIC, sizeof(h.magic)) != 0 || h.key != key || h.fileSize != mappingSize
+        || h.stringsOffset != expectedStrings || h.stringsOffset > mappingSize) {
+        close();
+        return false;
+    }
+
+    numDocs = (size_t)h.numDocs;
+    docOffsets = reinterpret_cast<const uint64_t *>(base + sizeof(CacheHeader));
+    tokenIds = reinterpret_cast<const uint32_t *>(base + sizeof(CacheHeader) + (h.numDocs + 1) * sizeof(uint64_t));
+    labelIds = reinterpret_cast<const uint32_t *>(reinterpret_cast<const char *>(tokenIds)
+                                                  + align8(h.numTokens * sizeof(uint32_t)));
+
+    // only the string tables are materialized; ids stay in the mapping
+    const char *p = base + h.stringsOffset;
+    const char *end = base + mappingSize;
+    for (int table = 0; table < 2; ++table) {
+        std::vector<std::string> &strings = table == 0 ? vocabulary : classes;
+        uint64_t n = table == 0 ? h.vocabSize : h.numClasses;
+        strings.reserve((size_t)n);
+        for (uint64_t i = 0; i < n; ++i) {
+            uint32_t len;
+            if (p + sizeof(len) > end) { close(); return false; }
+            std::memcpy(&len, p, sizeof(len));
+            p += sizeof(len);
+            if (p + len > end) { close(); return false; }
+            strings.push_back(std::string(p, len));
+            p += len;
+        }
+    }
+
+    // callers index vocab / classes with these ids unchecked, so vet the CSR arrays once here
+    if (docOffsets[0] != 0 || docOffsets[numDocs] != h.numTokens) {
+        close();
+        return false;
+    }
+    for (size_t i = 0; i < numDocs; ++i) {
+        if (docOffsets[i + 1] < docOffsets[i] || labelIds[i] >= h.numClasses) {
+            close();
+            return false;
+        }
+    }
+    for (uint64_t t = 0; t < h.numTokens; ++t) {
+        if (tokenIds[t] >= h.vocabSize) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void CorpusCache::close() {
+    if (mapping) {
+#ifdef CORPUSCACHE_HAVE_MMAP
+        if (mapped) munmap(mapping, mappingSize);
+        else std::free(mapping);
+#else
+        std::free(mapping);
+#endif
+    }
+    mapping = 0;
+    mappingSize = 0;
+    mapped = false;
+    vocabulary.clear();
+    classes.clear();
+    docOffsets = 0;
+    tokenIds = 0;
+    labelIds = 0;
+    numDocs = 0;
+}
+
+bool CorpusCache::isOpen() const {
+    return mapping != 0;
+}
+
+size_t CorpusCache::getDocumentCount() const {
+    return numDocs;
+}
+
+const std::vector<std::string> &CorpusCache::getVocabulary() const {
+    return vocabulary;
+}
+
+const std::vector<std::string> &CorpusCache::getClasses() const {
+    return classes;
+}
+
+const uint32_t *CorpusCache::tokens(size_t i) const {
+    return tokenIds + docOffsets[i];
+}
+
+size_t CorpusCache::tokenCount(size_t i) const {
+    return (size_t)(docOffsets[i + 1] - docOffsets[i]);
+}
+
+uint32_t CorpusCache::label(size_t i) const {
+    return labelIds[i];
+}
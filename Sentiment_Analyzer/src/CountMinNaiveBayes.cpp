@@ -0,0 +1,184 @@
+#include "../include/CountMinNaiveBayes.hpp"
+#include "../include/FastMath.hpp"
+#include "../include/Metrics.hpp"
+#include <cmath>
+#include <algorithm>
+
+static const int DISTINCT_BITS = 10;   // 1024 HyperLogLog registers
+static const int MAX_DEPTH = 16;
+
+// Helper: splitmix64 finaliser
+static inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+// per-thread buffer of (count + 1) values, [token * classes + class]
+static thread_local std::vector<double> smoothedScratch;
+
+CountMinNaiveBayes::CountMinNaiveBayes(size_t memoryBytes, int sketchDepth, bool conservativeUpdate)
+    : depth(std::min(MAX_DEPTH, std::max(1, sketchDepth))), conservative(conservativeUpdate), documentTotal(0) {
+    size_t registers = (size_t)1 << DISTINCT_BITS;
+    size_t tableBytes = memoryBytes > registers ? memoryBytes - registers : 0;
+    width = (uint32_t)std::max<size_t>(1, tableBytes / ((size_t)depth * sizeof(uint32_t)));
+    table.assign((size_t)depth * width, 0);
+    distinctRegisters.assign(registers, 0);
+}
+
+uint64_t CountMinNaiveBayes::hashToken(const std::string &token) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < token.size(); ++i) {
+        h ^= (unsigned char)token[i];
+        h *= 1099511628211ULL;
+    }
+    return mix64(h);
+}
+
+void CountMinNaiveBayes::cells(uint64_t tokenHash, int classId, uint32_t *columns) const {
+    uint64_t key = mix64(tokenHash ^ ((uint64_t)(classId + 1) * 0x9e3779b97f4a7c15ULL));
+    uint32_t a = (uint32_t)key;
+    uint32_t b = (uint32_t)(key >> 32) | 1u;
+    for (int d = 0; d < depth; ++d) columns[d] = (uint32_t)(((uint64_t)a + (uint64_t)d * b) % width);
+}
+
+uint32_t CountMinNaiveBayes::estimate(uint64_t tokenHash, int classId) const {
+    uint32_t columns[MAX_DEPTH];
+    cells(tokenHash, classId, columns);
+    uint32_t best = UINT32_MAX;
+    for (int d = 0; d < depth; ++d) best = std::min(best, table[(size_t)d * width + columns[d]]);
+    return best;
+}
+
+void CountMinNaiveBayes::addToken(uint64_t tokenHash, int classId, uint32_t count) {
+    uint32_t columns[MAX_DEPTH];
+    cells(tokenHash, classId, columns);
+    uint32_t floor = conservative ? estimate(tokenHash, classId) : 0;
+    uint32_t target = floor > UINT32_MAX - count ? UINT32_MAX : floor + count;
+    for (int d = 0; d < depth; ++d) {
+        uint32_t &cell = table[(size_t)d * width + columns[d]];
+        // counters saturate instead of wrapping
+        if (conservative) cell = std::max(cell, target);
+        else cell = cell > UINT32_MAX - count ? UINT32_MAX : cell + count;
+    }
+}
+
+int CountMinNaiveBayes::classIndex(const std::string &label) {
+    std::vector<std::string>::iterator it = std::find(classes.begin(), classes.end(), label);
+    if (it != classes.end()) return (int)(it - classes.begin());
+    classes.push_back(label);
+    classDocCount.push_back(0);
+    classTokenTotal.push_back(0);
+    return (int)classes.size() - 1;
+}
+
+void CountMinNaiveBayes::addDocument(const std::vector<std::string> &tokens, const std::string &label) {
+    int c = classIndex(label);
+    classDocCount[c]++;
+    classTokenTotal[c] += (int64_t)tokens.size();
+    documentTotal++;
+
+    // repeated tokens become one update of their count
+    std::vector<uint64_t> hashes(tokens.size());
+    for (size_t t = 0; t < tokens.size(); ++t) hashes[t] = hashToken(tokens[t]);
+    std::sort(hashes.begin(), hashes.end());
+    for (size_t i = 0; i < hashes.size(); ) {
+        size_t j = i;
+        while (j < hashes.size() && hashes[j] == hashes[i]) j++;
+        addToken(hashes[i], c, (uint32_t)(j - i));
+
+        // HyperLogLog: register = top bits, value = leading-zero rank of the rest
+        uint64_t h = hashes[i];
+        uint8_t &reg = distinctRegisters[h >> (64 - DISTINCT_BITS)];
+        uint64_t rest = (h << DISTINCT_BITS) | ((uint64_t)1 << (DISTINCT_BITS - 1));
+        uint8_t rank = 1;
+        while (!(rest & 0x8000000000000000ULL)) {
+            rest <<= 1;
+            rank++;
+        }
+        reg = std::max(reg, rank);
+        i = j;
+    }
+}
+
+void CountMinNaiveBayes::train(const std::vector<std::vector<std::string>> &docs, const std::vector<std::string> &labels) {
+    METRIC_TIMER("cms_nb_train");
+    for (size_t i = 0; i < docs.size() && i < labels.size(); ++i) addDocument(docs[i], labels[i]);
+}
+
+double CountMinNaiveBayes::estimateVocabularySize() const {
+    double m = (double)distinctRegisters.size();
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (size_t r = 0; r < distinctRegisters.size(); ++r) {
+        sum += std::ldexp(1.0, -(int)distinctRegisters[r]);
+        if (distinctRegisters[r] == 0) zeros++;
+    }
+    double raw = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+    // small-range correction: linear counting while registers are still empty
+    if (raw <= 2.5 * m && zeros > 0) return m * std::log(m / (double)zeros);
+    return raw;
+}
+
+std::string CountMinNaiveBayes::predict(const std::vector<std::string> &tokens) const {
+    METRIC_TIMER("cms_nb_predict");
+    size_t numClasses = classes.size();
+    if (numClasses == 0) return "";
+
+    // log((count + 1) / (total_c + V)) summed over the tokens: one batched log over the estimates
+    std::vector<double> &smoothed = smoothedScratch;
+    smoothed.resize(tokens.size() * numClasses);
+    for (size_t t = 0; t < tokens.size(); ++t) {
+        uint64_t h = hashToken(tokens[t]);
+        for (size_t c = 0; c < numClasses; ++c) smoothed[t * numClasses + c] = (double)estimate(h, (int)c) + 1.0;
+    }
+    FastMath::logArray(smoothed.data(), smoothed.data(), smoothed.size());
+
+    double vocab = std::max(1.0, estimateVocabularySize());
+    size_t best = 0;
+    double bestScore = -INFINITY;
+    for (size_t c = 0; c < numClasses; ++c) {
+        double score = std::log((double)classDocCount[c] / (double)documentTotal) -
+                       (double)tokens.size() * std::log((double)classTokenTotal[c] + vocab);
+        for (size_t t = 0; t < tokens.size(); ++t) score += smoothed[t * numClasses + c];
+        if (score > bestScore) {
+            bestScore = score;
+            best = c;
+        }
+    }
+    return classes[best];
+}
+
+double CountMinNaiveBayes::accuracy(const std::vector<std::vector<std::string>> &docs,
+                                    const std::vector<std::string> &labels) const {
+    if (docs.empty()) return 0.0;
+    size_t correct = 0;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        if (predict(docs[i]) == labels[i]) correct++;
+    }
+    return (double)correct / (double)docs.size();
+}
+
+uint32_t CountMinNaiveBayes::getCount(const std::string &className, const std::string &word) const {
+    std::vector<std::string>::const_iterator it = std::find(classes.begin(), classes.end(), className);
+    if (it == classes.end()) return 0;
+    return estimate(hashToken(word), (int)(it - classes.begin()));
+}
+
+const std::vector<std::string> &CountMinNaiveBayes::getClasses() const {
+    return classes;
+}
+
+uint32_t CountMinNaiveBayes::getWidth() const {
+    return width;
+}
+
+int CountMinNaiveBayes::getDepth() const {
+    return depth;
+}
+
+size_t CountMinNaiveBayes::sizeBytes() const {
+    return table.size() * sizeof(uint32_t) + distinctRegisters.size();
+}
@@ -0,0 +1,47 @@
+#include "../include/CsvStream.hpp"
+
+CsvStream::CsvStream(const std::string &path)
+    : in(path.c_str()), headerSkipped(false), rows(0), bytes(0) {
+}
+
+bool CsvStream::isOpen() const {
+    return in.is_open();
+}
+
+bool CsvStream::next(std::string &text, std::string &label) {
+    while (std::getline(in, line)) {
+        bytes += line.size() + 1;
+        if (!headerSkipped) {
+            headerSkipped = true; continue; // skip header
+        }
+
+        int pos = -1;
+        for (int i = (int)line.size() - 1; i >= 0; --i) {
+            if (line[i] == ',') {
+                pos = i; break;
+            }
+        }
+        if (pos == -1) continue;
+
+        text.assign(line, 0, pos);
+
+        // trim spaces from label
+        size_t s = pos + 1;
+        while (s < line.size() && (line[s] == ' ' || line[s] == '\t' || line[s] == '\r' || line[s] == '\n')) s++;
+        size_t e = line.size();
+        while (e > s && (line[e-1] == ' ' || line[e-1] == '\t' || line[e-1] == '\r' || line[e-1] == '\n')) e--;
+        label.assign(line, s, e - s);
+
+        rows++;
+        return true;
+    }
+    return false;
+}
+
+size_t CsvStream::getRowCount() const {
+    return rows;
+}
+
+uint64_t CsvStream::getBytesRead() const {
+    return bytes;
+}
@@ -0,0 +1,260 @@
+#include "../include/DenseKernels.hpp"
+#include "../include/FastMath.hpp"
+#include <cmath>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define DENSEKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// ---- scalar: the plain loops the models used before ----
+
+template <class T>
+double dotScalar(const T *a, const T *b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += (double)a[i] * (double)b[i];
+    return sum;
+}
+
+template <class T>
+void axpyScalar(T alpha, const T *x, T *y, size_t n) {
+    for (size_t i = 0; i < n; ++i) y[i] += alpha * x[i];
+}
+
+template <class T>
+void scaleScalar(T alpha, T *x, size_t n) {
+    for (size_t i = 0; i < n; ++i) x[i] *= alpha;
+}
+
+#ifdef DENSEKERNELS_X86
+
+// ---- SSE2: 2 doubles / 4 floats per instruction ----
+
+inline double horizontalSum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+double dotSse2(const double *a, const double *b, size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double sum = horizontalSum(_mm_add_pd(s0, s1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+double dotSse2(const float *a, const float *b, size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i), vb = _mm_loadu_ps(b + i);
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_cvtps_pd(va), _mm_cvtps_pd(vb)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(va, va)), _mm_cvtps_pd(_mm_movehl_ps(vb, vb))));
+    }
+    double sum = horizontalSum(_mm_add_pd(s0, s1));
+    for (; i < n; ++i) sum += (double)a[i] * (double)b[i];
+    return sum;
+}
+
+void axpySse2(double alpha, const double *x, double *y, size_t n) {
+    __m128d va = _mm_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+void axpySse2(float alpha, const float *x, float *y, size_t n) {
+    __m128 va = _mm_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+void scaleSse2(double alpha, double *x, size_t n) {
+    __m128d va = _mm_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(x + i, _mm_mul_pd(va, _mm_loadu_pd(x + i)));
+    for (; i < n; ++i) x[i] *= alpha;
+}
+
+void scaleSse2(float alpha, float *x, size_t n) {
+    __m128 va = _mm_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(x + i, _mm_mul_ps(va, _mm_loadu_ps(x + i)));
+    for (; i < n; ++i) x[i] *= alpha;
+}
+
+// ---- AVX2 + FMA: 4 doubles / 8 floats per instruction, four accumulators to hide FMA latency ----
+
+__attribute__((target("avx2,fma")))
+inline double horizontalSumAvx(__m256d v) {
+    __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+__attribute__((target("avx2,fma")))
+double dotAvx2(const double *a, const double *b, size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), s3);
+    }
+    for (; i + 4 <= n; i += 4) s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+    double sum = horizontalSumAvx(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+double dotAvx2(const float *a, const float *b, size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a0 = _mm256_loadu_ps(a + i), b0 = _mm256_loadu_ps(b + i);
+        __m256 a1 = _mm256_loadu_ps(a + i + 8), b1 = _mm256_loadu_ps(b + i + 8);
+        s0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a0)), _mm256_cvtps_pd(_mm256_castps256_ps128(b0)), s0);
+        s1 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a0, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(b0, 1)), s1);
+        s2 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a1)), _mm256_cvtps_pd(_mm256_castps256_ps128(b1)), s2);
+        s3 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a1, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(b1, 1)), s3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(a + i)), _mm256_cvtps_pd(_mm_loadu_ps(b + i)), s0);
+    }
+    double sum = horizontalSumAvx(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    for (; i < n; ++i) sum += (double)a[i] * (double)b[i];
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+void axpyAvx2(double alpha, const double *x, double *y, size_t n) {
+    __m256d va = _mm256_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(y + i + 4, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+__attribute__((target("avx2,fma")))
+void axpyAvx2(float alpha, const float *x, float *y, size_t n) {
+    __m256 va = _mm256_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+        _mm256_storeu_ps(y + i + 8, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8)));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+__attribute__((target("avx2,fma")))
+void scaleAvx2(double alpha, double *x, size_t n) {
+    __m256d va = _mm256_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(x + i, _mm256_mul_pd(va, _mm256_loadu_pd(x + i)));
+    for (; i < n; ++i) x[i] *= alpha;
+}
+
+__attribute__((target("avx2,fma")))
+void scaleAvx2(float alpha, float *x, size_t n) {
+    __m256 va = _mm256_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(x + i, _mm256_mul_ps(va, _mm256_loadu_ps(x + i)));
+    for (; i < n; ++i) x[i] *= alpha;
+}
+
+#endif
+
+inline int activeKernel() {
+    return FastMath::getKernel();
+}
+
+}
+
+double DenseKernels::dot(const double *a, const double *b, size_t n) {
+    switch (activeKernel()) {
+#ifdef DENSEKERNELS_X86
+        case FastMath::AVX2: return dotAvx2(a, b, n);
+        case FastMath::SSE2: return dotSse2(a, b, n);
+#endif
+        default: return dotScalar(a, b, n);
+    }
+}
+
+double DenseKernels::dot(const float *a, const float *b, size_t n) {
+    switch (activeKernel()) {
+#ifdef DENSEKERNELS_X86
+        case FastMath::AVX2: return dotAvx2(a, b, n);
+        case FastMath::SSE2: return dotSse2(a, b, n);
+#endif
+        default: return dotScalar(a, b, n);
+    }
+}
+
+void DenseKernels::axpy(double alpha, const double *x, double *y, size_t n) {
+    switch (activeKernel()) {
+#ifdef DENSEKERNELS_X86
+        case FastMath::AVX2: axpyAvx2(alpha, x, y, n); return;
+        case FastMath::SSE2: axpySse2(alpha, x, y, n); return;
+#endif
+        default: axpyScalar(alpha, x, y, n); return;
+    }
+}
+
+void DenseKernels::axpy(float alpha, const float *x, float *y, size_t n) {
+    switch (activeKernel()) {
+#ifdef DENSEKERNELS_X86
+        case FastMath::AVX2: axpyAvx2(alpha, x, y, n); return;
+        case FastMath::SSE2: axpySse2(alpha, x, y, n); return;
+#endif
+        default: axpyScalar(alpha, x, y, n); return;
+    }
+}
+
+double DenseKernels::squaredNorm(const double *x, size_t n) {
+    return dot(x, x, n);
+}
+
+double DenseKernels::squaredNorm(const float *x, size_t n) {
+    return dot(x, x, n);
+}
+
+double DenseKernels::norm(const double *x, size_t n) {
+    return std::sqrt(dot(x, x, n));
+}
+
+double DenseKernels::norm(const float *x, size_t n) {
+    return std::sqrt(dot(x, x, n));
+}
+
+void DenseKernels::scale(double alpha, double *x, size_t n) {
+    switch (activeKernel()) {
+#ifdef DENSEKERNELS_X86
+        case FastMath::AVX2: scaleAvx2(alpha, x, n); return;
+        case FastMath::SSE2: scaleSse2(alpha, x, n); return;
+#endif
+        default: scaleScalar(alpha, x, n); return;
+    }
+}
+
+void DenseKernels::scale(float alpha, float *x, size_t n) {
+    switch (activeKernel()) {
+#ifdef DENSEKERNELS_X86
+        case FastMath::AVX2: scaleAvx2(alpha, x, n); return;
+        case FastMath::SSE2: scaleSse2(alpha, x, n); return;
+#endif
+        default: scaleScalar(alpha, x, n); return;
+    }
+}
@@ -0,0 +1,277 @@
+#include "../include/EnsemblePredictor.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/ScratchArena.hpp"
+#include <cmath>
+#include <algorithm>
+
+EnsemblePredictor::EnsemblePredictor()
+    : numClasses(0), mode(COMBINE_WEIGHTED_VOTE), weightNB(1.0), weightLR(1.0), weightVSM(1.0) {
+}
+
+// Helper: position of name in list, -1 if missing
+static int indexOf(const std::vector<std::string> &list, const std::string &name) {
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (list[i] == name) return (int)i;
+    }
+    return -1;
+}
+
+// Helper: in-place softmax over log scores
+static void softmaxInPlace(std::vector<double> &v) {
+    if (v.empty()) return;
+    double maxV = *std::max_element(v.begin(), v.end());
+    if (maxV == -INFINITY) {
+        for (size_t i = 0; i < v.size(); ++i) v[i] = 1.0 / (double)v.size();
+        return;
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = std::exp(v[i] - maxV);
+        sum += v[i];
+    }
+    for (size_t i = 0; i < v.size(); ++i) v[i] /= sum;
+}
+
+// Helper: normalize non-negative scores to sum to one (uniform if all zero)
+static void normalizeInPlace(std::vector<double> &v) {
+    double sum = 0.0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (v[i] < 0.0) v[i] = 0.0;
+        sum += v[i];
+    }
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = sum > 0.0 ? v[i] / sum : 1.0 / (double)v.size();
+    }
+}
+
+void EnsemblePredictor::build(const std::vector<std::string> &vocab,
+                              const NaiveBayes &nb,
+                              const LogisticRegression &lr,
+                              const VSM &vsm) {
+    METRIC_TIMER("ensemble_build");
+    classes = nb.getClasses();
+    numClasses = (int)classes.size();
+    int V = (int)vocab.size();
+    int stride = 3 * numClasses;
+
+    vocabIndex.clear();
+    vocabIndex.reserve(vocab.size());
+    for (int v = 0; v < V; ++v) vocabIndex[vocab[v]] = v;
+
+    termTable.assign((size_t)V * stride, 0.0);
+    nbLogPrior.assign(numClasses, -INFINITY);
+    nbLogUnseen.assign(numClasses, 0.0);
+    lrBias.assign(numClasses, 0.0);
+
+    idf = vsm.getIDF();
+    idf.resize(V, 0.0);
+
+    for (int c = 0; c < numClasses; ++c) {
+        const std::string &cls = classes[c];
+
+        // Naive Bayes block
+        double prior = nb.getPrior(cls);
+        if (prior > 0.0) nbLogPrior[c] = std::log(prior);
+        nbLogUnseen[c] = std::log(nb.getUnseenConditional(cls));
+        for (int v = 0; v < V; ++v) {
+            termTable[(size_t)v * stride + c] = std::log(nb.getConditional(cls, vocab[v]));
+        }
+
+        // Logistic Regression block (classes missing from LR keep zero weights)
+        if (indexOf(lr.getClasses(), cls) >= 0) {
+            const std::vector<double> &w = lr.getWeights(cls);
+            lrBias[c] = lr.getBias(cls);
+            int width = std::min(V, (int)w.size());
+            for (int v = 0; v < width; ++v) {
+                termTable[(size_t)v * stride + numClasses + c] = w[v];
+            }
+        }
+
+        // VSM block, pre-divided by the centroid norm so the dot product with the
+        // unit-length TF-IDF query is a cosine (the centroid already carries the IDF)
+        if (indexOf(vsm.getClasses(), cls) >= 0) {
+            const std::vector<double> &centroid = vsm.getCentroid(cls);
+            double norm = vsm.getCentroidNorm(cls);
+            int width = std::min(V, (int)centroid.size());
+            if (norm > 1e-10) {
+                for (int v = 0; v < width; ++v) {
+                    termTable[(size_t)v * stride + 2 * numClasses + c] = centroid[v] / norm;
+                }
+            }
+        }
+    }
+
+    stackWeights.clear();
+}
+
+void EnsemblePredictor::setWeights(double nb, double lr, double vsm) {
+    weightNB = nb;
+    weightLR = lr;
+    weightVSM = vsm;
+}
+
+void EnsemblePredictor::setMode(CombineMode m) {
+    mode = m;
+}
+
+void EnsemblePredictor::scoreModels(const std::string *tokens, size_t count, Scores &out) const {
+    int C = numClasses;
+    int stride = 3 * C;
+
+    ScratchArena &arena = ScratchContext::local().arena;
+    ScratchArena::Marker marker = arena.mark();
+
+    // token -> id, out-of-vocabulary tokens only contribute the NB unseen estimate
+    int *ids = arena.allocArray<int>(count + 1);
+    size_t numIds = 0;
+    int oov = 0;
+    for (size_t t = 0; t < count; ++t) {
+        std::unordered_map<std::string, int>::const_iterator it = vocabIndex.find(tokens[t]);
+        if (it == vocabIndex.end()) oov++;
+        else ids[numIds++] = it->second;
+    }
+    // ascending ids make the table walk sequential and group repeated terms
+    std::sort(ids, ids + numIds);
+
+    out.nb.assign(C, 0.0);
+    out.lr.assign(C, 0.0);
+    out.vsm.assign(C, 0.0);
+    for (int c = 0; c < C; ++c) {
+        out.nb[c] = nbLogPrior[c] + nbLogUnseen[c] * (double)oov;
+        out.lr[c] = lrBias[c];
+    }
+
+    // single fused pass over the distinct query terms
+    double queryNorm = 0.0;
+    for (size_t i = 0; i < numIds; ) {
+        size_t j = i;
+        while (j < numIds && ids[j] == ids[i]) j++;
+
+        int id = ids[i];
+        double n = (double)(j - i);
+        const double *row = &termTable[(size_t)id * stride];
+
+        double q = n * idf[id];
+        queryNorm += q * q;
+
+        for (int c = 0; c < C; ++c) {
+            out.nb[c] += n * row[c];
+            out.lr[c] += n * row[C + c];
+            out.vsm[c] += q * row[2 * C + c];
+        }
+        i = j;
+    }
+    arena.rewind(marker);
+
+    queryNorm = std::sqrt(queryNorm);
+    for (int c = 0; c < C; ++c) {
+        out.lr[c] = 1.0 / (1.0 + std::exp(-out.lr[c]));
+        out.vsm[c] = queryNorm > 1e-10 ? out.vsm[c] / queryNorm : 0.0;
+    }
+
+    softmaxInPlace(out.nb);
+    normalizeInPlace(out.lr);
+    normalizeInPlace(out.vsm);
+}
+
+void EnsemblePredictor::stackedDistribution(const Scores &s, std::vector<double> &out) const {
+    int C = numClasses;
+    int cols = 3 * C + 1;
+    out.assign(C, 0.0);
+
+    for (int k = 0; k < C; ++k) {
+        const double *w = &stackWeights[(size_t)k * cols];
+        double z = w[3 * C];
+        for (int c = 0; c < C; ++c) {
+            z += w[c] * s.nb[c] + w[C + c] * s.lr[c] + w[2 * C + c] * s.vsm[c];
+        }
+        out[k] = z;
+    }
+    softmaxInPlace(out);
+}
+
+void EnsemblePredictor::fitStacking(const std::vector<std::vector<std::string>> &docs,
+                                    const std::vector<std::string> &labels,
+                                    int epochs, double learningRate) {
+    METRIC_TIMER("ensemble_fit_stacking");
+    int C = numClasses;
+    int cols = 3 * C + 1;
+    stackWeights.assign((size_t)C * cols, 0.0);
+    if (docs.empty() || C == 0) return;
+
+    // base-model outputs are fixed, compute them once
+    std::vector<Scores> features(docs.size());
+    std::vector<int> target(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        scoreModels(docs[i].data(), docs[i].size(), features[i]);
+        target[i] = indexOf(classes, labels[i]);
+    }
+
+    std::vector<double> p;
+    for (int ep = 0; ep < epochs; ++ep) {
+        for (size_t i = 0; i < docs.size(); ++i) {
+            if (target[i] < 0) continue;
+            const Scores &s = features[i];
+            stackedDistribution(s, p);
+
+            // softmax cross-entropy gradient
+            for (int k = 0; k < C; ++k) {
+                double error = p[k] - (k == target[i] ? 1.0 : 0.0);
+                double *w = &stackWeights[(size_t)k * cols];
+                for (int c = 0; c < C; ++c) {
+                    w[c] -= learningRate * error * s.nb[c];
+                    w[C + c] -= learningRate * error * s.lr[c];
+                    w[2 * C + c] -= learningRate * error * s.vsm[c];
+                }
+                w[3 * C] -= learningRate * error;
+            }
+        }
+    }
+}
+
+void EnsemblePredictor::score(const std::vector<std::string> &tokens, Scores &out) const {
+    score(tokens.data(), tokens.size(), out);
+}
+
+void EnsemblePredictor::score(const std::string *tokens, size_t count, Scores &out) const {
+    METRIC_TIMER("ensemble_predict");
+    scoreModels(tokens, count, out);
+
+    if (mode == COMBINE_STACKING && !stackWeights.empty()) {
+        stackedDistribution(out, out.combined);
+        return;
+    }
+
+    double total = weightNB + weightLR + weightVSM;
+    if (total <= 0.0) total = 1.0;
+    out.combined.assign(numClasses, 0.0);
+    for (int c = 0; c < numClasses; ++c) {
+        out.combined[c] = (weightNB * out.nb[c] + weightLR * out.lr[c] + weightVSM * out.vsm[c]) / total;
+    }
+}
+
+int EnsemblePredictor::predictId(const std::string *tokens, size_t count) const {
+    if (numClasses == 0) return -1;
+
+    // per-thread score buffers keep their capacity across calls
+    static thread_local Scores s;
+    score(tokens, count, s);
+    return (int)(std::max_element(s.combined.begin(), s.combined.end()) - s.combined.begin());
+}
+
+int EnsemblePredictor::predictId(const std::vector<std::string> &tokens) const {
+    return predictId(tokens.data(), tokens.size());
+}
+
+std::string EnsemblePredictor::predict(const std::vector<std::string> &tokens) const {
+    int id = predictId(tokens);
+    return id < 0 ? "" : classes[id];
+}
+
+const std::vector<std::string> &EnsemblePredictor::getClasses() const {
+    return classes;
+}
+
+bool EnsemblePredictor::isBuilt() const {
+    return numClasses > 0;
+}
@@ -0,0 +1,389 @@
+#include "../include/FastMath.hpp"
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cfloat>
+#include <limits>
+#include <atomic>
+#include <algorithm>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define FASTMATH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const double LOG2E = 1.4426950408889634074;
+// ln2 split so that n * LN2_HI is exact for every exponent n of a double
+const double LN2_HI = 6.93147180369123816490e-01;
+const double LN2_LO = 1.90821492927058770002e-10;
+const double SQRT2 = 1.41421356237309504880;
+// adding 1.5 * 2^52 rounds to an integer and leaves it in the low mantissa bits
+const double ROUND_MAGIC = 6755399441055744.0;
+const double TWO52 = 4503599627370496.0;
+const double TWO54 = 18014398509481984.0;
+const double EXP_MAX = 709.782712893383973096;    // log(DBL_MAX)
+const double EXP_MIN = -745.133219101941108420;   // log of the smallest subnormal
+
+// Chebyshev interpolant of e^r on |r| <= ln2/2, coefficients for r^10 .. r^0;
+// the truncation stays below 4e-16 relative, two degrees under the Taylor series
+const int EXP_TERMS = 11;
+const double EXP_POLY[EXP_TERMS] = {
+    2.7626357241447223e-07, 2.764018079620985e-06, 2.4801504346997686e-05,
+    1.9841170270440067e-04, 1.3888888932488599e-03, 8.333333385667782e-03,
+    4.166666666657314e-02, 1.6666666666554406e-01, 5.000000000000006e-01,
+    1.0000000000000067, 1.0
+};
+
+// log(m) = s P(s^2), s = (m-1)/(m+1): Chebyshev interpolant of 2 atanh(s)/s on
+// s^2 <= (3 - 2 sqrt2)^2 = 0.0294, coefficients for z^6 .. z^0; the truncation
+// stays below 3e-16 relative where the atanh series needs ten terms for the same
+const int LOG_TERMS = 7;
+const double LOG_POLY[LOG_TERMS] = {
+    0.16837659970680488, 0.18121934431215214, 0.22223434547517906,
+    0.2857141602110767, 0.40000000061741614, 0.6666666666655292,
+    2.0000000000000004
+};
+
+// The scalar tier is libm itself: a one-lane polynomial cannot beat it, and
+// std::exp / std::log already handle every special value
+double scalarSigmoid(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+void expScalar(const double *in, double *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::exp(in[i]);
+}
+
+void logScalar(const double *in, double *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::log(in[i]);
+}
+
+void sigmoidScalar(const double *in, double *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = scalarSigmoid(in[i]);
+}
+
+#ifdef FASTMATH_X86
+
+// ---- SSE2: part of the x86-64 baseline, 2 lanes ----
+
+inline __m128d selectSse2(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+// Helper: the full exp with the two-factor 2^n and the special-value fix-ups
+inline __m128d expSse2Full(__m128d x) {
+    const __m128d magic = _mm_set1_pd(ROUND_MAGIC);
+    __m128d xc = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(EXP_MIN)), _mm_set1_pd(EXP_MAX));
+    __m128d t = _mm_add_pd(_mm_mul_pd(xc, _mm_set1_pd(LOG2E)), magic);
+    __m128i n = _mm_sub_epi64(_mm_castpd_si128(t), _mm_castpd_si128(magic));
+    __m128d nd = _mm_sub_pd(t, magic);
+    __m128d r = _mm_sub_pd(_mm_sub_pd(xc, _mm_mul_pd(nd, _mm_set1_pd(LN2_HI))), _mm_mul_pd(nd, _mm_set1_pd(LN2_LO)));
+
+    __m128d p = _mm_set1_pd(EXP_POLY[0]);
+    for (int k = 1; k < EXP_TERMS; ++k) p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(EXP_POLY[k]));
+
+    __m128i e1 = _mm_sub_epi64(_mm_srli_epi64(_mm_add_epi64(n, _mm_set1_epi64x(2048)), 1), _mm_set1_epi64x(1024));
+    __m128i e2 = _mm_sub_epi64(n, e1);
+    const __m128i bias = _mm_set1_epi64x(1023);
+    __m128d y = _mm_mul_pd(_mm_mul_pd(p, _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(e1, bias), 52))),
+                           _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(e2, bias), 52)));
+
+    y = selectSse2(_mm_cmpgt_pd(x, _mm_set1_pd(EXP_MAX)), _mm_set1_pd(HUGE_VAL), y);
+    y = selectSse2(_mm_cmplt_pd(x, _mm_set1_pd(EXP_MIN)), _mm_setzero_pd(), y);
+    return selectSse2(_mm_cmpunord_pd(x, x), x, y);
+}
+
+// Helper: the full log with the subnormal rescale and the special-value fix-ups
+inline __m128d logSse2Full(__m128d x) {
+    __m128d tiny = _mm_cmplt_pd(x, _mm_set1_pd(DBL_MIN));
+    __m128d xs = selectSse2(tiny, _mm_mul_pd(x, _mm_set1_pd(TWO54)), x);
+    __m128i bits = _mm_castpd_si128(xs);
+
+    // biased exponent as a double: drop it into 2^52's mantissa and subtract 2^52
+    const __m128d two52 = _mm_set1_pd(TWO52);
+    __m128d e = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(bits, 52), _mm_castpd_si128(two52))), two52);
+    __m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000fffffffffffffLL)),
+                                              _mm_set1_epi64x(0x3ff0000000000000LL)));
+    __m128d big = _mm_cmpgt_pd(m, _mm_set1_pd(SQRT2));
+    m = selectSse2(big, _mm_mul_pd(m, _mm_set1_pd(0.5)), m);
+    e = _mm_sub_pd(e, _mm_add_pd(_mm_set1_pd(1023.0), _mm_and_pd(tiny, _mm_set1_pd(54.0))));
+    e = _mm_add_pd(e, _mm_and_pd(big, _mm_set1_pd(1.0)));
+
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d s = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+    __m128d z = _mm_mul_pd(s, s);
+    __m128d p = _mm_set1_pd(LOG_POLY[0]);
+    for (int k = 1; k < LOG_TERMS; ++k) p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(LOG_POLY[k]));
+    __m128d y = _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(LN2_HI)),
+                           _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(LN2_LO)), _mm_mul_pd(s, p)));
+
+    const __m128d zero = _mm_setzero_pd();
+    y = selectSse2(_mm_cmpeq_pd(x, zero), _mm_set1_pd(-HUGE_VAL), y);
+    y = selectSse2(_mm_cmplt_pd(x, zero), _mm_set1_pd(std::numeric_limits<double>::quiet_NaN()), y);
+    y = selectSse2(_mm_cmpeq_pd(x, _mm_set1_pd(HUGE_VAL)), x, y);
+    return selectSse2(_mm_cmpunord_pd(x, x), x, y);
+}
+
+// SSE2 has no blend, so the range fix-ups cost about as much as the polynomial;
+// pairs whose results are all normal skip them and the two-factor scaling
+inline __m128d expSse2(__m128d x) {
+    // |x| <= 707 keeps n in [-1020, 1020], so 2^n adds straight into p's exponent
+    const __m128d limit = _mm_set1_pd(707.0);
+    __m128d inRange = _mm_and_pd(_mm_cmpge_pd(x, _mm_sub_pd(_mm_setzero_pd(), limit)), _mm_cmple_pd(x, limit));
+    if (_mm_movemask_pd(inRange) != 3) return expSse2Full(x);
+
+    const __m128d magic = _mm_set1_pd(ROUND_MAGIC);
+    __m128d t = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(LOG2E)), magic);
+    __m128i n = _mm_sub_epi64(_mm_castpd_si128(t), _mm_castpd_si128(magic));
+    __m128d nd = _mm_sub_pd(t, magic);
+    __m128d r = _mm_sub_pd(_mm_sub_pd(x, _mm_mul_pd(nd, _mm_set1_pd(LN2_HI))), _mm_mul_pd(nd, _mm_set1_pd(LN2_LO)));
+
+    __m128d p = _mm_set1_pd(EXP_POLY[0]);
+    for (int k = 1; k < EXP_TERMS; ++k) p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(EXP_POLY[k]));
+    return _mm_castsi128_pd(_mm_add_epi64(_mm_castpd_si128(p), _mm_slli_epi64(n, 52)));
+}
+
+inline __m128d logSse2(__m128d x) {
+    // positive, normal and finite in both lanes (NaN fails both compares)
+    __m128d normal = _mm_and_pd(_mm_cmpge_pd(x, _mm_set1_pd(DBL_MIN)), _mm_cmplt_pd(x, _mm_set1_pd(HUGE_VAL)));
+    if (_mm_movemask_pd(normal) != 3) return logSse2Full(x);
+
+    __m128i bits = _mm_castpd_si128(x);
+    const __m128d two52 = _mm_set1_pd(TWO52);
+    __m128d e = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(bits, 52), _mm_castpd_si128(two52))), two52);
+    __m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000fffffffffffffLL)),
+                                              _mm_set1_epi64x(0x3ff0000000000000LL)));
+    __m128d big = _mm_cmpgt_pd(m, _mm_set1_pd(SQRT2));
+    m = selectSse2(big, _mm_mul_pd(m, _mm_set1_pd(0.5)), m);
+    e = _mm_add_pd(_mm_sub_pd(e, _mm_set1_pd(1023.0)), _mm_and_pd(big, _mm_set1_pd(1.0)));
+
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d s = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+    __m128d z = _mm_mul_pd(s, s);
+    __m128d p = _mm_set1_pd(LOG_POLY[0]);
+    for (int k = 1; k < LOG_TERMS; ++k) p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(LOG_POLY[k]));
+    return _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(LN2_HI)), _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(LN2_LO)), _mm_mul_pd(s, p)));
+}
+
+inline __m128d sigmoidSse2(__m128d x) {
+    const __m128d one = _mm_set1_pd(1.0);
+    return _mm_div_pd(one, _mm_add_pd(one, expSse2(_mm_sub_pd(_mm_setzero_pd(), x))));
+}
+
+// Helper: apply a 2-lane kernel to an array; the tail goes through a padded
+// register so every element sees the same arithmetic regardless of position
+template <__m128d (*F)(__m128d)>
+void mapSse2(const double *in, double *out, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, F(_mm_loadu_pd(in + i)));
+    if (i < n) {
+        double tail[2] = { in[i], 0.0 };
+        _mm_storeu_pd(tail, F(_mm_loadu_pd(tail)));
+        out[i] = tail[0];
+    }
+}
+
+// ---- AVX2 + FMA: 4 lanes, compiled for the target and only called after a CPUID check ----
+
+__attribute__((target("avx2,fma")))
+inline __m256d expAvx2(__m256d x) {
+    const __m256d magic = _mm256_set1_pd(ROUND_MAGIC);
+    __m256d xc = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN)), _mm256_set1_pd(EXP_MAX));
+    __m256d t = _mm256_fmadd_pd(xc, _mm256_set1_pd(LOG2E), magic);
+    __m256i n = _mm256_sub_epi64(_mm256_castpd_si256(t), _mm256_castpd_si256(magic));
+    __m256d nd = _mm256_sub_pd(t, magic);
+    __m256d r = _mm256_fnmadd_pd(nd, _mm256_set1_pd(LN2_HI), xc);
+    r = _mm256_fnmadd_pd(nd, _mm256_set1_pd(LN2_LO), r);
+
+    __m256d p = _mm256_set1_pd(EXP_POLY[0]);
+    for (int k = 1; k < EXP_TERMS; ++k) p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(EXP_POLY[k]));
+
+    __m256i e1 = _mm256_sub_epi64(_mm256_srli_epi64(_mm256_add_epi64(n, _mm256_set1_epi64x(2048)), 1),
+                                  _mm256_set1_epi64x(1024));
+    __m256i e2 = _mm256_sub_epi64(n, e1);
+    const __m256i bias = _mm256_set1_epi64x(1023);
+    __m256d y = _mm256_mul_pd(_mm256_mul_pd(p, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(e1, bias), 52))),
+                              _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(e2, bias), 52)));
+
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(HUGE_VAL), _mm256_cmp_pd(x, _mm256_set1_pd(EXP_MAX), _CMP_GT_OQ));
+    y = _mm256_blendv_pd(y, _mm256_setzero_pd(), _mm256_cmp_pd(x, _mm256_set1_pd(EXP_MIN), _CMP_LT_OQ));
+    return _mm256_blendv_pd(y, x, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256d logAvx2(__m256d x) {
+    __m256d tiny = _mm256_cmp_pd(x, _mm256_set1_pd(DBL_MIN), _CMP_LT_OQ);
+    __m256d xs = _mm256_blendv_pd(x, _mm256_mul_pd(x, _mm256_set1_pd(TWO54)), tiny);
+    __m256i bits = _mm256_castpd_si256(xs);
+
+    const __m256d two52 = _mm256_set1_pd(TWO52);
+    __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(two52))), two52);
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL)),
+                                                    _mm256_set1_epi64x(0x3ff0000000000000LL)));
+    __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(SQRT2), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+    e = _mm256_sub_pd(e, _mm256_add_pd(_mm256_set1_pd(1023.0), _mm256_and_pd(tiny, _mm256_set1_pd(54.0))));
+    e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d p = _mm256_set1_pd(LOG_POLY[0]);
+    for (int k = 1; k < LOG_TERMS; ++k) p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(LOG_POLY[k]));
+    __m256d y = _mm256_fmadd_pd(e, _mm256_set1_pd(LN2_HI), _mm256_fmadd_pd(e, _mm256_set1_pd(LN2_LO), _mm256_mul_pd(s, p)));
+
+    const __m256d zero = _mm256_setzero_pd();
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(-HUGE_VAL), _mm256_cmp_pd(x, zero, _CMP_EQ_OQ));
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(std::numeric_limits<double>::quiet_NaN()), _mm256_cmp_pd(x, zero, _CMP_LT_OQ));
+    y = _mm256_blendv_pd(y, x, _mm256_cmp_pd(x, _mm256_set1_pd(HUGE_VAL), _CMP_EQ_OQ));
+    return _mm256_blendv_pd(y, x, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256d sigmoidAvx2(__m256d x) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    return _mm256_div_pd(one, _mm256_add_pd(one, expAvx2(_mm256_sub_pd(_mm256_setzero_pd(), x))));
+}
+
+template <__m256d (*F)(__m256d)>
+__attribute__((target("avx2,fma")))
+void mapAvx2(const double *in, double *out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, F(_mm256_loadu_pd(in + i)));
+    if (i < n) {
+        double tail[4] = { 0.0, 0.0, 0.0, 0.0 };
+        std::copy(in + i, in + n, tail);
+        _mm256_storeu_pd(tail, F(_mm256_loadu_pd(tail)));
+        std::copy(tail, tail + (n - i), out + i);
+    }
+}
+
+#endif
+
+// Helper: best kernel of this CPU unless EMOTION_SIMD asks for a lower one
+FastMath::Kernel detectKernel() {
+    FastMath::Kernel best = FastMath::supports(FastMath::AVX2) ? FastMath::AVX2
+                          : FastMath::supports(FastMath::SSE2) ? FastMath::SSE2 : FastMath::SCALAR;
+    const char *env = std::getenv("EMOTION_SIMD");
+    if (env) {
+        for (int k = FastMath::SCALAR; k <= FastMath::AVX2; ++k) {
+            if (std::strcmp(env, FastMath::kernelName((FastMath::Kernel)k)) == 0 && k < best) {
+                best = (FastMath::Kernel)k;
+            }
+        }
+    }
+    return best;
+}
+
+std::atomic<int> &activeKernel() {
+    static std::atomic<int> kernel(detectKernel());
+    return kernel;
+}
+
+}
+
+double FastMath::exp(double x) {
+    return std::exp(x);
+}
+
+double FastMath::log(double x) {
+    return std::log(x);
+}
+
+double FastMath::sigmoid(double x) {
+    return scalarSigmoid(x);
+}
+
+void FastMath::expArray(const double *in, double *out, size_t n) {
+    switch (activeKernel().load(std::memory_order_relaxed)) {
+#ifdef FASTMATH_X86
+        case AVX2: mapAvx2<expAvx2>(in, out, n); return;
+        case SSE2: mapSse2<expSse2>(in, out, n); return;
+#endif
+        default: expScalar(in, out, n); return;
+    }
+}
+
+void FastMath::logArray(const double *in, double *out, size_t n) {
+    switch (activeKernel().load(std::memory_order_relaxed)) {
+#ifdef FASTMATH_X86
+        case AVX2: mapAvx2<logAvx2>(in, out, n); return;
+        case SSE2: mapSse2<logSse2>(in, out, n); return;
+#endif
+        default: logScalar(in, out, n); return;
+    }
+}
+
+void FastMath::sigmoidArray(const double *in, double *out, size_t n) {
+    switch (activeKernel().load(std::memory_order_relaxed)) {
+#ifdef FASTMATH_X86
+        case AVX2: mapAvx2<sigmoidAvx2>(in, out, n); return;
+        case SSE2: mapSse2<sigmoidSse2>(in, out, n); return;
+#endif
+        default: sigmoidScalar(in, out, n); return;
+    }
+}
+
+void FastMath::softmax(double *v, size_t n) {
+    if (n == 0) return;
+    double maxValue = *std::max_element(v, v + n);
+    if (maxValue == -HUGE_VAL) {
+        for (size_t i = 0; i < n; ++i) v[i] = 1.0 / (double)n;
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) v[i] -= maxValue;
+    expArray(v, v, n);
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += v[i];
+    double inv = 1.0 / sum;
+    for (size_t i = 0; i < n; ++i) v[i] *= inv;
+}
+
+double FastMath::logSumExp(const double *v, size_t n) {
+    if (n == 0) return -HUGE_VAL;
+    double maxValue = *std::max_element(v, v + n);
+    if (maxValue == -HUGE_VAL || maxValue == HUGE_VAL) return maxValue;
+
+    // shifted values go through a stack buffer so the call never allocates
+    double shifted[64];
+    double sum = 0.0;
+    for (size_t i0 = 0; i0 < n; i0 += 64) {
+        size_t len = std::min<size_t>(64, n - i0);
+        for (size_t i = 0; i < len; ++i) shifted[i] = v[i0 + i] - maxValue;
+        expArray(shifted, shifted, len);
+        for (size_t i = 0; i < len; ++i) sum += shifted[i];
+    }
+    return maxValue + std::log(sum);
+}
+
+bool FastMath::supports(Kernel k) {
+    switch (k) {
+        case SCALAR: return true;
+#ifdef FASTMATH_X86
+        case SSE2: return true;
+        case AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        default: return false;
+    }
+}
+
+FastMath::Kernel FastMath::getKernel() {
+    return (Kernel)activeKernel().load();
+}
+
+bool FastMath::setKernel(Kernel k) {
+    if (!supports(k)) return false;
+    activeKernel().store(k);
+    return true;
+}
+
+const char *FastMath::kernelName(Kernel k) {
+    switch (k) {
+        case SSE2: return "sse2";
+        case AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
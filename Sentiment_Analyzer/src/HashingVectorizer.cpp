@@ -0,0 +1,165 @@
+#include "../include/HashingVectorizer.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+#include <utility>
+
+static const uint32_t WORD_SEED_SALT = 0x9e3779b9u;
+static const uint32_t CHAR_SEED_SALT = 0x85ebca6bu;
+
+HashingVectorizer::HashingVectorizer(int bits, int wordMin, int wordMax,
+                                     int charMin, int charMax, bool signedHashing)
+    : numBits(bits), wordMinN(wordMin), wordMaxN(wordMax),
+      charMinN(charMin), charMaxN(charMax), signedHash(signedHashing), seed(42) {
+    if (numBits < 1) numBits = 1;
+    if (numBits > 30) numBits = 30;   // keep the sign bit independent of the index bits
+}
+
+static inline uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+uint32_t HashingVectorizer::murmur3(const char *key, int len, uint32_t seed) {
+    const uint8_t *data = (const uint8_t *)key;
+    const int nblocks = len / 4;
+    const uint32_t c1 = 0xcc9e2d51u;
+    const uint32_t c2 = 0x1b873593u;
+    uint32_t h1 = seed;
+
+    // body
+    for (int i = 0; i < nblocks; ++i) {
+        uint32_t k1 = (uint32_t)data[i * 4]
+                    | ((uint32_t)data[i * 4 + 1] << 8)
+                    | ((uint32_t)data[i * 4 + 2] << 16)
+                    | ((uint32_t)data[i * 4 + 3] << 24);
+        k1 *= c1;
+        k1 = rotl32(k1, 15);
+        k1 *= c2;
+
+        h1 ^= k1;
+        h1 = rotl32(h1, 13);
+        h1 = h1 * 5 + 0xe6546b64u;
+    }
+
+    // tail
+    const uint8_t *tail = data + nblocks * 4;
+    uint32_t k1 = 0;
+    switch (len & 3) {
+        case 3: k1 ^= (uint32_t)tail[2] << 16; // fall through
+        case 2: k1 ^= (uint32_t)tail[1] << 8;  // fall through
+        case 1: k1 ^= (uint32_t)tail[0];
+                k1 *= c1;
+                k1 = rotl32(k1, 15);
+                k1 *= c2;
+                h1 ^= k1;
+    }
+
+    // finalization mix
+    h1 ^= (uint32_t)len;
+    h1 ^= h1 >> 16;
+    h1 *= 0x85ebca6bu;
+    h1 ^= h1 >> 13;
+    h1 *= 0xc2b2ae35u;
+    h1 ^= h1 >> 16;
+
+    return h1;
+}
+
+// per-thread n-gram and sort buffers, reused across documents
+static thread_local std::string gramScratch;
+static thread_local std::string paddedScratch;
+static thread_local std::vector<std::pair<int, double> > featureScratch;
+
+void HashingVectorizer::addFeature(const std::string &feature, uint32_t featureSeed,
+                                   std::vector<std::pair<int, double> > &features) const {
+    uint32_t h = murmur3(feature.data(), (int)feature.size(), featureSeed);
+    uint32_t mask = (1u << numBits) - 1u;
+
+    double sign = signedHash && (h >> 31) ? -1.0 : 1.0;
+    features.push_back(std::make_pair((int)(h & mask), sign));
+}
+
+SparseVector HashingVectorizer::transformSingle(const std::vector<std::string> &tokens) const {
+    SparseVector vec;
+    transformSingle(tokens.data(), tokens.size(), vec);
+    return vec;
+}
+
+void HashingVectorizer::transformSingle(const std::string *tokens, size_t count, SparseVector &out) const {
+    METRIC_TIMER("hash_vectorize");
+    std::vector<std::pair<int, double> > &pairs = featureScratch;
+    std::string &gram = gramScratch;
+    pairs.clear();
+
+    // word n-grams, tokens joined by a single space
+    int n = (int)count;
+    for (int len = wordMinN; len <= wordMaxN && len >= 1; ++len) {
+        for (int start = 0; start + len <= n; ++start) {
+            gram.clear();
+            for (int k = 0; k < len; ++k) {
+                if (k > 0) gram.push_back(' ');
+                gram += tokens[start + k];
+            }
+            addFeature(gram, seed ^ WORD_SEED_SALT, pairs);
+        }
+    }
+
+    // character n-grams inside each token, padded with word boundaries
+    if (charMinN > 0 && charMaxN >= charMinN) {
+        std::string &padded = paddedScratch;
+        for (int t = 0; t < n; ++t) {
+            padded = " ";
+            padded += tokens[t];
+            padded.push_back(' ');
+            int plen = (int)padded.size();
+
+            for (int len = charMinN; len <= charMaxN; ++len) {
+                for (int start = 0; start + len <= plen; ++start) {
+                    gram.assign(padded, start, len);
+                    addFeature(gram, seed ^ CHAR_SEED_SALT, pairs);
+                }
+            }
+        }
+    }
+
+    // sort by index and merge duplicates
+    std::sort(pairs.begin(), pairs.end());
+
+    out.clear();
+    for (size_t i = 0; i < pairs.size(); ) {
+        int index = pairs[i].first;
+        double sum = 0.0;
+        while (i < pairs.size() && pairs[i].first == index) {
+            sum += pairs[i].second;
+            i++;
+        }
+        if (sum != 0.0) {
+            out.indices.push_back(index);
+            out.values.push_back(sum);
+        }
+    }
+
+    METRIC_COUNT("hash_vectorize_features", pairs.size());
+}
+
+std::vector<SparseVector> HashingVectorizer::transform(const std::vector<std::vector<std::string>> &documents,
+                                                       int numThreads) const {
+    std::vector<SparseVector> matrix(documents.size());
+    int n = (int)documents.size();
+
+    if (numThreads <= 1 || n < numThreads) {
+        for (int i = 0; i < n; ++i) matrix[i] = transformSingle(documents[i]);
+        return matrix;
+    }
+
+    // contiguous slices on the shared pool, each chunk writes only its own rows
+    ThreadPool::shared().parallelFor(0, (size_t)n, 0, [this, &documents, &matrix](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) matrix[i] = transformSingle(documents[i]);
+    });
+
+    return matrix;
+}
+
+int HashingVectorizer::getDimension() const {
+    return 1 << numBits;
+}
@@ -0,0 +1,205 @@
+#include "../include/KnnIndex.hpp"
+#include "../include/Metrics.hpp"
+#include <algorithm>
+
+// Helper: min-heap order on score, so the weakest of the current top-k is at the front
+static bool weakerNeighbor(const KnnIndex::Neighbor &a, const KnnIndex::Neighbor &b) {
+    return a.score > b.score;
+}
+
+// Helper: best first, ties by doc id so exact and approximate results compare cleanly
+static bool strongerNeighbor(const KnnIndex::Neighbor &a, const KnnIndex::Neighbor &b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.doc < b.doc;
+}
+
+// One query term's position in its posting list during a WAND search
+struct WandCursor {
+    PostingList::Cursor it;
+    double q;          // query weight of the term
+    double bound;      // q * max weight in the list
+};
+
+// per-thread search buffers, reused across queries
+static thread_local std::vector<WandCursor> cursorScratch;
+static thread_local std::vector<WandCursor *> orderScratch;
+
+KnnIndex::KnnIndex() : numDocs(0), pruneFactor(1.0) {
+}
+
+void KnnIndex::build(const std::vector<SparseVector> &docs, int numTerms) {
+    METRIC_TIMER("knn_index_build");
+    clear();
+    numDocs = (int)docs.size();
+    int terms = numTerms > 0 ? numTerms : 0;
+
+    // documents are visited in id order, so every list comes out sorted by doc
+    std::vector<std::vector<int> > ids(terms);
+    std::vector<std::vector<float> > weights(terms);
+    for (int d = 0; d < numDocs; ++d) {
+        const SparseVector &v = docs[d];
+        for (size_t k = 0; k < v.nnz(); ++k) {
+            int t = v.indices[k];
+            if (t < 0 || t >= numTerms || v.values[k] <= 0.0) continue;
+            ids[t].push_back(d);
+            weights[t].push_back((float)v.values[k]);
+        }
+    }
+
+    postings.resize(terms);
+    for (int t = 0; t < terms; ++t) postings[t].build(ids[t], weights[t]);
+}
+
+void KnnIndex::clear() {
+    postings.clear();
+    numDocs = 0;
+}
+
+void KnnIndex::setPruneFactor(double factor) {
+    pruneFactor = factor < 1.0 ? 1.0 : factor;
+}
+
+double KnnIndex::getPruneFactor() const {
+    return pruneFactor;
+}
+
+void KnnIndex::search(const SparseVector &query, int k, std::vector<Neighbor> &out,
+                      size_t *docsScored) const {
+    METRIC_TIMER("knn_search");
+    out.clear();
+    if (docsScored) *docsScored = 0;
+    if (k <= 0 || numDocs == 0) return;
+
+    std::vector<WandCursor> &cursors = cursorScratch;
+    cursors.clear();
+    for (size_t i = 0; i < query.nnz(); ++i) {
+        int t = query.indices[i];
+        if (t < 0 || t >= (int)postings.size() || postings[t].empty()) continue;
+        if (query.values[i] <= 0.0) continue;
+        cursors.push_back(WandCursor());
+        WandCursor &c = cursors.back();
+        c.it = PostingList::Cursor(postings[t]);
+        c.q = query.values[i];
+        c.bound = c.q * postings[t].getMaxWeight();
+    }
+
+    std::vector<WandCursor *> &order = orderScratch;
+    order.clear();
+    for (size_t i = 0; i < cursors.size(); ++i) order.push_back(&cursors[i]);
+
+    // the heap is built in place in out
+    std::vector<Neighbor> &heap = out;
+    heap.reserve(k);
+    size_t scored = 0;
+
+    while (true) {
+        // drop exhausted cursors and keep the rest sorted by current doc (few terms: insertion sort)
+        size_t live = 0;
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (!order[i]->it.done()) order[live++] = order[i];
+        }
+        order.resize(live);
+        if (order.empty()) break;
+        for (size_t i = 1; i < order.size(); ++i) {
+            WandCursor *c = order[i];
+            size_t j = i;
+            while (j > 0 && order[j - 1]->it.id() > c->it.id()) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = c;
+        }
+
+        // pivot: first cursor where the summed upper bounds can beat the threshold
+        double threshold = (int)heap.size() < k ? -1.0 : heap.front().score * pruneFactor;
+        double reach = 0.0;
+        size_t p = 0;
+        bool found = false;
+        for (; p < order.size(); ++p) {
+            reach += order[p]->bound;
+            if (reach > threshold) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) break;
+        int pivot = order[p]->it.id();
+
+        if (order[0]->it.id() == pivot) {
+            // every cursor before the pivot is on the pivot doc: score it fully
+            double score = 0.0;
+            for (size_t i = 0; i < order.size() && !order[i]->it.done() && order[i]->it.id() == pivot; ++i) {
+                score += order[i]->q * order[i]->it.weight();
+                order[i]->it.next();
+            }
+            scored++;
+
+            Neighbor n;
+            n.doc = pivot;
+            n.score = score;
+            if ((int)heap.size() < k) {
+                heap.push_back(n);
+                std::push_heap(heap.begin(), heap.end(), weakerNeighbor);
+            }
+            else if (score > heap.front().score) {
+                std::pop_heap(heap.begin(), heap.end(), weakerNeighbor);
+                heap.back() = n;
+                std::push_heap(heap.begin(), heap.end(), weakerNeighbor);
+            }
+        }
+        else {
+            // documents before the pivot cannot reach the threshold: skip the leading cursors
+            for (size_t i = 0; i < p; ++i) order[i]->it.advance(pivot);
+        }
+    }
+
+    std::sort(out.begin(), out.end(), strongerNeighbor);
+    if (docsScored) *docsScored = scored;
+    METRIC_COUNT("knn_docs_scored", scored);
+}
+
+void KnnIndex::searchExact(const SparseVector &query, int k, std::vector<Neighbor> &out) const {
+    out.clear();
+    if (k <= 0 || numDocs == 0) return;
+
+    std::vector<double> acc(numDocs, 0.0);
+    std::vector<char> seen(numDocs, 0);
+    std::vector<int> touched;
+    for (size_t i = 0; i < query.nnz(); ++i) {
+        int t = query.indices[i];
+        if (t < 0 || t >= (int)postings.size() || query.values[i] <= 0.0) continue;
+        for (PostingList::Cursor it(postings[t]); !it.done(); it.next()) {
+            if (!seen[it.id()]) {
+                seen[it.id()] = 1;
+                touched.push_back(it.id());
+            }
+            acc[it.id()] += query.values[i] * it.weight();
+        }
+    }
+
+    for (size_t i = 0; i < touched.size(); ++i) {
+        Neighbor n;
+        n.doc = touched[i];
+        n.score = acc[touched[i]];
+        out.push_back(n);
+    }
+    size_t keep = std::min(out.size(), (size_t)k);
+    std::partial_sort(out.begin(), out.begin() + keep, out.end(), strongerNeighbor);
+    out.resize(keep);
+}
+
+int KnnIndex::getDocumentCount() const {
+    return numDocs;
+}
+
+size_t KnnIndex::getPostingCount() const {
+    size_t total = 0;
+    for (size_t t = 0; t < postings.size(); ++t) total += postings[t].size();
+    return total;
+}
+
+size_t KnnIndex::sizeBytes() const {
+    size_t total = 0;
+    for (size_t t = 0; t < postings.size(); ++t) total += postings[t].sizeBytes();
+    return total;
+}
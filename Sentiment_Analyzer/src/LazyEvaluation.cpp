@@ -0,0 +1,40 @@
+#include "../include/LazyEvaluation.hpp"
+#include "../include/ThreadPool.hpp"
+#include <chrono>
+
+LazyEvaluation::LazyEvaluation() : scheduled(false) {
+}
+
+void LazyEvaluation::schedule(PredictAll predictAll,
+                              std::shared_ptr<const std::vector<std::string>> labels,
+                              const std::vector<std::string> &uniqueLabels,
+                              bool async) {
+    clear();
+    std::vector<std::string> classes = uniqueLabels;
+    std::function<ModelEvaluator::EvaluationMetrics()> job = [predictAll, labels, classes]() {
+        return ModelEvaluator::evaluate(predictAll(), *labels, classes);
+    };
+    if (async) result = ThreadPool::shared().async(job).share();
+    else result = std::async(std::launch::deferred, job).share();
+    scheduled = true;
+}
+
+void LazyEvaluation::clear() {
+    if (scheduled && result.wait_for(std::chrono::seconds(0)) != std::future_status::deferred) {
+        result.wait();
+    }
+    result = std::shared_future<ModelEvaluator::EvaluationMetrics>();
+    scheduled = false;
+}
+
+bool LazyEvaluation::available() const {
+    return scheduled;
+}
+
+bool LazyEvaluation::isReady() const {
+    return scheduled && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+const ModelEvaluator::EvaluationMetrics &LazyEvaluation::get() const {
+    return result.get();
+}
@@ -1,19 +1,53 @@
 #include "../include/LogisticRegression.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/FastMath.hpp"
+#include "../include/DenseKernels.hpp"
 #include <cmath>
 #include <iostream>
+#include <algorithm>
 
-LogisticRegression::LogisticRegression(double lr, int ep) : learningRate(lr), epochs(ep) {
+// Tile sizes for batched scoring: 16 documents x 2048 features (16 KB of weights per class)
+static const size_t BATCH_DOC_BLOCK = 16;
+static const size_t BATCH_FEATURE_BLOCK = 2048;
+
+// per-thread buffers for single-document predict, so scoring does not allocate
+static thread_local std::vector<double> logitScratch;
+static thread_local AlignedVector<double>::type featureScratch;
+
+// Helper: turn per-class logits into sigmoid outputs in place (one batched call) and return the argmax
+static int sigmoidArgmax(double *scores, size_t n) {
+    FastMath::sigmoidArray(scores, scores, n);
+    int best = 0;
+    for (size_t c = 1; c < n; ++c) {
+        if (scores[c] > scores[best]) best = (int)c;
+    }
+    return best;
+}
+
+// Helper: soft threshold, w = sign(w) * max(|w| - t, 0)
+static void softThreshold(double *w, size_t n, double t) {
+    for (size_t j = 0; j < n; ++j) {
+        if (w[j] > t) w[j] -= t;
+        else if (w[j] < -t) w[j] += t;
+        else w[j] = 0.0;
+    }
+}
+
+// Helper: clip one weight towards zero by the L1 penalty it has not received yet
+// (u = total penalty per weight so far, q = penalty this weight has absorbed)
+static inline void applyCumulativeL1(double &w, double &q, double u) {
+    double before = w;
+    if (w > 0.0) w = std::max(0.0, w - (u + q));
+    else if (w < 0.0) w = std::min(0.0, w + (u - q));
+    q += w - before;
+}
+
+LogisticRegression::LogisticRegression(double lr, int ep) : learningRate(lr), epochs(ep), l1Penalty(0.0), l2Penalty(0.0) {
     classes.clear();
     weights.clear();
     bias.clear();
 }
 
-double LogisticRegression::sigmoid(double x) {
-    if (x > 500) return 1.0;
-    if (x < -500) return 0.0;
-    return 1.0 / (1.0 + std::exp(-x));
-}
-
 std::vector<std::vector<int>> LogisticRegression::oneHotEncode(const std::vector<std::string> &labels) {
     int n = (int)labels.size();
     int numClasses = (int)classes.size();
@@ -31,16 +65,10 @@ std::vector<std::vector<int>> LogisticRegression::oneHotEncode(const std::vector
     return encoded;
 }
 
-void LogisticRegression::trainFromVectors(const std::vector<std::vector<int>> &vectors, 
-                                          const std::vector<std::string> &labels) {
-    int numDocs = (int)vectors.size();
-    if (numDocs == 0) return;
-    
-    int vocabSize = (int)vectors[0].size();
-    
+void LogisticRegression::initModel(const std::vector<std::string> &labels, int numFeatures) {
     // Find unique classes
     classes.clear();
-    for (int i = 0; i < numDocs; ++i) {
+    for (size_t i = 0; i < labels.size(); ++i) {
         const std::string &c = labels[i];
         bool found = false;
         for (size_t j = 0; j < classes.size(); ++j) {
@@ -51,19 +79,84 @@ void LogisticRegression::trainFromVectors(const std::vector<std::vector<int>> &v
         }
         if (!found) classes.push_back(c);
     }
-    
-    int numClasses = (int)classes.size();
-    
+
     // Initialize weights and bias
     weights.clear();
     bias.clear();
-    for (int c = 0; c < numClasses; ++c) {
-        weights[classes[c]] = std::vector<double>(vocabSize, 0.0);
+    for (size_t c = 0; c < classes.size(); ++c) {
+        weights[classes[c]] = std::vector<double>(numFeatures, 0.0);
         bias[classes[c]] = 0.0;
     }
+}
+
+void LogisticRegression::growModel(const std::vector<std::string> &labels, int numFeatures) {
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (std::find(classes.begin(), classes.end(), labels[i]) != classes.end()) continue;
+        classes.push_back(labels[i]);
+        weights[labels[i]] = std::vector<double>(numFeatures, 0.0);
+        bias[labels[i]] = 0.0;
+    }
+
+    // never shrink: features beyond a smaller batch width keep their weights
+    for (size_t c = 0; c < classes.size(); ++c) {
+        std::vector<double> &w = weights[classes[c]];
+        if ((int)w.size() < numFeatures) w.resize(numFeatures, 0.0);
+    }
+}
+
+double LogisticRegression::partialFit(const std::vector<SparseVector> &vectors,
+                                      const std::vector<std::string> &labels,
+                                      int numFeatures, int passes) {
+    METRIC_TIMER("lr_partial_fit");
+    size_t numDocs = std::min(vectors.size(), labels.size());
+    if (numDocs == 0) return 0.0;
+
+    growModel(labels, numFeatures);
+
+    std::vector<int> classIds(numDocs);
+    for (size_t i = 0; i < numDocs; ++i) {
+        classIds[i] = (int)(std::find(classes.begin(), classes.end(), labels[i]) - classes.begin());
+    }
+
+    size_t correct = 0;
+    for (int ep = 0; ep < passes; ++ep) {
+        for (size_t i = 0; i < numDocs; ++i) {
+            int predicted = sgdStep(vectors[i], classIds[i]);
+            if (ep == 0 && predicted == classIds[i]) correct++;
+        }
+    }
+    METRIC_COUNT("lr_partial_fit_docs", numDocs);
+    return (double)correct / (double)numDocs;
+}
+
+double LogisticRegression::partialFit(const std::vector<std::vector<int>> &vectors,
+                                      const std::vector<std::string> &labels, int passes) {
+    if (vectors.empty()) return 0.0;
+
+    std::vector<SparseVector> sparse(vectors.size());
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        for (size_t j = 0; j < vectors[i].size(); ++j) {
+            if (vectors[i][j] == 0) continue;
+            sparse[i].indices.push_back((int)j);
+            sparse[i].values.push_back((double)vectors[i][j]);
+        }
+    }
+    return partialFit(sparse, labels, (int)vectors[0].size(), passes);
+}
+
+void LogisticRegression::trainFromVectors(const std::vector<std::vector<int>> &vectors, 
+                                          const std::vector<std::string> &labels) {
+    METRIC_TIMER("lr_train");
+    int numDocs = (int)vectors.size();
+    if (numDocs == 0) return;
+    
+    int vocabSize = (int)vectors[0].size();
     
-    // Convert to double vectors for training
-    std::vector<std::vector<double>> doubleVectors(numDocs);
+    initModel(labels, vocabSize);
+    int numClasses = (int)classes.size();
+    
+    // Convert to aligned double vectors for training
+    std::vector<AlignedVector<double>::type> doubleVectors(numDocs);
     for (int i = 0; i < numDocs; ++i) {
         doubleVectors[i].resize(vocabSize);
         for (int j = 0; j < vocabSize; ++j) {
@@ -73,64 +166,219 @@ void LogisticRegression::trainFromVectors(const std::vector<std::vector<int>> &v
     
     // One-hot encode labels
     std::vector<std::vector<int>> yEncoded = oneHotEncode(labels);
+
+    // resolve map lookups once, the inner loops only touch raw arrays
+    std::vector<double *> w(numClasses);
+    std::vector<double *> b(numClasses);
+    for (int c = 0; c < numClasses; ++c) {
+        w[c] = weights[classes[c]].data();
+        b[c] = &bias[classes[c]];
+    }
     
     // Stochastic gradient descent
+    std::vector<double> predictions(numClasses);
+    for (int ep = 0; ep < epochs; ++ep) {
+        METRIC_TIMER("lr_train_epoch");
+        for (int i = 0; i < numDocs; ++i) {
+            const double *x = doubleVectors[i].data();
+
+            // Forward pass: all class logits first, then one batched sigmoid
+            for (int c = 0; c < numClasses; ++c) {
+                predictions[c] = *b[c] + DenseKernels::dot(w[c], x, vocabSize);
+            }
+            FastMath::sigmoidArray(predictions.data(), predictions.data(), numClasses);
+            
+            // Backward pass (gradient descent): w_c -= lr * error * x
+            for (int c = 0; c < numClasses; ++c) {
+                double error = predictions[c] - (double)yEncoded[i][c];
+                *b[c] -= learningRate * error;
+                DenseKernels::axpy(-learningRate * error, x, w[c], vocabSize);
+
+                // proximal elastic-net step: shrink (L2), then soft-threshold (L1)
+                if (l2Penalty > 0.0) DenseKernels::scale(1.0 - learningRate * l2Penalty, w[c], vocabSize);
+                if (l1Penalty > 0.0) softThreshold(w[c], vocabSize, learningRate * l1Penalty);
+            }
+        }
+    }
+}
+
+std::string LogisticRegression::predict(const std::vector<int> &vector) const {
+    METRIC_TIMER("lr_predict");
+    if (classes.empty()) return "";
+
+    // convert once, then one vectorised dot product per class
+    featureScratch.assign(vector.begin(), vector.end());
+    logitScratch.resize(classes.size());
+    for (size_t c = 0; c < classes.size(); ++c) {
+        const std::string &className = classes[c];
+        const std::vector<double> &w = getWeights(className);
+        size_t width = std::min(featureScratch.size(), w.size());
+        logitScratch[c] = getBias(className) + DenseKernels::dot(w.data(), featureScratch.data(), width);
+    }
+    
+    return classes[sigmoidArgmax(logitScratch.data(), classes.size())];
+}
+
+void LogisticRegression::trainFromSparse(const std::vector<SparseVector> &vectors,
+                                         const std::vector<std::string> &labels,
+                                         int numFeatures) {
+    METRIC_TIMER("lr_train");
+    int numDocs = (int)vectors.size();
+    if (numDocs == 0) return;
+
+    initModel(labels, numFeatures);
+    int numClasses = (int)classes.size();
+
+    // resolve map lookups once, the inner loops only touch raw arrays
+    std::vector<double *> w(numClasses);
+    std::vector<double *> b(numClasses);
+    for (int c = 0; c < numClasses; ++c) {
+        w[c] = &weights[classes[c]][0];
+        b[c] = &bias[classes[c]];
+    }
+
+    std::vector<std::vector<int>> yEncoded = oneHotEncode(labels);
+    std::vector<double> predictions(numClasses);
+
+    // lazy regularisation state: features not in a sample are caught up when next touched
+    bool regularized = l1Penalty > 0.0 || l2Penalty > 0.0;
+    double shrink = 1.0 - learningRate * l2Penalty;
+    double totalL1 = 0.0;                                   // L1 penalty per weight so far
+    std::vector<double> absorbedL1;                         // [class * numFeatures + feature]
+    std::vector<long> shrunkUntil;                          // per feature, step its L2 shrink is current to
+    long step = 0;
+    if (l1Penalty > 0.0) absorbedL1.assign((size_t)numClasses * numFeatures, 0.0);
+    if (l2Penalty > 0.0) shrunkUntil.assign(numFeatures, 0);
+
     for (int ep = 0; ep < epochs; ++ep) {
+        METRIC_TIMER("lr_train_epoch");
         for (int i = 0; i < numDocs; ++i) {
+            const SparseVector &x = vectors[i];
+            size_t nnz = x.nnz();
+
+            // catch up the L2 shrink the active features missed while they were idle
+            if (l2Penalty > 0.0) {
+                for (size_t k = 0; k < nnz; ++k) {
+                    int j = x.indices[k];
+                    if (shrunkUntil[j] == step) continue;
+                    double f = std::pow(shrink, (double)(step - shrunkUntil[j]));
+                    for (int c = 0; c < numClasses; ++c) w[c][j] *= f;
+                    shrunkUntil[j] = step;
+                }
+            }
+
             // Forward pass
-            std::vector<double> predictions(numClasses);
             for (int c = 0; c < numClasses; ++c) {
-                double z = bias[classes[c]];
-                for (int j = 0; j < vocabSize; ++j) {
-                    z += weights[classes[c]][j] * doubleVectors[i][j];
+                double z = *b[c];
+                for (size_t k = 0; k < nnz; ++k) {
+                    z += w[c][x.indices[k]] * x.values[k];
                 }
-                predictions[c] = sigmoid(z);
+                predictions[c] = z;
             }
-            
-            // Backward pass (gradient descent)
+            FastMath::sigmoidArray(predictions.data(), predictions.data(), numClasses);
+
+            // Backward pass, only the active features receive a gradient
             for (int c = 0; c < numClasses; ++c) {
                 double error = predictions[c] - (double)yEncoded[i][c];
-                
-                // Update bias
-                bias[classes[c]] -= learningRate * error;
-                
-                // Update weights
-                for (int j = 0; j < vocabSize; ++j) {
-                    double gradient = error * doubleVectors[i][j];
-                    weights[classes[c]][j] -= learningRate * gradient;
+                *b[c] -= learningRate * error;
+                for (size_t k = 0; k < nnz; ++k) {
+                    w[c][x.indices[k]] -= learningRate * error * x.values[k];
+                }
+            }
+
+            if (!regularized) continue;
+            step++;
+            if (l1Penalty > 0.0) {
+                totalL1 += learningRate * l1Penalty;
+                for (int c = 0; c < numClasses; ++c) {
+                    double *q = &absorbedL1[(size_t)c * numFeatures];
+                    for (size_t k = 0; k < nnz; ++k) {
+                        int j = x.indices[k];
+                        applyCumulativeL1(w[c][j], q[j], totalL1);
+                    }
                 }
             }
         }
     }
+
+    // settle the pending penalties of every weight
+    if (l2Penalty > 0.0) {
+        for (int j = 0; j < numFeatures; ++j) {
+            if (shrunkUntil[j] == step) continue;
+            double f = std::pow(shrink, (double)(step - shrunkUntil[j]));
+            for (int c = 0; c < numClasses; ++c) w[c][j] *= f;
+        }
+    }
+    if (l1Penalty > 0.0) {
+        for (int c = 0; c < numClasses; ++c) {
+            for (int j = 0; j < numFeatures; ++j) {
+                applyCumulativeL1(w[c][j], absorbedL1[(size_t)c * numFeatures + j], totalL1);
+            }
+        }
+    }
 }
 
-std::string LogisticRegression::predict(const std::vector<int> &vector) {
-    int vocabSize = (int)vector.size();
-    
-    double bestProb = -1.0;
-    std::string bestClass = "";
-    
+int LogisticRegression::sgdStep(const SparseVector &x, int classId) {
+    int numClasses = (int)classes.size();
+    size_t nnz = x.nnz();
+    if (numClasses == 0) return 0;
+
+    // Forward pass (class rows are independent, so all logits can be taken before any update)
+    logitScratch.resize(numClasses);
+    for (int c = 0; c < numClasses; ++c) {
+        const std::vector<double> &w = weights[classes[c]];
+        int width = (int)w.size();
+        double z = bias[classes[c]];
+        for (size_t k = 0; k < nnz; ++k) {
+            if (x.indices[k] < width) z += w[x.indices[k]] * x.values[k];
+        }
+        logitScratch[c] = z;
+    }
+    int best = sigmoidArgmax(logitScratch.data(), numClasses);
+
+    for (int c = 0; c < numClasses; ++c) {
+        std::vector<double> &w = weights[classes[c]];
+        double &b = bias[classes[c]];
+        int width = (int)w.size();
+
+        // Backward pass, only the active features receive a gradient
+        double error = logitScratch[c] - (c == classId ? 1.0 : 0.0);
+        b -= learningRate * error;
+        for (size_t k = 0; k < nnz; ++k) {
+            if (x.indices[k] < width) w[x.indices[k]] -= learningRate * error * x.values[k];
+        }
+    }
+    return best;
+}
+
+std::string LogisticRegression::predictSparse(const SparseVector &vector) const {
+    int id = predictSparseId(vector);
+    return id < 0 ? "" : classes[id];
+}
+
+int LogisticRegression::predictSparseId(const SparseVector &vector) const {
+    METRIC_TIMER("lr_predict");
+    if (classes.empty()) return -1;
+
+    logitScratch.resize(classes.size());
     for (size_t c = 0; c < classes.size(); ++c) {
         const std::string &className = classes[c];
-        
-        double z = bias[className];
-        for (int j = 0; j < vocabSize; ++j) {
-            z += weights[className][j] * (double)vector[j];
-        }
-        
-        double prob = sigmoid(z);
-        if (prob > bestProb) {
-            bestProb = prob;
-            bestClass = className;
+        const std::vector<double> &w = getWeights(className);
+        int width = (int)w.size();
+
+        double z = getBias(className);
+        for (size_t k = 0; k < vector.nnz(); ++k) {
+            int j = vector.indices[k];
+            if (j >= 0 && j < width) z += w[j] * vector.values[k];
         }
+        logitScratch[c] = z;
     }
-    
-    if (bestClass == "" && classes.size() > 0) bestClass = classes[0];
-    return bestClass;
+
+    return sigmoidArgmax(logitScratch.data(), classes.size());
 }
 
 double LogisticRegression::accuracy(const std::vector<std::vector<int>> &vectors, 
-                                    const std::vector<std::string> &labels) {
+                                    const std::vector<std::string> &labels) const {
     int n = (int)vectors.size();
     if (n == 0) return 0.0;
     
@@ -142,3 +390,119 @@ double LogisticRegression::accuracy(const std::vector<std::vector<int>> &vectors
     
     return (double)correct / (double)n;
 }
+
+BatchPrediction LogisticRegression::predictBatch(const std::vector<int> *docs, size_t count) const {
+    METRIC_TIMER("lr_predict_batch");
+    BatchPrediction result;
+    result.resize(count, classes);
+    size_t numClasses = classes.size();
+    if (count == 0 || numClasses == 0) return result;
+
+    std::vector<const double *> w(numClasses);
+    size_t width = getWeights(classes[0]).size();
+    for (size_t c = 0; c < numClasses; ++c) {
+        w[c] = getWeights(classes[c]).data();
+    }
+
+    // the document block is converted to doubles once and reused by every class
+    std::vector<AlignedVector<double>::type> block(BATCH_DOC_BLOCK);
+    for (size_t d0 = 0; d0 < count; d0 += BATCH_DOC_BLOCK) {
+        size_t d1 = std::min(count, d0 + BATCH_DOC_BLOCK);
+
+        for (size_t d = d0; d < d1; ++d) {
+            block[d - d0].assign(docs[d].begin(), docs[d].begin() + std::min(width, docs[d].size()));
+            for (size_t c = 0; c < numClasses; ++c) {
+                result.scores[d * numClasses + c] = getBias(classes[c]);
+            }
+        }
+
+        for (size_t f0 = 0; f0 < width; f0 += BATCH_FEATURE_BLOCK) {
+            for (size_t c = 0; c < numClasses; ++c) {
+                const double *wc = w[c];
+                for (size_t d = d0; d < d1; ++d) {
+                    const AlignedVector<double>::type &x = block[d - d0];
+                    size_t f1 = std::min(x.size(), f0 + BATCH_FEATURE_BLOCK);
+                    if (f1 > f0) result.scores[d * numClasses + c] += DenseKernels::dot(wc + f0, x.data() + f0, f1 - f0);
+                }
+            }
+        }
+    }
+
+    FastMath::sigmoidArray(result.scores.data(), result.scores.data(), result.scores.size());
+    result.computeArgmax();
+    METRIC_COUNT("lr_predict_batch_docs", count);
+    return result;
+}
+
+BatchPrediction LogisticRegression::predictBatch(const std::vector<std::vector<int>> &docs) const {
+    return predictBatch(docs.data(), docs.size());
+}
+
+BatchPrediction LogisticRegression::predictBatchSparse(const SparseVector *docs, size_t count) const {
+    METRIC_TIMER("lr_predict_batch");
+    BatchPrediction result;
+    result.resize(count, classes);
+    size_t numClasses = classes.size();
+    if (count == 0 || numClasses == 0) return result;
+
+    std::vector<const double *> w(numClasses);
+    std::vector<double> b(numClasses);
+    int width = (int)getWeights(classes[0]).size();
+    for (size_t c = 0; c < numClasses; ++c) {
+        w[c] = getWeights(classes[c]).data();
+        b[c] = getBias(classes[c]);
+    }
+
+    // sparse inputs touch only nnz rows per class, so documents are scored one at a time
+    for (size_t d = 0; d < count; ++d) {
+        const SparseVector &x = docs[d];
+        double *row = &result.scores[d * numClasses];
+        for (size_t c = 0; c < numClasses; ++c) {
+            double z = b[c];
+            for (size_t k = 0; k < x.nnz(); ++k) {
+                int j = x.indices[k];
+                if (j >= 0 && j < width) z += w[c][j] * x.values[k];
+            }
+            row[c] = z;
+        }
+    }
+    FastMath::sigmoidArray(result.scores.data(), result.scores.data(), result.scores.size());
+
+    result.computeArgmax();
+    METRIC_COUNT("lr_predict_batch_docs", count);
+    return result;
+}
+
+BatchPrediction LogisticRegression::predictBatchSparse(const std::vector<SparseVector> &docs) const {
+    return predictBatchSparse(docs.data(), docs.size());
+}
+
+void LogisticRegression::setRegularization(double l1, double l2) {
+    l1Penalty = l1 > 0.0 ? l1 : 0.0;
+    l2Penalty = l2 > 0.0 ? l2 : 0.0;
+}
+
+double LogisticRegression::getL1Penalty() const {
+    return l1Penalty;
+}
+
+double LogisticRegression::getL2Penalty() const {
+    return l2Penalty;
+}
+
+const std::vector<std::string> &LogisticRegression::getClasses() const {
+    return classes;
+}
+
+const std::vector<double> &LogisticRegression::getWeights(const std::string &className) const {
+    static const std::vector<double> empty;
+    std::map<std::string, std::vector<double>>::const_iterator it = weights.find(className);
+    if (it == weights.end()) return empty;
+    return it->second;
+}
+
+double LogisticRegression::getBias(const std::string &className) const {
+    std::map<std::string, double>::const_iterator it = bias.find(className);
+    if (it == bias.end()) return 0.0;
+    return it->second;
+}
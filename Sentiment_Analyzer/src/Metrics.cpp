@@ -0,0 +1,177 @@
+#include "../include/Metrics.hpp"
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+Metrics::Histogram::Histogram() : count(0), sumNanos(0) {
+    for (int i = 0; i < NUM_BUCKETS; ++i) buckets[i].store(0, std::memory_order_relaxed);
+}
+
+void Metrics::Histogram::observe(double micros) {
+    if (micros < 0.0) micros = 0.0;
+
+    // bucket index = number of bits in the integer part
+    uint64_t v = (uint64_t)micros;
+    int idx = 0;
+    while (v > 0 && idx < NUM_BUCKETS - 1) {
+        v >>= 1;
+        idx++;
+    }
+
+    buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNanos.fetch_add((uint64_t)(micros * 1000.0), std::memory_order_relaxed);
+}
+
+uint64_t Metrics::Histogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+double Metrics::Histogram::getSum() const {
+    return (double)sumNanos.load(std::memory_order_relaxed) / 1000.0;
+}
+
+double Metrics::Histogram::bucketUpperBound(int i) {
+    return std::ldexp(1.0, i);
+}
+
+uint64_t Metrics::Histogram::bucketCount(int i) const {
+    return buckets[i].load(std::memory_order_relaxed);
+}
+
+double Metrics::Histogram::percentile(double p) const {
+    uint64_t total = getCount();
+    if (total == 0) return 0.0;
+
+    uint64_t target = (uint64_t)std::ceil(p * (double)total);
+    if (target == 0) target = 1;
+
+    // linear interpolation inside the bucket that contains the target rank
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        uint64_t inBucket = bucketCount(i);
+        if (seen + inBucket >= target) {
+            double lower = (i == 0) ? 0.0 : bucketUpperBound(i - 1);
+            double upper = bucketUpperBound(i);
+            double frac = (double)(target - seen) / (double)inBucket;
+            return lower + (upper - lower) * frac;
+        }
+        seen += inBucket;
+    }
+    return bucketUpperBound(NUM_BUCKETS - 1);
+}
+
+void Metrics::Histogram::reset() {
+    for (int i = 0; i < NUM_BUCKETS; ++i) buckets[i].store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sumNanos.store(0, std::memory_order_relaxed);
+}
+
+Metrics &Metrics::instance() {
+    static Metrics registry;
+    return registry;
+}
+
+bool Metrics::enabled() {
+#ifdef EMOTION_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+Metrics::Counter &Metrics::counter(const std::string &name) {
+    std::lock_guard<std::mutex> guard(lock);
+    std::map<std::string, Counter *>::iterator it = counters.find(name);
+    if (it != counters.end()) return *it->second;
+
+    Counter *c = new Counter();
+    counters[name] = c;
+    return *c;
+}
+
+Metrics::Histogram &Metrics::histogram(const std::string &name) {
+    std::lock_guard<std::mutex> guard(lock);
+    std::map<std::string, Histogram *>::iterator it = histograms.find(name);
+    if (it != histograms.end()) return *it->second;
+
+    Histogram *h = new Histogram();
+    histograms[name] = h;
+    return *h;
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (std::map<std::string, Counter *>::iterator it = counters.begin(); it != counters.end(); ++it) {
+        it->second->reset();
+    }
+    for (std::map<std::string, Histogram *>::iterator it = histograms.begin(); it != histograms.end(); ++it) {
+        it->second->reset();
+    }
+}
+
+// Prometheus text exposition format; histograms are exported in seconds
+std::string Metrics::toPrometheus() {
+    std::lock_guard<std::mutex> guard(lock);
+    std::ostringstream out;
+    out << std::setprecision(9);
+
+    for (std::map<std::string, Counter *>::iterator it = counters.begin(); it != counters.end(); ++it) {
+        out << "# TYPE emotion_" << it->first << "_total counter\n";
+        out << "emotion_" << it->first << "_total " << it->second->get() << "\n";
+    }
+
+    for (std::map<std::string, Histogram *>::iterator it = histograms.begin(); it != histograms.end(); ++it) {
+        const Histogram &h = *it->second;
+        const std::string base = "emotion_" + it->first + "_seconds";
+
+        out << "# TYPE " << base << " histogram\n";
+        uint64_t cumulative = 0;
+        int last = 0;
+        for (int i = 0; i < Histogram::NUM_BUCKETS; ++i) {
+            if (h.bucketCount(i) > 0) last = i;
+        }
+        for (int i = 0; i <= last; ++i) {
+            cumulative += h.bucketCount(i);
+            out << base << "_bucket{le=\"" << Histogram::bucketUpperBound(i) / 1e6 << "\"} " << cumulative << "\n";
+        }
+        out << base << "_bucket{le=\"+Inf\"} " << h.getCount() << "\n";
+        out << base << "_sum " << h.getSum() / 1e6 << "\n";
+        out << base << "_count " << h.getCount() << "\n";
+    }
+
+    return out.str();
+}
+
+std::string Metrics::toJSON() {
+    std::lock_guard<std::mutex> guard(lock);
+    std::ostringstream out;
+    out << std::setprecision(9);
+
+    out << "{\n  \"counters\": {";
+    bool first = true;
+    for (std::map<std::string, Counter *>::iterator it = counters.begin(); it != counters.end(); ++it) {
+        out << (first ? "\n" : ",\n") << "    \"" << it->first << "\": " << it->second->get();
+        first = false;
+    }
+    out << (first ? "" : "\n  ") << "},\n  \"histograms_us\": {";
+
+    first = true;
+    for (std::map<std::string, Histogram *>::iterator it = histograms.begin(); it != histograms.end(); ++it) {
+        const Histogram &h = *it->second;
+        double mean = h.getCount() == 0 ? 0.0 : h.getSum() / (double)h.getCount();
+
+        out << (first ? "\n" : ",\n") << "    \"" << it->first << "\": {"
+            << "\"count\": " << h.getCount()
+            << ", \"sum\": " << h.getSum()
+            << ", \"mean\": " << mean
+            << ", \"p50\": " << h.percentile(0.50)
+            << ", \"p90\": " << h.percentile(0.90)
+            << ", \"p99\": " << h.percentile(0.99)
+            << "}";
+        first = false;
+    }
+    out << (first ? "" : "\n  ") << "}\n}\n";
+
+    return out.str();
+}
@@ -1,4 +1,5 @@
 #include "../include/ModelEvaluator.hpp"
+#include "../include/Metrics.hpp"
 #include <iostream>
 #include <iomanip>
 #include <cmath>
@@ -8,6 +9,7 @@ ModelEvaluator::EvaluationMetrics ModelEvaluator::evaluate(
     const std::vector<std::string> &actualLabels,
     const std::vector<std::string> &uniqueLabels
 ) {
+    METRIC_TIMER("evaluate");
     EvaluationMetrics metrics;
     
     // Initialize confusion matrix
@@ -0,0 +1,207 @@
+#include "../include/ModelHeaderExporter.hpp"
+#include "../include/EmbeddedPredictor.hpp"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+
+// Helper: C string literal; quotes, backslashes, '?' (trigraphs) and non-printable bytes are escaped
+static std::string cString(const std::string &s) {
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char ch = (unsigned char)s[i];
+        if (ch == '"' || ch == '\\' || ch == '?') {
+            out += '\\';
+            out += (char)ch;
+        } else if (ch < 0x20 || ch >= 0x7f) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\%03o", ch);
+            out += buf;
+        } else {
+            out += (char)ch;
+        }
+    }
+    return out + "\"";
+}
+
+// Helper: one double as a C++ literal that reads back to the same value
+static std::string cDouble(double v) {
+    if (std::isinf(v)) return v < 0 ? "-std::numeric_limits<double>::infinity()" : "std::numeric_limits<double>::infinity()";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", v);
+    return buf;
+}
+
+// Helper: "constexpr <type> <name>[] = { ... };" with perLine values per line
+template <class T, class Format>
+static void writeArray(std::ofstream &out, const char *type, const char *name,
+                       const std::vector<T> &values, size_t perLine, Format format) {
+    out << "constexpr " << type << (type[std::strlen(type) - 1] == '*' ? "" : " ") << name << "[] = {";
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << (i % perLine == 0 ? "\n    " : " ") << format(values[i]) << ",";
+    }
+    out << "\n};\n\n";
+}
+
+static std::string formatString(const std::string &s) { return cString(s); }
+static std::string formatDouble(double v) { return cDouble(v); }
+static uint32_t formatUnsigned(uint32_t v) { return v; }
+static int32_t formatInt(int32_t v) { return v; }
+
+void ModelHeaderExporter::buildPerfectHash(const std::vector<std::string> &words,
+                                           std::vector<uint32_t> &displacement, std::vector<int32_t> &slotWord) {
+    size_t n = words.size();
+    uint32_t numBuckets = (uint32_t)std::max<size_t>(1, (n + 3) / 4);
+    uint32_t tableSize = (uint32_t)std::max<size_t>(1, n + n / 4);
+
+    std::vector<std::vector<int> > buckets(numBuckets);
+    for (size_t i = 0; i < n; ++i) {
+        buckets[EmbeddedHash::hash(words[i].c_str(), 0) % numBuckets].push_back((int)i);
+    }
+
+    // largest buckets first, while the table is still mostly empty
+    std::vector<uint32_t> order(numBuckets);
+    for (uint32_t b = 0; b < numBuckets; ++b) order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    displacement.assign(numBuckets, 0);
+    slotWord.assign(tableSize, -1);
+    std::vector<uint32_t> slots;
+    for (size_t k = 0; k < order.size(); ++k) {
+        const std::vector<int> &bucket = buckets[order[k]];
+        if (bucket.empty()) break;
+
+        for (uint32_t seed = 1; ; ++seed) {
+            slots.clear();
+            for (size_t i = 0; i < bucket.size(); ++i) {
+                uint32_t s = EmbeddedHash::hash(words[bucket[i]].c_str(), seed) % tableSize;
+                if (slotWord[s] != -1 || std::find(slots.begin(), slots.end(), s) != slots.end()) break;
+                slots.push_back(s);
+            }
+            if (slots.size() < bucket.size()) continue;
+
+            for (size_t i = 0; i < bucket.size(); ++i) slotWord[slots[i]] = bucket[i];
+            displacement[order[k]] = seed;
+            break;
+        }
+    }
+}
+
+bool ModelHeaderExporter::write(const std::string &path, const std::string &namespaceName,
+                                const std::vector<std::string> &vocab,
+                                const NaiveBayes &nb, const LogisticRegression &lr, Report &report) {
+    if (namespaceName.empty() || std::isdigit((unsigned char)namespaceName[0])) return false;
+    for (size_t i = 0; i < namespaceName.size(); ++i) {
+        if (!std::isalnum((unsigned char)namespaceName[i]) && namespaceName[i] != '_') return false;
+    }
+
+    // one class list for both models: NB order, then classes only LR has seen
+    const std::vector<std::string> &nbClasses = nb.getClasses();
+    if (nbClasses.empty() || nb.getLogPrior().size() != nbClasses.size() || lr.getClasses().empty()) return false;
+    std::vector<std::string> classes = nbClasses;
+    for (size_t c = 0; c < lr.getClasses().size(); ++c) {
+        if (std::find(classes.begin(), classes.end(), lr.getClasses()[c]) == classes.end()) classes.push_back(lr.getClasses()[c]);
+    }
+    size_t numClasses = classes.size();
+    size_t numWords = vocab.size();
+    const double NEG_INF = -INFINITY;
+
+    std::vector<double> nbLogPrior(numClasses, NEG_INF), nbLogUnseen(numClasses, NEG_INF);
+    std::vector<double> nbLogCond(numWords * numClasses, NEG_INF);
+    for (size_t c = 0; c < nbClasses.size(); ++c) {
+        nbLogPrior[c] = nb.getLogPrior()[c];
+        nbLogUnseen[c] = nb.getLogUnseen()[c];
+    }
+    for (size_t w = 0; w < numWords; ++w) {
+        const double *row = nb.getLogConditionalRow(vocab[w]);
+        if (!row) row = nb.getLogUnseen().data();
+        std::copy(row, row + nbClasses.size(), nbLogCond.begin() + w * numClasses);
+    }
+
+    std::vector<double> lrBias(numClasses, NEG_INF), lrWeights(numWords * numClasses, 0.0);
+    for (size_t c = 0; c < numClasses; ++c) {
+        if (std::find(lr.getClasses().begin(), lr.getClasses().end(), classes[c]) == lr.getClasses().end()) continue;
+        lrBias[c] = lr.getBias(classes[c]);
+        const std::vector<double> &w = lr.getWeights(classes[c]);
+        size_t width = std::min(numWords, w.size());
+        for (size_t j = 0; j < width; ++j) lrWeights[j * numClasses + c] = w[j];
+    }
+
+    std::vector<uint32_t> displacement;
+    std::vector<int32_t> slotWord;
+    buildPerfectHash(vocab, displacement, slotWord);
+
+    // the tables need at least one element each to be valid arrays
+    std::vector<std::string> words = vocab;
+    if (words.empty()) words.push_back("");
+    if (nbLogCond.empty()) nbLogCond.assign(numClasses, NEG_INF);
+    if (lrWeights.empty()) lrWeights.assign(numClasses, 0.0);
+
+    std::string guard;
+    for (size_t i = 0; i < namespaceName.size(); ++i) guard += (char)std::toupper((unsigned char)namespaceName[i]);
+    guard += "_HPP";
+
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath.c_str(), std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    out << "// Generated by EmotionDet (Tools > Export Model as constexpr C++ Header). Do not edit.\n"
+        << "// " << numWords << " words, " << numClasses << " classes: Naive Bayes + Logistic Regression.\n"
+        << "// Score tokens from Preprocessor::process with " << namespaceName << "::Predictor.\n"
+        << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+        << "#include <cstdint>\n#include <limits>\n#include \"EmbeddedPredictor.hpp\"\n\n"
+        << "namespace " << namespaceName << " {\n\n";
+
+    writeArray(out, "const char *", "CLASSES", classes, 8, formatString);
+    writeArray(out, "const char *", "WORDS", words, 8, formatString);
+    writeArray(out, "uint32_t", "DISPLACEMENT", displacement, 16, formatUnsigned);
+    writeArray(out, "int32_t", "SLOT_WORD", slotWord, 16, formatInt);
+    writeArray(out, "double", "NB_LOG_PRIOR", nbLogPrior, numClasses, formatDouble);
+    writeArray(out, "double", "NB_LOG_UNSEEN", nbLogUnseen, numClasses, formatDouble);
+    writeArray(out, "double", "NB_LOG_COND", nbLogCond, numClasses, formatDouble);     // [word][class]
+    writeArray(out, "double", "LR_BIAS", lrBias, numClasses, formatDouble);
+    writeArray(out, "double", "LR_WEIGHTS", lrWeights, numClasses, formatDouble);      // [word][class]
+
+    out << "struct Model {\n"
+        << "    static constexpr int NUM_CLASSES = " << numClasses << ";\n"
+        << "    static constexpr int NUM_WORDS = " << numWords << ";\n"
+        << "    static constexpr uint32_t NUM_BUCKETS = " << displacement.size() << "u;\n"
+        << "    static constexpr uint32_t TABLE_SIZE = " << slotWord.size() << "u;\n\n"
+        << "    static constexpr const char *const *classes() { return CLASSES; }\n"
+        << "    static constexpr const char *const *words() { return WORDS; }\n"
+        << "    static constexpr const uint32_t *displacement() { return DISPLACEMENT; }\n"
+        << "    static constexpr const int32_t *slotWord() { return SLOT_WORD; }\n"
+        << "    static constexpr const double *nbLogPrior() { return NB_LOG_PRIOR; }\n"
+        << "    static constexpr const double *nbLogUnseen() { return NB_LOG_UNSEEN; }\n"
+        << "    static constexpr const double *nbLogCond() { return NB_LOG_COND; }\n"
+        << "    static constexpr const double *lrBias() { return LR_BIAS; }\n"
+        << "    static constexpr const double *lrWeights() { return LR_WEIGHTS; }\n"
+        << "};\n\n"
+        << "typedef EmbeddedPredictor<Model> Predictor;\n\n";
+    if (numWords > 0) {
+        out << "// resolved by the compiler: the exporter and this build hash the same way\n"
+            << "static_assert(Predictor::wordId(" << cString(vocab[0]) << ") == 0, \"perfect hash mismatch\");\n"
+            << "static_assert(Predictor::wordId(" << cString(vocab[numWords - 1]) << ") == " << numWords - 1
+            << ", \"perfect hash mismatch\");\n\n";
+    }
+    out << "}  // namespace " << namespaceName << "\n\n#endif\n";
+    out.close();
+    if (!out) return false;
+
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) return false;
+
+    report = Report();
+    report.words = numWords;
+    report.classes = numClasses;
+    report.buckets = (uint32_t)displacement.size();
+    report.tableSize = (uint32_t)slotWord.size();
+    report.maxDisplacement = displacement.empty() ? 0 : *std::max_element(displacement.begin(), displacement.end());
+    report.tableBytes = displacement.size() * sizeof(uint32_t) + slotWord.size() * sizeof(int32_t) +
+                        (nbLogPrior.size() + nbLogUnseen.size() + nbLogCond.size() + lrBias.size() + lrWeights.size()) * sizeof(double);
+    return true;
+}
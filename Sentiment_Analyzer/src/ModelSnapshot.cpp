@@ -0,0 +1,129 @@
+#include "../include/ModelSnapshot.hpp"
+#include "../include/Metrics.hpp"
+
+ModelSnapshot::ModelSnapshot() : lr(0.01, 100), hashVec(18, 1, 3), version(0) {
+}
+
+bool ModelSnapshot::predict(const std::string &text, Predictions &out) const {
+    return predict(text, ScratchContext::local(), out);
+}
+
+bool ModelSnapshot::predict(const std::string &text, ScratchContext &ctx, Predictions &out) const {
+    METRIC_TIMER("snapshot_predict");
+    size_t count = pre.processInto(text, ctx);
+    if (count == 0) return false;
+    predictTokens(ctx.tokens.data(), count, ctx, out);
+    return true;
+}
+
+// Helper: copy a predicted class into out, reusing its capacity ("" when the model is untrained)
+static void assignLabel(std::string &out, const std::vector<std::string> &classes, int id) {
+    if (id < 0) out.clear();
+    else out.assign(classes[id]);
+}
+
+void ModelSnapshot::predictTokens(const std::string *tokens, size_t count, ScratchContext &ctx, Predictions &out) const {
+    // one sparse count vector serves VSM, kNN and LR (the dense LR dot product only sees its non-zeros)
+    vec.transformSparse(tokens, count, ctx.counts);
+    hashVec.transformSingle(tokens, count, ctx.hashed);
+
+    assignLabel(out.nb, nb.getClasses(), nb.predictId(tokens, count));
+    assignLabel(out.vsm, vsm.getClasses(), vsm.predictSparseId(ctx.counts));
+    assignLabel(out.vsmKnn, vsm.getClasses(), vsm.predictKnnId(ctx.counts));
+    assignLabel(out.lr, lr.getClasses(), lr.predictSparseId(ctx.counts));
+    assignLabel(out.hashLr, hashLr.getClasses(), hashLr.predictSparseId(ctx.hashed));
+    assignLabel(out.ensemble, ensemble.getClasses(), ensemble.predictId(tokens, count));
+}
+
+void ModelSnapshot::predictTokens(const std::vector<std::string> &tokens, Predictions &out) const {
+    predictTokens(tokens.data(), tokens.size(), ScratchContext::local(), out);
+}
+
+ModelRegistry::ModelRegistry() : current((Slot *)0), lastVersion(0) {
+    for (int i = 0; i < NUM_HAZARDS; ++i) hazards[i].store((Slot *)0);
+}
+
+ModelRegistry::~ModelRegistry() {
+    delete current.load();
+    for (size_t i = 0; i < retiredSlots.size(); ++i) delete retiredSlots[i];
+}
+
+// per-thread first hazard record to try, so concurrent readers rarely collide on one record
+static thread_local unsigned int tlsHazardHint = 0;
+
+std::shared_ptr<const ModelSnapshot> ModelRegistry::acquire() const {
+    if (tlsHazardHint == 0) {
+        static std::atomic<unsigned int> nextHint(1);
+        tlsHazardHint = nextHint.fetch_add(1);
+    }
+
+    while (true) {
+        Slot *slot = current.load();
+        if (!slot) return std::shared_ptr<const ModelSnapshot>();
+
+        // claim a free record and publish the hazard in the same CAS
+        int record = -1;
+        for (int k = 0; record < 0; ++k) {
+            int i = (int)((tlsHazardHint + (unsigned int)k) % NUM_HAZARDS);
+            Slot *expected = (Slot *)0;
+            if (hazards[i].compare_exchange_strong(expected, slot)) record = i;
+        }
+
+        // still current: the writer's reclaim scan will now see the hazard before freeing the slot
+        if (current.load() == slot) {
+            std::shared_ptr<const ModelSnapshot> snapshot = slot->snapshot;
+            hazards[record].store((Slot *)0);
+            return snapshot;
+        }
+        hazards[record].store((Slot *)0);
+    }
+}
+
+unsigned long ModelRegistry::publish(std::shared_ptr<ModelSnapshot> snapshot) {
+    std::lock_guard<std::mutex> guard(writerLock);
+    unsigned long version = ++lastVersion;
+    snapshot->version = version;
+    Slot *slot = new Slot;
+    slot->snapshot = snapshot;
+    Slot *previous = current.exchange(slot);
+    if (previous) {
+        retired.push_back(previous->snapshot);
+        retiredSlots.push_back(previous);
+    }
+    reclaim();
+    METRIC_COUNT("snapshot_publish", 1);
+    return version;
+}
+
+void ModelRegistry::reclaim() {
+    size_t keptSlots = 0;
+    for (size_t i = 0; i < retiredSlots.size(); ++i) {
+        bool protectedSlot = false;
+        for (int h = 0; h < NUM_HAZARDS && !protectedSlot; ++h) protectedSlot = hazards[h].load() == retiredSlots[i];
+        if (protectedSlot) retiredSlots[keptSlots++] = retiredSlots[i];
+        else delete retiredSlots[i];   // the snapshot itself is still held by the retired list
+    }
+    retiredSlots.resize(keptSlots);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); ++i) {
+        // use_count() == 1: only this list refers to it, and new readers can no longer reach it
+        if (retired[i].use_count() > 1) retired[kept++] = retired[i];
+    }
+    retired.resize(kept);
+}
+
+unsigned long ModelRegistry::getVersion() const {
+    std::shared_ptr<const ModelSnapshot> s = acquire();
+    return s ? s->version : 0;
+}
+
+size_t ModelRegistry::getRetiredCount() {
+    std::lock_guard<std::mutex> guard(writerLock);
+    reclaim();
+    return retired.size();
+}
+
+bool ModelRegistry::isLockFree() const {
+    return current.is_lock_free() && hazards[0].is_lock_free() && lastVersion.is_lock_free();
+}
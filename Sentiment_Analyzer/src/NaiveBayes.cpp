@@ -1,7 +1,14 @@
 #include "../include/NaiveBayes.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/ThreadPool.hpp"
+#include "../include/FastMath.hpp"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <unordered_map>
 
+// per-thread class score buffer, so predict does not allocate
+static thread_local std::vector<double> scoreScratch;
 
 NaiveBayes::NaiveBayes() {
     classes.clear();
@@ -10,10 +17,14 @@ NaiveBayes::NaiveBayes() {
     wordCountPerClass.clear();
     priorProb.clear();
     condProb.clear();
+    wordIds.clear();
+    logCond.clear();
+    logUnseen.clear();
+    logPrior.clear();
     vocabSize = 0;
 }
 
-bool NaiveBayes::classExists(const std::string &c) {
+bool NaiveBayes::classExists(const std::string &c) const {
     for (size_t i = 0; i < classes.size(); ++i)
         if (classes[i] == c) return true;
     return false;
@@ -23,6 +34,7 @@ bool NaiveBayes::classExists(const std::string &c) {
 void NaiveBayes::trainFromDocuments(const std::vector<std::vector<std::string>> &docs, 
                                     const std::vector<std::string> &labels, 
                                     const std::vector<std::string> &vocab) {
+    METRIC_TIMER("nb_train");
     // reset
     classes.clear();
     classDocCount.clear();
@@ -30,6 +42,10 @@ void NaiveBayes::trainFromDocuments(const std::vector<std::vector<std::string>>
     wordCountPerClass.clear();
     priorProb.clear();
     condProb.clear();
+    wordIds.clear();
+    logCond.clear();
+    logUnseen.clear();
+    logPrior.clear();
     vocabSize = (int)vocab.size();
 
     int N = (int)docs.size();
@@ -74,97 +90,197 @@ void NaiveBayes::trainFromDocuments(const std::vector<std::vector<std::string>>
         }
     }
 
-    // compute priors
+    computeProbabilities(vocab, N);
+}
+
+void NaiveBayes::trainParallel(const std::vector<std::vector<std::string>> &docs,
+                               const std::vector<std::string> &labels,
+                               const std::vector<std::string> &vocab) {
+    METRIC_TIMER("nb_train");
+    trainFromCountTable(NaiveBayesCounts::fromDocuments(docs, labels, vocab));
+}
+
+void NaiveBayes::trainFromCountTable(const NaiveBayesCounts &counts) {
+    classes = counts.getClasses();
+    classDocCount.clear();
+    totalWordsInClass.clear();
+    wordCountPerClass.clear();
+    priorProb.clear();
+    condProb.clear();
+    vocabSize = (int)counts.getVocabulary().size();
+
+    // per-class totals only; the word counts stay in the flat table
+    for (size_t c = 0; c < classes.size(); ++c) {
+        classDocCount[classes[c]] = counts.getDocCount((int)c);
+        totalWordsInClass[classes[c]] = counts.getTokenTotal((int)c);
+    }
+
+    wordIds.clear();
+    logCond.clear();
+    logUnseen.clear();
+    logPrior.clear();
+    if (counts.getDocumentTotal() > 0) computeLogTables(counts);
+}
+
+void NaiveBayes::computeLogTables(const NaiveBayesCounts &counts) {
+    const std::vector<std::string> &vocab = counts.getVocabulary();
+    size_t numClasses = classes.size();
+    double N = (double)counts.getDocumentTotal();
+
+    std::vector<double> denom(numClasses);
+    for (size_t c = 0; c < numClasses; ++c) {
+        priorProb[classes[c]] = (double)counts.getDocCount((int)c) / N;
+        denom[c] = (double)counts.getTokenTotal((int)c) + (double)vocabSize;
+    }
+
+    wordIds.reserve(vocabSize);
+    for (int v = 0; v < vocabSize; ++v) wordIds.insert(std::make_pair(vocab[v], v));
+
+    // P(w|c) = (count+1)/(tokens in c + vocabSize) from each class row, then one batched log per block
+    logCond.assign((size_t)vocabSize * numClasses, 0.0);
+    ThreadPool &pool = ThreadPool::shared();
+    pool.parallelFor(0, (size_t)vocabSize, 1 << 12, [&](size_t v0, size_t v1) {
+        for (size_t c = 0; c < numClasses; ++c) {
+            const int64_t *row = counts.getRow((int)c);
+            for (size_t v = v0; v < v1; ++v) logCond[v * numClasses + c] = ((double)row[v] + 1.0) / denom[c];
+        }
+        FastMath::logArray(&logCond[v0 * numClasses], &logCond[v0 * numClasses], (v1 - v0) * numClasses);
+    });
+
+    logPrior.resize(numClasses);
+    logUnseen.resize(numClasses);
+    for (size_t c = 0; c < numClasses; ++c) {
+        double pC = priorProb[classes[c]];
+        logPrior[c] = pC > 0.0 ? FastMath::log(pC) : -INFINITY;
+        logUnseen[c] = FastMath::log(1.0 / denom[c]);
+    }
+}
+
+void NaiveBayes::computeProbabilities(const std::vector<std::string> &vocab, int64_t N) {
+    // compute priors; create every per-class entry up front so the parallel part only reads the outer maps
+    std::vector<std::map<std::string, double> *> probs(classes.size());
+    std::vector<const std::map<std::string, int> *> wordCounts(classes.size());
+    std::vector<double> denom(classes.size());
     for (size_t i = 0; i < classes.size(); ++i) {
         const std::string &c = classes[i];
         priorProb[c] = (double)classDocCount[c] / (double)N;
+        probs[i] = &condProb[c];
+        probs[i]->clear();
+        wordCounts[i] = &wordCountPerClass[c];
+        denom[i] = (double)totalWordsInClass[c] + (double)vocabSize;
     }
 
+    // vocabulary ids in map order, so each class map is built by appending (end hint)
+    // while walking its word counts in step instead of looking every word up
+    std::vector<int> sorted(vocabSize);
+    for (int v = 0; v < vocabSize; ++v) sorted[v] = v;
+    std::sort(sorted.begin(), sorted.end(), [&](int a, int b) { return vocab[a] < vocab[b]; });
 
-    // compute conditional probabilities P(w|c) with Laplace smoothing
-    for (size_t i = 0; i < classes.size(); ++i) {
-        const std::string &c = classes[i];
-        condProb[c] = std::map<std::string, double>();
-
-        // for all words in vocabulary compute (count+1)/(totalWordsInClass + vocabSize)
-        for (int v = 0; v < vocabSize; ++v) {
-            const std::string &w = vocab[v];
-            int cnt = 0;
-            if (wordCountPerClass[c].find(w) != wordCountPerClass[c].end()) {
-                cnt = wordCountPerClass[c][w];
-            }
-            
-            double prob = ((double)cnt + 1.0) / ((double)totalWordsInClass[c] + (double)vocabSize);
-            condProb[c][w] = prob;
+    size_t numClasses = classes.size();
+    wordIds.clear();
+    for (int v = 0; v < vocabSize; ++v) wordIds.insert(std::make_pair(vocab[v], v));
+    logCond.assign((size_t)vocabSize * numClasses, 0.0);
 
+    // compute conditional probabilities P(w|c) = (count+1)/(totalWordsInClass + vocabSize), one class per task
+    ThreadPool &pool = ThreadPool::shared();
+    pool.parallelFor(0, numClasses, 1, [&](size_t c0, size_t c1) {
+        for (size_t i = c0; i < c1; ++i) {
+            std::map<std::string, double> &out = *probs[i];
+            std::map<std::string, int>::const_iterator cnt = wordCounts[i]->begin(), cntEnd = wordCounts[i]->end();
+            for (int v = 0; v < vocabSize; ++v) {
+                const std::string &w = vocab[sorted[v]];
+                while (cnt != cntEnd && cnt->first < w) ++cnt;
+                int n = (cnt != cntEnd && cnt->first == w) ? cnt->second : 0;
+                double p = ((double)n + 1.0) / denom[i];
+                out.insert(out.end(), std::make_pair(w, p));
+                logCond[(size_t)sorted[v] * numClasses + i] = p;
+            }
         }
+    });
+
+    // probabilities -> log-probabilities, vectorised over the whole table
+    pool.parallelFor(0, logCond.size(), 1 << 14, [&](size_t b0, size_t b1) {
+        FastMath::logArray(&logCond[b0], &logCond[b0], b1 - b0);
+    });
+
+    logPrior.resize(numClasses);
+    logUnseen.resize(numClasses);
+    for (size_t i = 0; i < numClasses; ++i) {
+        double pC = priorProb[classes[i]];
+        logPrior[i] = pC > 0.0 ? FastMath::log(pC) : -INFINITY;
+        logUnseen[i] = FastMath::log(getUnseenConditional(classes[i]));
     }
 }
 
 // Predict using log-probabilities
-std::string NaiveBayes::predict(const std::vector<std::string> &tokens) {
+std::string NaiveBayes::predict(const std::vector<std::string> &tokens) const {
+    int id = predictId(tokens.data(), tokens.size());
+    return id < 0 ? "" : classes[id];
+}
 
-    double bestScore = -INFINITY;
-    std::string bestClass = "";
+int NaiveBayes::predictId(const std::string *tokens, size_t count) const {
+    METRIC_TIMER("nb_predict");
+    size_t numClasses = classes.size();
+    if (numClasses == 0) return -1;
+    if (logPrior.size() != numClasses) return 0;
 
-    for (size_t i = 0; i < classes.size(); ++i) {
-        const std::string &c = classes[i];
-        double score = 0.0;
-        // prior
-        double pC = 1e-12;
-        if (priorProb.find(c) != priorProb.end()) {
-            pC = priorProb[c];
-        }
-        if (pC <= 0.0) {
-            score = -INFINITY;
-        }
-        else {
-            score = std::log(pC);
-        }
+    // prior, then one precomputed row of log P(w|c) per token
+    std::vector<double> &score = scoreScratch;
+    score.assign(logPrior.begin(), logPrior.end());
+    for (size_t t = 0; t < count; ++t) {
+        std::unordered_map<std::string, int>::const_iterator it = wordIds.find(tokens[t]);
+        // word not in vocabulary: Laplace smoothing with count=0
+        const double *row = it == wordIds.end() ? logUnseen.data() : &logCond[(size_t)it->second * numClasses];
+        for (size_t c = 0; c < numClasses; ++c) score[c] += row[c];
+    }
 
-        // add log-likelihoods
-        for (size_t t = 0; t < tokens.size(); ++t) {
-            const std::string &w = tokens[t];
-            double pwc = 0.0;
+    size_t best = 0;
+    for (size_t c = 1; c < numClasses; ++c) {
+        if (score[c] > score[best]) best = c;
+    }
+    return (int)best;
+}
 
-            if (condProb[c].find(w) != condProb[c].end()) {
-                pwc = condProb[c][w];
-            }
-            else {
-                // word not in vocabulary or not seen for this class: Laplace smoothing with count=0
-                double denom = (double)totalWordsInClass[c] + (double)vocabSize;
-
-                if (denom <= 0.0) {
-                    pwc = 1.0 / (double)(vocabSize + 1);
-                }
-                else {
-                    pwc = 1.0 / denom;
-                }
-            }
+BatchPrediction NaiveBayes::predictBatch(const std::vector<std::string> *docs, size_t count) const {
+    METRIC_TIMER("nb_predict_batch");
+    BatchPrediction result;
+    result.resize(count, classes);
+    size_t numClasses = classes.size();
+    if (count == 0 || numClasses == 0) return result;
 
-            if (pwc > 0.0) {
-                score += std::log(pwc);
-            }
-            else {
-                score += -1e9;
-            }
-        }
+    if (logPrior.size() != numClasses) {
+        for (size_t i = 0; i < result.scores.size(); ++i) result.scores[i] = 1.0 / (double)numClasses;
+        result.computeArgmax();
+        return result;
+    }
+
+    for (size_t d = 0; d < count; ++d) {
+        double *score = &result.scores[d * numClasses];
+        for (size_t c = 0; c < numClasses; ++c) score[c] = logPrior[c];
 
-        if (score > bestScore) {
-            bestScore = score;
-            bestClass = c;
+        const std::vector<std::string> &tokens = docs[d];
+        for (size_t t = 0; t < tokens.size(); ++t) {
+            std::unordered_map<std::string, int>::const_iterator it = wordIds.find(tokens[t]);
+            const double *row = it == wordIds.end() ? logUnseen.data() : &logCond[(size_t)it->second * numClasses];
+            for (size_t c = 0; c < numClasses; ++c) score[c] += row[c];
         }
+
+        // normalize log scores into posteriors (max-shifted softmax, all -inf becomes uniform)
+        FastMath::softmax(score, numClasses);
     }
 
-    if (bestClass == "" && classes.size() > 0) bestClass = classes[0];
+    result.computeArgmax();
+    METRIC_COUNT("nb_predict_batch_docs", count);
+    return result;
+}
 
-    
-    return bestClass;
+BatchPrediction NaiveBayes::predictBatch(const std::vector<std::vector<std::string>> &docs) const {
+    return predictBatch(docs.data(), docs.size());
 }
 
 // compute accuracy on dataset
 double NaiveBayes::accuracy(const std::vector<std::vector<std::string>> &docs, 
-                            const std::vector<std::string> &labels) {
+                            const std::vector<std::string> &labels) const {
     int n = (int)docs.size();
     if (n == 0) return 0.0;
     int correct = 0;
@@ -174,3 +290,49 @@ double NaiveBayes::accuracy(const std::vector<std::vector<std::string>> &docs,
     }
     return (double)correct / (double)n;
 }
+
+const std::vector<std::string> &NaiveBayes::getClasses() const {
+    return classes;
+}
+
+double NaiveBayes::getPrior(const std::string &c) const {
+    std::map<std::string, double>::const_iterator it = priorProb.find(c);
+    if (it == priorProb.end()) return 0.0;
+    return it->second;
+}
+
+double NaiveBayes::getConditional(const std::string &c, const std::string &w) const {
+    std::map<std::string, std::map<std::string, double> >::const_iterator cls = condProb.find(c);
+    if (cls != condProb.end()) {
+        std::map<std::string, double>::const_iterator it = cls->second.find(w);
+        if (it != cls->second.end()) return it->second;
+    }
+    else {
+        // trained from a count table: only the log table exists
+        const double *row = getLogConditionalRow(w);
+        size_t id = std::find(classes.begin(), classes.end(), c) - classes.begin();
+        if (row && id < classes.size()) return std::exp(row[id]);
+    }
+    return getUnseenConditional(c);
+}
+
+double NaiveBayes::getUnseenConditional(const std::string &c) const {
+    std::map<std::string, int64_t>::const_iterator total = totalWordsInClass.find(c);
+    double denom = (double)vocabSize + (total == totalWordsInClass.end() ? 0.0 : (double)total->second);
+    if (denom <= 0.0) return 1.0 / (double)(vocabSize + 1);
+    return 1.0 / denom;
+}
+
+const double *NaiveBayes::getLogConditionalRow(const std::string &w) const {
+    std::unordered_map<std::string, int>::const_iterator it = wordIds.find(w);
+    if (it == wordIds.end()) return nullptr;
+    return &logCond[(size_t)it->second * classes.size()];
+}
+
+const std::vector<double> &NaiveBayes::getLogUnseen() const {
+    return logUnseen;
+}
+
+const std::vector<double> &NaiveBayes::getLogPrior() const {
+    return logPrior;
+}
@@ -0,0 +1,256 @@
+#include "../include/NaiveBayesCounts.hpp"
+#include "../include/ThreadPool.hpp"
+#include "../include/Metrics.hpp"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+static const char COUNTS_MAGIC[8] = { 'E', 'M', 'O', 'N', 'B', 'C', '0', '1' };
+
+NaiveBayesCounts::NaiveBayesCounts() {
+}
+
+NaiveBayesCounts::NaiveBayesCounts(const std::vector<std::string> &classList, const std::vector<std::string> &words) {
+    grow(classList, words);
+}
+
+void NaiveBayesCounts::grow(const std::vector<std::string> &moreClasses, const std::vector<std::string> &moreWords) {
+    size_t oldC = classes.size(), oldV = vocab.size();
+    for (size_t i = 0; i < moreClasses.size(); ++i) {
+        if (classIndex.insert(std::make_pair(moreClasses[i], (int)classes.size())).second) {
+            classes.push_back(moreClasses[i]);
+        }
+    }
+    for (size_t i = 0; i < moreWords.size(); ++i) {
+        if (wordIndex.insert(std::make_pair(moreWords[i], (int)vocab.size())).second) {
+            vocab.push_back(moreWords[i]);
+        }
+    }
+    size_t C = classes.size(), V = vocab.size();
+    if (C == oldC && V == oldV) return;
+
+    docCounts.resize(C, 0);
+    tokenTotals.resize(C, 0);
+    if (V == oldV) {
+        counts.resize(C * V, 0);
+        return;
+    }
+    // the row width changed: re-lay the table
+    std::vector<int64_t> wider(C * V, 0);
+    for (size_t c = 0; c < oldC; ++c) {
+        std::copy(counts.begin() + c * oldV, counts.begin() + (c + 1) * oldV, wider.begin() + c * V);
+    }
+    counts.swap(wider);
+}
+
+NaiveBayesCounts NaiveBayesCounts::fromDocuments(const std::vector<std::vector<std::string>> &docs,
+                                                 const std::vector<std::string> &labels,
+                                                 const std::vector<std::string> &vocab) {
+    METRIC_TIMER("nb_count_shards");
+    std::vector<std::string> classList;
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (std::find(classList.begin(), classList.end(), labels[i]) == classList.end()) classList.push_back(labels[i]);
+    }
+
+    // every shard shares the layout of this template; lookups go to its (read-only) indexes
+    NaiveBayesCounts layout(classList, vocab);
+    ThreadPool &pool = ThreadPool::shared();
+    size_t n = docs.size();
+    size_t numShards = std::max<size_t>(1, std::min<size_t>((size_t)pool.size(), n));
+    std::vector<NaiveBayesCounts> shards(numShards);
+
+    pool.parallelFor(0, numShards, 1, [&](size_t s0, size_t s1) {
+        std::vector<int> ids;
+        for (size_t s = s0; s < s1; ++s) {
+            NaiveBayesCounts &shard = shards[s];
+            shard = layout;
+            size_t begin = n * s / numShards, end = n * (s + 1) / numShards;
+            for (size_t i = begin; i < end; ++i) {
+                const std::vector<std::string> &tokens = docs[i];
+                ids.resize(tokens.size());
+                for (size_t t = 0; t < tokens.size(); ++t) {
+                    std::unordered_map<std::string, int>::const_iterator it = layout.wordIndex.find(tokens[t]);
+                    ids[t] = it == layout.wordIndex.end() ? -1 : it->second;
+                }
+                shard.addDocument(layout.classIndex.find(labels[i])->second, ids.data(), ids.size());
+            }
+        }
+    });
+
+    return reduce(shards);
+}
+
+void NaiveBayesCounts::addDocument(int classId, const int *wordIds, size_t count) {
+    docCounts[classId]++;
+    tokenTotals[classId] += (int64_t)count;
+    int64_t *row = &counts[(size_t)classId * vocab.size()];
+    for (size_t t = 0; t < count; ++t) {
+        if (wordIds[t] >= 0) row[wordIds[t]]++;
+    }
+}
+
+void NaiveBayesCounts::addClassCounts(int classId, int64_t documents, const int64_t *wordCounts, size_t width) {
+    docCounts[classId] += documents;
+    int64_t *row = &counts[(size_t)classId * vocab.size()];
+    size_t n = std::min(width, vocab.size());
+    for (size_t v = 0; v < n; ++v) {
+        row[v] += wordCounts[v];
+        tokenTotals[classId] += wordCounts[v];
+    }
+}
+
+void NaiveBayesCounts::merge(const NaiveBayesCounts &other) {
+    if (classes == other.classes && vocab == other.vocab) {
+        for (size_t c = 0; c < classes.size(); ++c) {
+            docCounts[c] += other.docCounts[c];
+            tokenTotals[c] += other.tokenTotals[c];
+        }
+        for (size_t k = 0; k < counts.size(); ++k) counts[k] += other.counts[k];
+        return;
+    }
+
+    // different layouts: add the other table's names, then add through an id map
+    grow(other.classes, other.vocab);
+    size_t V = vocab.size(), otherV = other.vocab.size();
+    std::vector<int> wordMap(otherV);
+    for (size_t v = 0; v < otherV; ++v) wordMap[v] = wordIndex.find(other.vocab[v])->second;
+
+    for (size_t oc = 0; oc < other.classes.size(); ++oc) {
+        int c = classIndex.find(other.classes[oc])->second;
+        docCounts[c] += other.docCounts[oc];
+        tokenTotals[c] += other.tokenTotals[oc];
+        int64_t *row = &counts[(size_t)c * V];
+        const int64_t *src = &other.counts[oc * otherV];
+        for (size_t v = 0; v < otherV; ++v) row[wordMap[v]] += src[v];
+    }
+}
+
+NaiveBayesCounts NaiveBayesCounts::reduce(std::vector<NaiveBayesCounts> &shards) {
+    METRIC_TIMER("nb_count_reduce");
+    if (shards.empty()) return NaiveBayesCounts();
+
+    // round r merges shard i + 2^r into shard i for every i that is a multiple of 2^(r+1)
+    ThreadPool &pool = ThreadPool::shared();
+    for (size_t step = 1; step < shards.size(); step *= 2) {
+        size_t pairs = (shards.size() + 2 * step - 1) / (2 * step);
+        pool.parallelFor(0, pairs, 1, [&](size_t p0, size_t p1) {
+            for (size_t p = p0; p < p1; ++p) {
+                size_t left = p * 2 * step, right = left + step;
+                if (right < shards.size()) {
+                    shards[left].merge(shards[right]);
+                    shards[right] = NaiveBayesCounts();
+                }
+            }
+        });
+    }
+    NaiveBayesCounts total;
+    std::swap(total, shards[0]);
+    return total;
+}
+
+// Helper: length-prefixed string list
+static void writeStrings(std::ofstream &out, const std::vector<std::string> &strings) {
+    uint64_t n = strings.size();
+    out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    for (size_t i = 0; i < strings.size(); ++i) {
+        uint32_t len = (uint32_t)strings[i].size();
+        out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+        out.write(strings[i].data(), len);
+    }
+}
+
+static bool readStrings(std::ifstream &in, uint64_t fileSize, std::vector<std::string> &strings) {
+    uint64_t n = 0;
+    if (!in.read(reinterpret_cast<char *>(&n), sizeof(n))) return false;
+    // checked against the bytes left before anything is allocated; every string costs at least its prefix
+    if (n > (fileSize - (uint64_t)in.tellg()) / sizeof(uint32_t)) return false;
+    strings.clear();
+    for (uint64_t i = 0; i < n; ++i) {
+        uint32_t len = 0;
+        if (!in.read(reinterpret_cast<char *>(&len), sizeof(len))) return false;
+        if (len > fileSize - (uint64_t)in.tellg()) return false;
+        std::string s(len, '\0');
+        if (len > 0 && !in.read(&s[0], len)) return false;
+        strings.push_back(s);
+    }
+    return true;
+}
+
+bool NaiveBayesCounts::save(const std::string &path) const {
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    out.write(COUNTS_MAGIC, sizeof(COUNTS_MAGIC));
+    writeStrings(out, classes);
+    writeStrings(out, vocab);
+    if (!classes.empty()) {
+        out.write(reinterpret_cast<const char *>(&docCounts[0]), docCounts.size() * sizeof(int64_t));
+        out.write(reinterpret_cast<const char *>(&tokenTotals[0]), tokenTotals.size() * sizeof(int64_t));
+    }
+    if (!counts.empty()) {
+        out.write(reinterpret_cast<const char *>(&counts[0]), counts.size() * sizeof(int64_t));
+    }
+    out.close();
+    if (!out) return false;
+
+    std::remove(path.c_str());
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+bool NaiveBayesCounts::load(const std::string &path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in.is_open()) return false;
+
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = (uint64_t)in.tellg();
+    in.seekg(0, std::ios::beg);
+
+    char magic[8];
+    std::vector<std::string> classList, words;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, COUNTS_MAGIC, sizeof(magic)) != 0) return false;
+    if (!readStrings(in, fileSize, classList) || !readStrings(in, fileSize, words)) return false;
+    // the count tables must fit in what is left before they are allocated
+    uint64_t cells = (uint64_t)classList.size() * (2 + (uint64_t)words.size());
+    if (cells > (fileSize - (uint64_t)in.tellg()) / sizeof(int64_t)) return false;
+
+    NaiveBayesCounts loaded(classList, words);
+    // duplicate names would make the table smaller than the file's
+    if (loaded.classes.size() != classList.size() || loaded.vocab.size() != words.size()) return false;
+    if (!classList.empty()) {
+        if (!in.read(reinterpret_cast<char *>(&loaded.docCounts[0]), loaded.docCounts.size() * sizeof(int64_t))) return false;
+        if (!in.read(reinterpret_cast<char *>(&loaded.tokenTotals[0]), loaded.tokenTotals.size() * sizeof(int64_t))) return false;
+    }
+    if (!loaded.counts.empty()) {
+        if (!in.read(reinterpret_cast<char *>(&loaded.counts[0]), loaded.counts.size() * sizeof(int64_t))) return false;
+    }
+    std::swap(*this, loaded);
+    return true;
+}
+
+const std::vector<std::string> &NaiveBayesCounts::getClasses() const {
+    return classes;
+}
+
+const std::vector<std::string> &NaiveBayesCounts::getVocabulary() const {
+    return vocab;
+}
+
+int64_t NaiveBayesCounts::getDocCount(int classId) const {
+    return docCounts[classId];
+}
+
+int64_t NaiveBayesCounts::getTokenTotal(int classId) const {
+    return tokenTotals[classId];
+}
+
+const int64_t *NaiveBayesCounts::getRow(int classId) const {
+    return vocab.empty() ? 0 : &counts[(size_t)classId * vocab.size()];
+}
+
+int64_t NaiveBayesCounts::getDocumentTotal() const {
+    int64_t total = 0;
+    for (size_t c = 0; c < docCounts.size(); ++c) total += docCounts[c];
+    return total;
+}
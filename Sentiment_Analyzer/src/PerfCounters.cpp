@@ -0,0 +1,91 @@
+#include "../include/PerfCounters.hpp"
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERFCOUNTERS_LINUX 1
+#endif
+
+#ifdef PERFCOUNTERS_LINUX
+// Helper: open one disabled user-space counter for this thread, -1 if refused
+static int openEvent(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int e = 0; e < NUM_EVENTS; ++e) {
+        fds[e] = -1;
+        values[e] = 0;
+    }
+#ifdef PERFCOUNTERS_LINUX
+    fds[L1D_READ_MISSES] = openEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                     (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    fds[LLC_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds[INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef PERFCOUNTERS_LINUX
+    for (int e = 0; e < NUM_EVENTS; ++e) {
+        if (fds[e] >= 0) close(fds[e]);
+    }
+#endif
+}
+
+bool PerfCounters::available(Event e) const {
+    return fds[e] >= 0;
+}
+
+bool PerfCounters::anyAvailable() const {
+    for (int e = 0; e < NUM_EVENTS; ++e) {
+        if (fds[e] >= 0) return true;
+    }
+    return false;
+}
+
+void PerfCounters::start() {
+#ifdef PERFCOUNTERS_LINUX
+    for (int e = 0; e < NUM_EVENTS; ++e) {
+        if (fds[e] < 0) continue;
+        ioctl(fds[e], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef PERFCOUNTERS_LINUX
+    for (int e = 0; e < NUM_EVENTS; ++e) {
+        if (fds[e] < 0) continue;
+        ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        values[e] = read(fds[e], &count, sizeof(count)) == (ssize_t)sizeof(count) ? count : 0;
+    }
+#endif
+}
+
+uint64_t PerfCounters::value(Event e) const {
+    return values[e];
+}
+
+const char *PerfCounters::eventName(Event e) {
+    switch (e) {
+        case L1D_READ_MISSES: return "L1D read misses";
+        case LLC_MISSES: return "LLC misses";
+        case INSTRUCTIONS: return "instructions";
+        default: return "?";
+    }
+}
@@ -0,0 +1,112 @@
+#include "../include/PostingList.hpp"
+#include <algorithm>
+#include <cmath>
+
+PostingList::PostingList() : length(0), maxWeight(0.0f) {
+}
+
+void PostingList::writeVarint(std::vector<uint8_t> &out, uint32_t value) {
+    while (value >= 0x80u) {
+        out.push_back((uint8_t)(value | 0x80u));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+uint32_t PostingList::readVarint(const uint8_t *&p) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (*p & 0x80u) {
+        value |= (uint32_t)(*p++ & 0x7fu) << shift;
+        shift += 7;
+    }
+    value |= (uint32_t)(*p++) << shift;
+    return value;
+}
+
+void PostingList::build(const std::vector<int> &ids, const std::vector<float> &weights) {
+    bytes.clear();
+    skips.clear();
+    length = std::min(ids.size(), weights.size());
+    maxWeight = 0.0f;
+    for (size_t i = 0; i < length; ++i) {
+        if (weights[i] > maxWeight) maxWeight = weights[i];
+    }
+
+    int prev = 0;
+    for (size_t b0 = 0; b0 < length; b0 += BLOCK_SIZE) {
+        size_t b1 = std::min(length, b0 + BLOCK_SIZE);
+        Skip s;
+        s.offset = (uint32_t)bytes.size();
+        s.lastId = ids[b1 - 1];
+        skips.push_back(s);
+
+        // ids: first one relative to the previous block's last id, then gaps
+        for (size_t i = b0; i < b1; ++i) {
+            writeVarint(bytes, (uint32_t)(ids[i] - prev));
+            prev = ids[i];
+        }
+
+        // weights: 16-bit fraction of the list maximum, little endian
+        for (size_t i = b0; i < b1; ++i) {
+            float w = weights[i] < 0.0f ? 0.0f : weights[i];
+            long q = maxWeight > 0.0f ? std::lround(w / maxWeight * 65535.0f) : 0;
+            if (q > 65535) q = 65535;
+            bytes.push_back((uint8_t)(q & 0xff));
+            bytes.push_back((uint8_t)(q >> 8));
+        }
+    }
+}
+
+size_t PostingList::sizeBytes() const {
+    return bytes.size() + skips.size() * sizeof(Skip);
+}
+
+// ---------------------------------------------------------------------------
+// Cursor
+// ---------------------------------------------------------------------------
+
+PostingList::Cursor::Cursor() : list(0), block(0), pos(0), blockLen(0) {
+}
+
+PostingList::Cursor::Cursor(const PostingList &l) : list(&l), block(0), pos(0), blockLen(0) {
+    if (!l.skips.empty()) loadBlock(0);
+}
+
+void PostingList::Cursor::loadBlock(size_t b) {
+    block = b;
+    pos = 0;
+    if (b >= list->skips.size()) return;
+
+    size_t first = b * BLOCK_SIZE;
+    blockLen = std::min((size_t)BLOCK_SIZE, list->length - first);
+    const uint8_t *p = &list->bytes[list->skips[b].offset];
+
+    int prev = b > 0 ? list->skips[b - 1].lastId : 0;
+    for (size_t i = 0; i < blockLen; ++i) {
+        prev += (int)readVarint(p);
+        ids[i] = prev;
+    }
+    float unit = list->maxWeight / 65535.0f;
+    for (size_t i = 0; i < blockLen; ++i) {
+        weights[i] = (float)(p[0] | (p[1] << 8)) * unit;
+        p += 2;
+    }
+}
+
+void PostingList::Cursor::next() {
+    if (++pos >= blockLen) loadBlock(block + 1);
+}
+
+void PostingList::Cursor::advance(int target) {
+    if (done() || ids[pos] >= target) return;
+
+    // skip whole blocks whose last id is below the target
+    if (list->skips[block].lastId < target) {
+        size_t b = block + 1;
+        while (b < list->skips.size() && list->skips[b].lastId < target) b++;
+        loadBlock(b);
+        if (done()) return;
+    }
+    while (ids[pos] < target) pos++;
+}
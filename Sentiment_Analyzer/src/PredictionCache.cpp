@@ -0,0 +1,182 @@
+#include "../include/PredictionCache.hpp"
+#include "../include/Metrics.hpp"
+#include <algorithm>
+
+// Helper: splitmix64 finaliser
+static inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+// text and token keys share the table, so each is salted differently
+static const uint64_t TEXT_KEY_SALT = 0x243f6a8885a308d3ULL;
+static const uint64_t TOKEN_KEY_SALT = 0x13198a2e03707344ULL;
+
+// Helper: smallest power of two >= n
+static size_t roundUpPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+PredictionCache::PredictionCache(size_t capacity, size_t numShards)
+    : shards(roundUpPowerOfTwo(numShards)), shardMask(shards.size() - 1) {
+    size_t n = shards.size();
+    size_t perShard = std::max<size_t>(1, (capacity + n - 1) / n);
+    for (size_t s = 0; s < n; ++s) {
+        shards[s].slots.resize(perShard);
+        shards[s].index.reserve(perShard);
+    }
+}
+
+PredictionCache::Shard &PredictionCache::shardFor(uint64_t key) {
+    // the index hashes the low bits, so the shard comes from the high ones
+    return shards[(size_t)(key >> 40) & shardMask];
+}
+
+uint64_t PredictionCache::tokenKey(const Vectorizer &vec, const std::vector<std::string> &tokens) {
+    return tokenKey(vec, tokens.data(), tokens.size());
+}
+
+uint64_t PredictionCache::tokenKey(const Vectorizer &vec, const std::string *tokens, size_t count) {
+    uint64_t h = TOKEN_KEY_SALT;
+    for (size_t t = 0; t < count; ++t) {
+        int id = vec.getWordId(tokens[t]);
+        uint64_t part;
+        if (id >= 0) {
+            part = (uint64_t)id;
+        }
+        else {
+            // out-of-vocabulary words still reach NB (count 0) and the hashed LR, so keep them distinct
+            part = 14695981039346656037ULL;
+            for (size_t i = 0; i < tokens[t].size(); ++i) {
+                part ^= (unsigned char)tokens[t][i];
+                part *= 1099511628211ULL;
+            }
+            part |= 0x8000000000000000ULL;
+        }
+        h = mix64(h ^ part) + t;
+    }
+    return mix64(h ^ count);
+}
+
+bool PredictionCache::lookup(uint64_t key, unsigned long version, ModelSnapshot::Predictions &out, bool textKey) {
+    Shard &shard = shardFor(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    std::unordered_map<uint64_t, size_t>::const_iterator it = shard.index.find(key);
+    bool stale = it != shard.index.end() && shard.slots[it->second].version != version;
+    if (it == shard.index.end() || stale) {
+        if (stale) shard.stats.staleEntries++;
+        // the token key is the last chance, so its failure is the request's miss
+        if (!textKey) shard.stats.misses++;
+        return false;
+    }
+    Slot &slot = shard.slots[it->second];
+    slot.referenced = true;
+    out = slot.value;
+    if (textKey) shard.stats.textHits++;
+    else shard.stats.tokenHits++;
+    return true;
+}
+
+void PredictionCache::insert(uint64_t key, unsigned long version, const ModelSnapshot::Predictions &value) {
+    Shard &shard = shardFor(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+
+    std::unordered_map<uint64_t, size_t>::const_iterator it = shard.index.find(key);
+    size_t victim;
+    if (it != shard.index.end()) {
+        victim = it->second;   // same key, e.g. a stale entry: overwrite in place
+    }
+    else {
+        // CLOCK: skip (and clear) referenced slots until an unreferenced one comes round
+        while (true) {
+            Slot &candidate = shard.slots[shard.hand];
+            if (!candidate.used || !candidate.referenced) break;
+            candidate.referenced = false;
+            shard.hand = (shard.hand + 1) % shard.slots.size();
+        }
+        victim = shard.hand;
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+        Slot &old = shard.slots[victim];
+        if (old.used) {
+            shard.index.erase(old.key);
+            shard.stats.evictions++;
+            METRIC_COUNT("prediction_cache_evictions", 1);
+        }
+        shard.index[key] = victim;
+    }
+
+    Slot &slot = shard.slots[victim];
+    slot.key = key;
+    slot.version = version;
+    slot.used = true;
+    slot.referenced = false;
+    slot.value = value;
+}
+
+bool PredictionCache::predict(const ModelSnapshot &models, const std::string &text, ModelSnapshot::Predictions &out) {
+    METRIC_TIMER("prediction_cache_predict");
+    uint64_t textKey = mix64(models.pre.normalizedHash(text) ^ TEXT_KEY_SALT);
+    if (lookup(textKey, models.version, out, true)) {
+        METRIC_COUNT("prediction_cache_hits", 1);
+        return true;
+    }
+
+    // tokens and feature vectors live in the thread's scratch context
+    ScratchContext &ctx = ScratchContext::local();
+    size_t count = models.pre.processInto(text, ctx);
+    if (count == 0) return false;
+
+    uint64_t key = tokenKey(models.vec, ctx.tokens.data(), count);
+    if (lookup(key, models.version, out, false)) {
+        METRIC_COUNT("prediction_cache_hits", 1);
+        insert(textKey, models.version, out);
+        return true;
+    }
+
+    models.predictTokens(ctx.tokens.data(), count, ctx, out);
+    METRIC_COUNT("prediction_cache_misses", 1);
+    insert(key, models.version, out);
+    insert(textKey, models.version, out);
+    return true;
+}
+
+void PredictionCache::invalidate() {
+    for (size_t s = 0; s < shards.size(); ++s) {
+        std::lock_guard<std::mutex> guard(shards[s].lock);
+        for (size_t i = 0; i < shards[s].slots.size(); ++i) shards[s].slots[i] = Slot();
+        shards[s].index.clear();
+        shards[s].hand = 0;
+    }
+    std::lock_guard<std::mutex> guard(shards[0].lock);
+    shards[0].stats.invalidations++;
+    METRIC_COUNT("prediction_cache_invalidations", 1);
+}
+
+PredictionCache::Stats PredictionCache::getStats() {
+    Stats total;
+    for (size_t s = 0; s < shards.size(); ++s) {
+        std::lock_guard<std::mutex> guard(shards[s].lock);
+        const Stats &part = shards[s].stats;
+        total.textHits += part.textHits;
+        total.tokenHits += part.tokenHits;
+        total.misses += part.misses;
+        total.staleEntries += part.staleEntries;
+        total.evictions += part.evictions;
+        total.invalidations += part.invalidations;
+        total.entries += shards[s].index.size();
+        total.capacity += shards[s].slots.size();
+    }
+    return total;
+}
+
+void PredictionCache::resetStats() {
+    for (size_t s = 0; s < shards.size(); ++s) {
+        std::lock_guard<std::mutex> guard(shards[s].lock);
+        shards[s].stats = Stats();
+    }
+}
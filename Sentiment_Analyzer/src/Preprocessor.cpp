@@ -1,19 +1,21 @@
 #include "../include/Preprocessor.hpp"
+#include "../include/Metrics.hpp"
 #include <fstream>
 #include <iostream>
 
 
 Preprocessor::Preprocessor() {
     stopwords.clear();
+    for (int c = 0; c < 256; ++c) separator[c] = is_space((char)c) || is_punct((char)c);
 }
 
 // Basic character helpers (manual)
-bool Preprocessor::is_space(char c) {
+bool Preprocessor::is_space(char c) const {
 
     return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
-bool Preprocessor::is_punct(char c) {
+bool Preprocessor::is_punct(char c) const {
     // treat common punctuation as punctuation
     const char *punc = ".,!?;:'\"()[]{}<>-_/\\@#$%^&*+=|`~";
     for (int i = 0; punc[i] != '\0'; ++i) {
@@ -22,13 +24,13 @@ bool Preprocessor::is_punct(char c) {
     return false;
 }
 
-char Preprocessor::to_lower_char(char c) {
+char Preprocessor::to_lower_char(char c) const {
     
     if (c >= 'A' && c <= 'Z') return c - 'A' + 'a';
     return c;
 }
 
-bool Preprocessor::equals_ignore_case(const std::string &a, const std::string &b) {
+bool Preprocessor::equals_ignore_case(const std::string &a, const std::string &b) const {
     if (a.size() != b.size()) {
         return false;
     }
@@ -41,7 +43,7 @@ bool Preprocessor::equals_ignore_case(const std::string &a, const std::string &b
     return true;
 }
 
-bool Preprocessor::is_stopword(const std::string &w) {
+bool Preprocessor::is_stopword(const std::string &w) const {
 
     for (size_t i = 0; i < stopwords.size(); ++i) {
         if (equals_ignore_case(w, stopwords[i])) return true;
@@ -50,17 +52,21 @@ bool Preprocessor::is_stopword(const std::string &w) {
     return false;
 }
 
-bool Preprocessor::is_negation_word(const std::string &w) {
+bool Preprocessor::is_negation_word(const std::string &w) const {
+    return is_negation_range(w.data(), w.size());
+}
+
+bool Preprocessor::is_negation_range(const char *w, size_t n) const {
 
-    if (equals_ignore_case(w, "not")) return true;
-    if (equals_ignore_case(w, "no")) return true;
-    if (equals_ignore_case(w, "never")) return true;
-    if (equals_ignore_case(w, "isn't")) return true;
-    if (equals_ignore_case(w, "isnt")) return true;
-    if (equals_ignore_case(w, "can't")) return true;
-    if (equals_ignore_case(w, "cant")) return true;
-    if (equals_ignore_case(w, "don't")) return true;
-    if (equals_ignore_case(w, "dont")) return true;
+    static const char *const negations[] = { "not", "no", "never", "isn't", "isnt", "can't", "cant", "don't", "dont" };
+
+    for (size_t k = 0; k < sizeof(negations) / sizeof(negations[0]); ++k) {
+        const char *neg = negations[k];
+        size_t i = 0;
+        // negation words are lowercase, so only the input side needs folding
+        while (i < n && neg[i] != '\0' && to_lower_char(w[i]) == neg[i]) i++;
+        if (i == n && neg[i] == '\0') return true;
+    }
 
     return false;
 }
@@ -94,36 +100,36 @@ void Preprocessor::loadStopWords(const std::string &filePath) {
 }
 
 
-// Main process: remove punctuation, lowercase, split on spaces, remove stopwords
-std::vector<std::string> Preprocessor::process(const std::string &text) {
-    std::vector<std::string> tokens;
-    std::string word = "";
+// Tokenizer core shared by process() and processInto(); emit(token) is called per kept token
+template <class Emit>
+void Preprocessor::tokenize(const std::string &text, std::string &word, std::string &neg, Emit &emit) const {
+    word.clear();
     bool negateNext = false;
 
-    for (size_t i = 0; i < text.size(); ++i) {
+    for (size_t i = 0; i <= text.size(); ++i) {
 
-        char c = text[i];
-        c = to_lower_char(c);
+        // a virtual trailing space flushes the last word
+        char c = i < text.size() ? to_lower_char(text[i]) : ' ';
 
         if (is_punct(c) || is_space(c)) {
             if (!word.empty()) {
                 
                 if (negateNext) {
-                    std::string neg = "NOT_";
+                    neg = "NOT_";
                     neg += word;
                     if (!is_stopword(neg)){
-                        tokens.push_back(neg);
+                        emit(neg);
                     }
                     negateNext = false;
                 } 
-                else if (is_negation_word(word)) {
+                else if (is_negation_word(word) && i < text.size()) {
                     // set flag, do not output the negation token itself
                     negateNext = true;
                 } 
                 else {
 
                     if (!is_stopword(word)){
-                        tokens.push_back(word);
+                        emit(word);
                     }
                         
                 }
@@ -138,23 +144,82 @@ std::vector<std::string> Preprocessor::process(const std::string &text) {
         }
 
     }
+}
 
-    // last word
-    if (!word.empty()) {
-        if (negateNext) {
-            std::string neg = "NOT_";
-            neg += word;
-            if (!is_stopword(neg)){
-                tokens.push_back(neg);
-            } 
-        }
-        else {
-            if (!is_stopword(word)){
-                tokens.push_back(word);
+// Main process: remove punctuation, lowercase, split on spaces, remove stopwords
+std::vector<std::string> Preprocessor::process(const std::string &text) const {
+    METRIC_TIMER("tokenize");
+    std::vector<std::string> tokens;
+    std::string word, neg;
+
+    struct PushBack {
+        std::vector<std::string> &out;
+        void operator()(const std::string &t) { out.push_back(t); }
+    } emit = { tokens };
+    tokenize(text, word, neg, emit);
+
+    METRIC_COUNT("tokenize_documents", 1);
+    METRIC_COUNT("tokenize_tokens", tokens.size());
+    return tokens;
+}
+
+// Same tokenization into the reusable slots of a scratch context
+size_t Preprocessor::processInto(const std::string &text, ScratchContext &ctx) const {
+    METRIC_TIMER("tokenize");
+    ctx.beginDocument();
+
+    struct AssignSlot {
+        ScratchContext &ctx;
+        void operator()(const std::string &t) { ctx.nextToken().assign(t); }
+    } emit = { ctx };
+    tokenize(text, ctx.word, ctx.negated, emit);
+
+    METRIC_COUNT("tokenize_documents", 1);
+    METRIC_COUNT("tokenize_tokens", ctx.tokenCount);
+    return ctx.tokenCount;
+}
+
+uint64_t Preprocessor::normalizedHash(const std::string &text) const {
+    // FNV-1a over lowercased word bytes, one marker byte per word boundary
+    uint64_t h = 14695981039346656037ULL;
+    bool inWord = false;
+    size_t lastWordStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = (unsigned char)text[i];
+        if (separator[c]) {
+            if (inWord) {
+                h ^= 0x1f;
+                h *= 1099511628211ULL;
+                inWord = false;
             }
-                
+            continue;
         }
+        if (!inWord) lastWordStart = i;
+        inWord = true;
+        h ^= (unsigned char)to_lower_char((char)c);
+        h *= 1099511628211ULL;
     }
 
-    return tokens;
+    if (inWord) {
+        // like the tokenizer's virtual trailing space; but a negation word right at the end is
+        // kept as a token, while followed by a separator it is dropped
+        h ^= 0x1f;
+        h *= 1099511628211ULL;
+        if (is_negation_range(text.data() + lastWordStart, text.size() - lastWordStart)) h ^= 0x5bd1e995ULL;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Identifies everything that changes process() output; bump the version when the rules change
+std::string Preprocessor::getConfigSignature() const {
+    std::string sig = "preprocess-v1;negation=NOT_;stopwords=";
+    for (size_t i = 0; i < stopwords.size(); ++i) {
+        sig += stopwords[i];
+        sig += '\n';
+    }
+    return sig;
 }
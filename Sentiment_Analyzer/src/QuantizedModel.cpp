@@ -0,0 +1,293 @@
+#include "../include/QuantizedModel.hpp"
+#include "../include/Metrics.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// ---------------------------------------------------------------------------
+// Float16
+// ---------------------------------------------------------------------------
+
+uint16_t Float16::fromFloat(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000u);
+    int32_t exponent = (int32_t)((x >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = x & 0x7fffffu;
+
+    if (((x >> 23) & 0xffu) == 0xffu) {
+        // inf / nan
+        return (uint16_t)(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+    }
+    if (exponent >= 31) {
+        return (uint16_t)(sign | 0x7c00u);   // overflow to inf
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) return sign;     // underflow to zero
+        // subnormal: shift in the implicit leading bit and round to nearest
+        mantissa |= 0x800000u;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u) half++;
+        return (uint16_t)(sign | half);
+    }
+
+    uint16_t h = (uint16_t)(sign | ((uint32_t)exponent << 10) | (mantissa >> 13));
+    if (mantissa & 0x1000u) h++;   // round to nearest (carry may bump the exponent, which is correct)
+    return h;
+}
+
+float Float16::toFloat(uint16_t h) {
+    uint32_t sign = ((uint32_t)h & 0x8000u) << 16;
+    uint32_t exponent = ((uint32_t)h >> 10) & 0x1fu;
+    uint32_t mantissa = (uint32_t)h & 0x3ffu;
+    uint32_t x;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            x = sign;
+        }
+        else {
+            // normalize the subnormal
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400u) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            mantissa &= 0x3ffu;
+            x = sign | (exponent << 23) | (mantissa << 13);
+        }
+    }
+    else if (exponent == 31) {
+        x = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else {
+        x = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+// ---------------------------------------------------------------------------
+// QuantizedLogisticRegression
+// ---------------------------------------------------------------------------
+
+QuantizedLogisticRegression::QuantizedLogisticRegression()
+    : precision(QUANT_INT8), numFeatures(0), numClasses(0) {
+}
+
+void QuantizedLogisticRegression::quantize(const LogisticRegression &model, QuantPrecision p) {
+    precision = p;
+    classes = model.getClasses();
+    numClasses = (int)classes.size();
+    numFeatures = numClasses > 0 ? (int)model.getWeights(classes[0]).size() : 0;
+
+    weightsInt8.clear();
+    weightsHalf.clear();
+    scale.assign(numClasses, 1.0f);
+    bias.assign(numClasses, 0.0f);
+
+    if (precision == QUANT_INT8) weightsInt8.assign((size_t)numFeatures * numClasses, 0);
+    else weightsHalf.assign((size_t)numFeatures * numClasses, 0);
+
+    for (int c = 0; c < numClasses; ++c) {
+        const std::vector<double> &w = model.getWeights(classes[c]);
+        bias[c] = (float)model.getBias(classes[c]);
+
+        if (precision == QUANT_INT8) {
+            // symmetric per-class scale so that max |w| maps to 127
+            double maxAbs = 0.0;
+            for (int f = 0; f < numFeatures; ++f) {
+                if (std::fabs(w[f]) > maxAbs) maxAbs = std::fabs(w[f]);
+            }
+            double s = maxAbs > 0.0 ? maxAbs / 127.0 : 1.0;
+            scale[c] = (float)s;
+
+            for (int f = 0; f < numFeatures; ++f) {
+                long q = std::lround(w[f] / s);
+                if (q > 127) q = 127;
+                if (q < -127) q = -127;
+                weightsInt8[(size_t)f * numClasses + c] = (int8_t)q;
+            }
+        }
+        else {
+            for (int f = 0; f < numFeatures; ++f) {
+                weightsHalf[(size_t)f * numClasses + c] = Float16::fromFloat((float)w[f]);
+            }
+        }
+    }
+}
+
+void QuantizedLogisticRegression::scores(const SparseVector &vector, std::vector<float> &out) const {
+    out.assign(numClasses, 0.0f);
+    size_t nnz = vector.nnz();
+
+    if (precision == QUANT_INT8) {
+        std::vector<int32_t> acc(numClasses, 0);
+        for (size_t k = 0; k < nnz; ++k) {
+            int f = vector.indices[k];
+            if (f < 0 || f >= numFeatures) continue;
+            int32_t count = (int32_t)vector.values[k];
+            const int8_t *row = &weightsInt8[(size_t)f * numClasses];
+            for (int c = 0; c < numClasses; ++c) acc[c] += (int32_t)row[c] * count;
+        }
+        for (int c = 0; c < numClasses; ++c) out[c] = bias[c] + scale[c] * (float)acc[c];
+    }
+    else {
+        for (int c = 0; c < numClasses; ++c) out[c] = bias[c];
+        for (size_t k = 0; k < nnz; ++k) {
+            int f = vector.indices[k];
+            if (f < 0 || f >= numFeatures) continue;
+            float v = (float)vector.values[k];
+            const uint16_t *row = &weightsHalf[(size_t)f * numClasses];
+            for (int c = 0; c < numClasses; ++c) out[c] += Float16::toFloat(row[c]) * v;
+        }
+    }
+}
+
+int QuantizedLogisticRegression::predictId(const SparseVector &vector) const {
+    METRIC_TIMER("qlr_predict");
+    std::vector<float> z;
+    scores(vector, z);
+
+    int best = 0;
+    for (int c = 1; c < numClasses; ++c) {
+        if (z[c] > z[best]) best = c;
+    }
+    return numClasses > 0 ? best : -1;
+}
+
+std::string QuantizedLogisticRegression::predict(const SparseVector &vector) const {
+    int id = predictId(vector);
+    return id < 0 ? "" : classes[id];
+}
+
+const std::vector<std::string> &QuantizedLogisticRegression::getClasses() const {
+    return classes;
+}
+
+size_t QuantizedLogisticRegression::sizeBytes() const {
+    return weightsInt8.size() * sizeof(int8_t)
+         + weightsHalf.size() * sizeof(uint16_t)
+         + (scale.size() + bias.size()) * sizeof(float);
+}
+
+// ---------------------------------------------------------------------------
+// QuantizedNaiveBayes
+// ---------------------------------------------------------------------------
+
+QuantizedNaiveBayes::QuantizedNaiveBayes()
+    : precision(QUANT_INT8), vocabSize(0), numClasses(0) {
+}
+
+void QuantizedNaiveBayes::quantize(const NaiveBayes &model, const std::vector<std::string> &vocab, QuantPrecision p) {
+    precision = p;
+    classes = model.getClasses();
+    numClasses = (int)classes.size();
+    vocabSize = (int)vocab.size();
+
+    logProbInt8.clear();
+    logProbHalf.clear();
+    scale.assign(numClasses, 1.0f);
+    offset.assign(numClasses, 0.0f);
+    logPrior.assign(numClasses, 0.0f);
+    logUnseen.assign(numClasses, 0.0f);
+
+    if (precision == QUANT_INT8) logProbInt8.assign((size_t)vocabSize * numClasses, 0);
+    else logProbHalf.assign((size_t)vocabSize * numClasses, 0);
+
+    std::vector<double> logp(vocabSize);
+    for (int c = 0; c < numClasses; ++c) {
+        const std::string &cls = classes[c];
+        double prior = model.getPrior(cls);
+        logPrior[c] = prior > 0.0 ? (float)std::log(prior) : -std::numeric_limits<float>::infinity();
+        logUnseen[c] = (float)std::log(model.getUnseenConditional(cls));
+
+        double lo = 0.0, hi = -std::numeric_limits<double>::infinity();
+        for (int v = 0; v < vocabSize; ++v) {
+            logp[v] = std::log(model.getConditional(cls, vocab[v]));
+            if (v == 0 || logp[v] < lo) lo = logp[v];
+            if (logp[v] > hi) hi = logp[v];
+        }
+
+        if (precision == QUANT_INT8) {
+            // affine mapping [lo, hi] -> [0, 255]
+            double s = (hi > lo) ? (hi - lo) / 255.0 : 1.0;
+            scale[c] = (float)s;
+            offset[c] = (float)lo;
+            for (int v = 0; v < vocabSize; ++v) {
+                long q = std::lround((logp[v] - lo) / s);
+                if (q < 0) q = 0;
+                if (q > 255) q = 255;
+                logProbInt8[(size_t)v * numClasses + c] = (uint8_t)q;
+            }
+        }
+        else {
+            for (int v = 0; v < vocabSize; ++v) {
+                logProbHalf[(size_t)v * numClasses + c] = Float16::fromFloat((float)logp[v]);
+            }
+        }
+    }
+}
+
+void QuantizedNaiveBayes::scores(const SparseVector &counts, int oovTokens, std::vector<float> &out) const {
+    out.assign(numClasses, 0.0f);
+    size_t nnz = counts.nnz();
+
+    for (int c = 0; c < numClasses; ++c) out[c] = logPrior[c] + logUnseen[c] * (float)oovTokens;
+
+    if (precision == QUANT_INT8) {
+        std::vector<int32_t> acc(numClasses, 0);
+        int32_t totalCount = 0;
+        for (size_t k = 0; k < nnz; ++k) {
+            int v = counts.indices[k];
+            if (v < 0 || v >= vocabSize) continue;
+            int32_t n = (int32_t)counts.values[k];
+            totalCount += n;
+            const uint8_t *row = &logProbInt8[(size_t)v * numClasses];
+            for (int c = 0; c < numClasses; ++c) acc[c] += (int32_t)row[c] * n;
+        }
+        for (int c = 0; c < numClasses; ++c) {
+            out[c] += offset[c] * (float)totalCount + scale[c] * (float)acc[c];
+        }
+    }
+    else {
+        for (size_t k = 0; k < nnz; ++k) {
+            int v = counts.indices[k];
+            if (v < 0 || v >= vocabSize) continue;
+            float n = (float)counts.values[k];
+            const uint16_t *row = &logProbHalf[(size_t)v * numClasses];
+            for (int c = 0; c < numClasses; ++c) out[c] += Float16::toFloat(row[c]) * n;
+        }
+    }
+}
+
+int QuantizedNaiveBayes::predictId(const SparseVector &counts, int oovTokens) const {
+    METRIC_TIMER("qnb_predict");
+    std::vector<float> s;
+    scores(counts, oovTokens, s);
+
+    int best = 0;
+    for (int c = 1; c < numClasses; ++c) {
+        if (s[c] > s[best]) best = c;
+    }
+    return numClasses > 0 ? best : -1;
+}
+
+std::string QuantizedNaiveBayes::predict(const SparseVector &counts, int oovTokens) const {
+    int id = predictId(counts, oovTokens);
+    return id < 0 ? "" : classes[id];
+}
+
+const std::vector<std::string> &QuantizedNaiveBayes::getClasses() const {
+    return classes;
+}
+
+size_t QuantizedNaiveBayes::sizeBytes() const {
+    return logProbInt8.size() * sizeof(uint8_t)
+         + logProbHalf.size() * sizeof(uint16_t)
+         + (scale.size() + offset.size() + logPrior.size() + logUnseen.size()) * sizeof(float);
+}
@@ -0,0 +1,260 @@
+#include "../include/ScoringPipeline.hpp"
+#include "../include/BoundedQueue.hpp"
+#include "../include/CsvStream.hpp"
+#include "../include/Metrics.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <map>
+
+namespace {
+
+// One CSV row on its way through the pipeline
+struct Row {
+    size_t index;
+    std::string text;
+    std::string label;
+    std::vector<std::string> tokens;
+    SparseVector counts;
+    std::string line;   // formatted output
+    Row() : index(0) {}
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Helper: fold per-worker stats into one stage row
+ScoringPipeline::StageStats mergeStats(const std::string &name, const std::vector<ScoringPipeline::StageStats> &workers) {
+    ScoringPipeline::StageStats total;
+    total.name = name;
+    total.workers = (int)workers.size();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        total.items += workers[i].items;
+        total.busySeconds += workers[i].busySeconds;
+        total.starvedSeconds += workers[i].starvedSeconds;
+        total.blockedSeconds += workers[i].blockedSeconds;
+    }
+    return total;
+}
+
+}
+
+ScoringPipeline::ScoringPipeline(std::shared_ptr<const ModelSnapshot> snapshot, const Options &opts)
+    : options(opts), models(snapshot) {
+    if (options.tokenizerThreads < 1) options.tokenizerThreads = 1;
+    if (options.scorerThreads < 1) options.scorerThreads = 1;
+    if (options.queueCapacity < 2) options.queueCapacity = 2;
+}
+
+std::string ScoringPipeline::formatRow(size_t row, const std::string &label,
+                                       const std::string &nb, const std::string &vsm,
+                                       const std::string &lr, const std::string &ensemble) {
+    std::ostringstream line;
+    line << row << ',' << label << ',' << nb << ',' << vsm << ',' << lr << ',' << ensemble << '\n';
+    return line.str();
+}
+
+bool ScoringPipeline::run(const std::string &inputPath, const std::string &outputPath, Report &report) const {
+    METRIC_TIMER("pipeline_run");
+    report = Report();
+    CsvStream in(inputPath);
+    if (!in.isOpen()) {
+        std::cerr << "Error: cannot open " << inputPath << std::endl;
+        return false;
+    }
+    std::ofstream out(outputPath.c_str(), std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: cannot write " << outputPath << std::endl;
+        return false;
+    }
+    out << "row,label,naive_bayes,vsm,logistic_regression,ensemble\n";
+
+    const ModelSnapshot &m = *models;
+    BoundedQueue<Row> rawQueue(options.queueCapacity);
+    BoundedQueue<Row> tokenQueue(options.queueCapacity);
+    BoundedQueue<Row> vectorQueue(options.queueCapacity);
+    BoundedQueue<Row> scoredQueue(options.queueCapacity);
+
+    // every producer is registered before any consumer can see an empty queue
+    rawQueue.addProducer();
+    for (int t = 0; t < options.tokenizerThreads; ++t) tokenQueue.addProducer();
+    vectorQueue.addProducer();
+    for (int t = 0; t < options.scorerThreads; ++t) scoredQueue.addProducer();
+
+    std::vector<StageStats> readerStats(1), tokenizerStats(options.tokenizerThreads),
+                            vectorizerStats(1), scorerStats(options.scorerThreads), writerStats(1);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+
+    // reader: disk -> rows
+    threads.push_back(std::thread([&]() {
+        StageStats &s = readerStats[0];
+        Row row;
+        while (true) {
+            Clock::time_point t0 = Clock::now();
+            bool more = in.next(row.text, row.label);
+            s.busySeconds += secondsSince(t0);
+            if (!more) break;
+            row.index = s.items++;
+            rawQueue.push(row, s.blockedSeconds);
+        }
+        rawQueue.producerDone();
+    }));
+
+    // tokenizer pool
+    for (int t = 0; t < options.tokenizerThreads; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            StageStats &s = tokenizerStats[t];
+            Row row;
+            while (rawQueue.pop(row, s.starvedSeconds)) {
+                Clock::time_point t0 = Clock::now();
+                row.tokens = m.pre.process(row.text);
+                std::string().swap(row.text);
+                s.busySeconds += secondsSince(t0);
+                s.items++;
+                tokenQueue.push(row, s.blockedSeconds);
+            }
+            tokenQueue.producerDone();
+        }));
+    }
+
+    // vectorizer: tokens -> sparse counts
+    threads.push_back(std::thread([&]() {
+        StageStats &s = vectorizerStats[0];
+        Row row;
+        while (tokenQueue.pop(row, s.starvedSeconds)) {
+            Clock::time_point t0 = Clock::now();
+            row.counts = m.vec.transformSparse(row.tokens);
+            s.busySeconds += secondsSince(t0);
+            s.items++;
+            vectorQueue.push(row, s.blockedSeconds);
+        }
+        vectorQueue.producerDone();
+    }));
+
+    // scorer pool
+    for (int t = 0; t < options.scorerThreads; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            StageStats &s = scorerStats[t];
+            Row row;
+            while (vectorQueue.pop(row, s.starvedSeconds)) {
+                Clock::time_point t0 = Clock::now();
+                row.line = formatRow(row.index, row.label,
+                                     m.nb.predict(row.tokens),
+                                     m.vsm.predictSparse(row.counts),
+                                     m.lr.predictSparse(row.counts),
+                                     m.ensemble.predict(row.tokens));
+                row.tokens.clear();
+                row.counts.indices.clear();
+                row.counts.values.clear();
+                s.busySeconds += secondsSince(t0);
+                s.items++;
+                scoredQueue.push(row, s.blockedSeconds);
+            }
+            scoredQueue.producerDone();
+        }));
+    }
+
+    // writer (this thread): restore input order, then append to the file
+    {
+        StageStats &s = writerStats[0];
+        std::map<size_t, std::string> pending;
+        size_t nextRow = 0;
+        Row row;
+        while (scoredQueue.pop(row, s.starvedSeconds)) {
+            Clock::time_point t0 = Clock::now();
+            pending[row.index].swap(row.line);
+            std::map<size_t, std::string>::iterator it;
+            while ((it = pending.find(nextRow)) != pending.end()) {
+                out << it->second;
+                pending.erase(it);
+                nextRow++;
+                s.items++;
+            }
+            s.busySeconds += secondsSince(t0);
+        }
+        Clock::time_point t0 = Clock::now();
+        out.flush();
+        s.busySeconds += secondsSince(t0);
+    }
+
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+
+    report.seconds = secondsSince(start);
+    report.rows = readerStats[0].items;
+    report.bytesRead = in.getBytesRead();
+    report.stages.push_back(mergeStats("reader", readerStats));
+    report.stages.push_back(mergeStats("tokenizer", tokenizerStats));
+    report.stages.push_back(mergeStats("vectorizer", vectorizerStats));
+    report.stages.push_back(mergeStats("scorer", scorerStats));
+    report.stages.push_back(mergeStats("writer", writerStats));
+    METRIC_COUNT("pipeline_rows", report.rows);
+    return true;
+}
+
+bool ScoringPipeline::runSequential(const std::string &inputPath, const std::string &outputPath, Report &report) const {
+    report = Report();
+    CsvStream in(inputPath);
+    if (!in.isOpen()) {
+        std::cerr << "Error: cannot open " << inputPath << std::endl;
+        return false;
+    }
+    std::ofstream out(outputPath.c_str(), std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: cannot write " << outputPath << std::endl;
+        return false;
+    }
+    out << "row,label,naive_bayes,vsm,logistic_regression,ensemble\n";
+
+    const ModelSnapshot &m = *models;
+    Clock::time_point start = Clock::now();
+    std::string text, label;
+    while (in.next(text, label)) {
+        std::vector<std::string> tokens = m.pre.process(text);
+        SparseVector counts = m.vec.transformSparse(tokens);
+        out << formatRow(report.rows++, label,
+                         m.nb.predict(tokens),
+                         m.vsm.predictSparse(counts),
+                         m.lr.predictSparse(counts),
+                         m.ensemble.predict(tokens));
+    }
+    out.flush();
+    report.seconds = secondsSince(start);
+    report.bytesRead = in.getBytesRead();
+    return true;
+}
+
+void ScoringPipeline::printReport(const Report &report) {
+    double wall = report.seconds > 0.0 ? report.seconds : 1e-9;
+    if (report.stages.empty()) {
+        std::cout << std::fixed << std::setprecision(2) << "[INFO] " << report.rows << " rows in "
+                  << report.seconds << " s (" << std::setprecision(0) << (double)report.rows / wall << " rows/s)" << std::endl;
+        return;
+    }
+
+    std::cout << "\n╔══════════════╦═════════╦══════════╦═════════╦═════════╦═════════╗" << std::endl;
+    std::cout << "║ Stage        ║ workers ║ rows     ║ busy %  ║ starved ║ blocked ║" << std::endl;
+    std::cout << "╠══════════════╬═════════╬══════════╬═════════╬═════════╬═════════╣" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < report.stages.size(); ++i) {
+        const StageStats &s = report.stages[i];
+        // utilisation is per worker: 100% means every worker of the stage was always busy
+        double capacity = wall * (double)s.workers;
+        std::cout << "║ " << std::left << std::setw(12) << s.name << " ║ " << std::right
+                  << std::setw(7) << s.workers << " ║ " << std::setw(8) << s.items << " ║ "
+                  << std::setw(7) << 100.0 * s.busySeconds / capacity << " ║ "
+                  << std::setw(7) << 100.0 * s.starvedSeconds / capacity << " ║ "
+                  << std::setw(7) << 100.0 * s.blockedSeconds / capacity << " ║" << std::endl;
+    }
+    std::cout << "╚══════════════╩═════════╩══════════╩═════════╩═════════╩═════════╝" << std::endl;
+    std::cout << "[INFO] " << report.rows << " rows, " << std::setprecision(2) << report.bytesRead / 1048576.0
+              << " MB in " << std::setprecision(3) << report.seconds << " s ("
+              << std::setprecision(0) << (double)report.rows / wall << " rows/s, "
+              << std::setprecision(2) << (double)report.bytesRead / 1048576.0 / wall << " MB/s)" << std::endl;
+}
@@ -0,0 +1,72 @@
+#include "../include/ScratchArena.hpp"
+#include <new>
+
+ScratchArena::ScratchArena(size_t initialBlockSize)
+    : current(0), offset(0), blockSize(initialBlockSize) {
+    if (blockSize < 256) blockSize = 256;
+}
+
+ScratchArena::~ScratchArena() {
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        ::operator delete(blocks[i].data);
+    }
+}
+
+void *ScratchArena::allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;
+
+    while (true) {
+        if (current < blocks.size()) {
+            Block &b = blocks[current];
+            size_t start = (offset + alignment - 1) & ~(alignment - 1);
+            if (start + bytes <= b.size) {
+                offset = start + bytes;
+                return b.data + start;
+            }
+            // move on to the next retained block, if any
+            if (current + 1 < blocks.size()) {
+                current++;
+                offset = 0;
+                continue;
+            }
+        }
+
+        // no room anywhere: add a block big enough for this request
+        size_t size = blockSize;
+        while (size < bytes + alignment) size *= 2;
+        Block nb;
+        nb.data = static_cast<char *>(::operator new(size));
+        nb.size = size;
+        blocks.push_back(nb);
+        current = blocks.size() - 1;
+        offset = 0;
+    }
+}
+
+ScratchArena::Marker ScratchArena::mark() const {
+    Marker m;
+    m.block = current;
+    m.offset = offset;
+    return m;
+}
+
+void ScratchArena::rewind(const Marker &m) {
+    current = m.block;
+    offset = m.offset;
+}
+
+void ScratchArena::reset() {
+    current = 0;
+    offset = 0;
+}
+
+size_t ScratchArena::capacity() const {
+    size_t total = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) total += blocks[i].size;
+    return total;
+}
+
+ScratchContext &ScratchContext::local() {
+    static thread_local ScratchContext ctx;
+    return ctx;
+}
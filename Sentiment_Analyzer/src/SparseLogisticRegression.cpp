@@ -0,0 +1,185 @@
+#include "../include/SparseLogisticRegression.hpp"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+static const char SPARSE_LR_MAGIC[8] = { 'E', 'M', 'O', 'S', 'L', 'R', '0', '1' };
+
+SparseLogisticRegression::SparseLogisticRegression() : numFeatures(0) {
+}
+
+void SparseLogisticRegression::compact(const LogisticRegression &model, double threshold) {
+    classes = model.getClasses();
+    size_t numClasses = classes.size();
+    numFeatures = numClasses > 0 ? (int)model.getWeights(classes[0]).size() : 0;
+
+    featureIds.clear();
+    rowStart.assign(1, 0);
+    entryClass.clear();
+    entryWeight.clear();
+    bias.assign(numClasses, 0.0f);
+
+    std::vector<const double *> w(numClasses);
+    for (size_t c = 0; c < numClasses; ++c) {
+        w[c] = model.getWeights(classes[c]).data();
+        bias[c] = (float)model.getBias(classes[c]);
+    }
+
+    for (int f = 0; f < numFeatures; ++f) {
+        size_t before = entryWeight.size();
+        for (size_t c = 0; c < numClasses; ++c) {
+            if (std::fabs(w[c][f]) <= threshold) continue;
+            entryClass.push_back((uint16_t)c);
+            entryWeight.push_back((float)w[c][f]);
+        }
+        if (entryWeight.size() == before) continue;
+        featureIds.push_back((uint32_t)f);
+        rowStart.push_back((uint32_t)entryWeight.size());
+    }
+}
+
+void SparseLogisticRegression::scores(const SparseVector &vector, std::vector<double> &out) const {
+    out.assign(bias.begin(), bias.end());
+
+    // query indices are sorted, so the search for the next one starts where the last ended
+    std::vector<uint32_t>::const_iterator from = featureIds.begin();
+    int previous = -1;
+    for (size_t k = 0; k < vector.nnz(); ++k) {
+        int f = vector.indices[k];
+        if (f < 0) continue;
+        if (f < previous) from = featureIds.begin();
+        previous = f;
+
+        from = std::lower_bound(from, featureIds.end(), (uint32_t)f);
+        if (from == featureIds.end()) break;
+        if (*from != (uint32_t)f) continue;
+
+        size_t row = from - featureIds.begin();
+        double x = vector.values[k];
+        for (uint32_t e = rowStart[row]; e < rowStart[row + 1]; ++e) {
+            out[entryClass[e]] += (double)entryWeight[e] * x;
+        }
+    }
+}
+
+int SparseLogisticRegression::predictId(const SparseVector &vector) const {
+    if (classes.empty()) return -1;
+    std::vector<double> z;
+    scores(vector, z);
+    return (int)(std::max_element(z.begin(), z.end()) - z.begin());
+}
+
+std::string SparseLogisticRegression::predict(const SparseVector &vector) const {
+    int id = predictId(vector);
+    return id < 0 ? "" : classes[id];
+}
+
+// Helper: raw array of a vector, length-prefixed
+template <class T>
+static void writeArray(std::ofstream &out, const std::vector<T> &values) {
+    uint64_t n = values.size();
+    out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    if (n > 0) out.write(reinterpret_cast<const char *>(&values[0]), n * sizeof(T));
+}
+
+template <class T>
+static bool readArray(std::ifstream &in, std::vector<T> &values) {
+    uint64_t n = 0;
+    if (!in.read(reinterpret_cast<char *>(&n), sizeof(n))) return false;
+    values.resize(n);
+    return n == 0 || (bool)in.read(reinterpret_cast<char *>(&values[0]), n * sizeof(T));
+}
+
+bool SparseLogisticRegression::save(const std::string &path) const {
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    out.write(SPARSE_LR_MAGIC, sizeof(SPARSE_LR_MAGIC));
+    uint64_t numClasses = classes.size();
+    out.write(reinterpret_cast<const char *>(&numClasses), sizeof(numClasses));
+    for (size_t c = 0; c < classes.size(); ++c) {
+        uint32_t len = (uint32_t)classes[c].size();
+        out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+        out.write(classes[c].data(), len);
+    }
+    int32_t features = numFeatures;
+    out.write(reinterpret_cast<const char *>(&features), sizeof(features));
+    writeArray(out, bias);
+    writeArray(out, featureIds);
+    writeArray(out, rowStart);
+    writeArray(out, entryClass);
+    writeArray(out, entryWeight);
+    out.close();
+    if (!out) return false;
+
+    std::remove(path.c_str());
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+bool SparseLogisticRegression::load(const std::string &path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char magic[8];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SPARSE_LR_MAGIC, sizeof(magic)) != 0) return false;
+
+    SparseLogisticRegression loaded;
+    uint64_t numClasses = 0;
+    if (!in.read(reinterpret_cast<char *>(&numClasses), sizeof(numClasses))) return false;
+    for (uint64_t c = 0; c < numClasses; ++c) {
+        uint32_t len = 0;
+        if (!in.read(reinterpret_cast<char *>(&len), sizeof(len))) return false;
+        std::string name(len, '\0');
+        if (len > 0 && !in.read(&name[0], len)) return false;
+        loaded.classes.push_back(name);
+    }
+    int32_t features = 0;
+    if (!in.read(reinterpret_cast<char *>(&features), sizeof(features))) return false;
+    loaded.numFeatures = features;
+    if (!readArray(in, loaded.bias) || !readArray(in, loaded.featureIds) || !readArray(in, loaded.rowStart) ||
+        !readArray(in, loaded.entryClass) || !readArray(in, loaded.entryWeight)) return false;
+
+    // reject files whose tables do not line up
+    if (loaded.bias.size() != loaded.classes.size() || loaded.rowStart.size() != loaded.featureIds.size() + 1 ||
+        loaded.entryClass.size() != loaded.entryWeight.size() || loaded.rowStart.back() != loaded.entryWeight.size()) return false;
+    for (size_t e = 0; e < loaded.entryClass.size(); ++e) {
+        if (loaded.entryClass[e] >= loaded.classes.size()) return false;
+    }
+    // scores() walks rows by rowStart and binary-searches featureIds: offsets must start at zero and
+    // never decrease, ids must be strictly ascending and inside the feature space
+    if (features < 0 || loaded.rowStart[0] != 0) return false;
+    for (size_t row = 0; row < loaded.featureIds.size(); ++row) {
+        if (loaded.rowStart[row] > loaded.rowStart[row + 1] || loaded.featureIds[row] >= (uint32_t)features) return false;
+        if (row > 0 && loaded.featureIds[row] <= loaded.featureIds[row - 1]) return false;
+    }
+    std::swap(*this, loaded);
+    return true;
+}
+
+const std::vector<std::string> &SparseLogisticRegression::getClasses() const {
+    return classes;
+}
+
+int SparseLogisticRegression::getNumFeatures() const {
+    return numFeatures;
+}
+
+size_t SparseLogisticRegression::getActiveFeatureCount() const {
+    return featureIds.size();
+}
+
+size_t SparseLogisticRegression::getNonZeroCount() const {
+    return entryWeight.size();
+}
+
+size_t SparseLogisticRegression::sizeBytes() const {
+    return featureIds.size() * sizeof(uint32_t) + rowStart.size() * sizeof(uint32_t) +
+           entryClass.size() * sizeof(uint16_t) + entryWeight.size() * sizeof(float) + bias.size() * sizeof(float);
+}
+
+size_t SparseLogisticRegression::denseSizeBytes() const {
+    return classes.size() * ((size_t)numFeatures + 1) * sizeof(double);
+}
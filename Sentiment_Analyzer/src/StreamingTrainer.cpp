@@ -0,0 +1,286 @@
+#include "../include/StreamingTrainer.hpp"
+#include "../include/CsvStream.hpp"
+#include "../include/ScratchArena.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/NaiveBayesCounts.hpp"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+StreamingTrainer::StreamingTrainer(const Options &opts) : options(opts) {
+}
+
+// Helper: length in words of the cache record at rec (label, nnz, pairs, hashed nnz, hashed pairs)
+static size_t recordWords(const uint32_t *rec) {
+    size_t nnz = rec[1];
+    return 3 + 2 * nnz + 2 * (size_t)rec[2 + 2 * nnz];
+}
+
+// Helper: words of the cache record at chunk[r], or 0 when it runs past the chunk or names a
+// class, word or hashed feature outside the model (a truncated or corrupt cache)
+static size_t checkedRecordWords(const std::vector<uint32_t> &chunk, size_t r,
+                                 size_t numClasses, size_t numWords, size_t numHashed) {
+    if (r + 1 >= chunk.size() || chunk[r] >= numClasses) return 0;
+    size_t nnz = chunk[r + 1];
+    size_t hashedPos = r + 2 + 2 * nnz;
+    if (hashedPos >= chunk.size()) return 0;
+    size_t hnnz = chunk[hashedPos];
+    if (hashedPos + 1 + 2 * hnnz > chunk.size()) return 0;
+    for (size_t t = 0; t < nnz; ++t) {
+        if (chunk[r + 2 + 2 * t] >= numWords) return 0;
+    }
+    for (size_t t = 0; t < hnnz; ++t) {
+        if (chunk[hashedPos + 1 + 2 * t] >= numHashed) return 0;
+    }
+    return hashedPos + 1 + 2 * hnnz - r;
+}
+
+void StreamingTrainer::flushChunk(std::ofstream &out, std::vector<uint32_t> &buffer,
+                                  std::vector<size_t> &offsets, unsigned seed,
+                                  std::vector<uint64_t> &chunkOffsets) {
+    std::mt19937 rng(seed + (unsigned)chunkOffsets.size());
+    std::shuffle(offsets.begin(), offsets.end(), rng);
+
+    // record layout: label, nnz, nnz (id, count) pairs, hashed nnz, hashed (index, signed value) pairs
+    uint64_t written = 0;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const uint32_t *rec = &buffer[offsets[i]];
+        size_t words = recordWords(rec);
+        out.write(reinterpret_cast<const char *>(rec), words * sizeof(uint32_t));
+        written += words * sizeof(uint32_t);
+    }
+    chunkOffsets.push_back(chunkOffsets.back() + written);
+
+    buffer.clear();
+    offsets.clear();
+}
+
+bool StreamingTrainer::train(const std::string &csvPath, Preprocessor &pre, Vectorizer &vec,
+                             NaiveBayes &nb, VSM &vsm, LogisticRegression &lr,
+                             const HashingVectorizer &hashVec, LogisticRegression &hashLr, Report &report) {
+    METRIC_TIMER("streaming_train");
+    report = Report();
+    std::string cachePath = options.cachePath.empty() ? csvPath + ".sgdcache" : options.cachePath;
+
+    CsvStream csv(csvPath);
+    if (!csv.isOpen()) {
+        std::cerr << "Error: could not open file: " << csvPath << std::endl;
+        return false;
+    }
+    std::ofstream out(cachePath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: could not create cache file: " << cachePath << std::endl;
+        return false;
+    }
+
+    size_t chunkBudget = std::max((size_t)1 << 20, options.memoryBudgetBytes / 4);
+    report.chunkBudgetBytes = chunkBudget;
+
+    // ---- pass 1: vocabulary, NB counts, document frequencies, binary cache ----
+    std::chrono::steady_clock::time_point p0 = std::chrono::steady_clock::now();
+    std::unordered_map<std::string, int> vocabIndex;
+    std::vector<std::string> vocab;
+    std::vector<std::string> classes;
+    // 64-bit counters: per-class token totals pass 2^31 well inside a multi-GB export
+    std::vector<int64_t> classDocs;
+    std::vector<std::vector<int64_t>> wordCounts;   // [class][word id], rows grow with the vocabulary
+
+    std::vector<uint32_t> buffer;
+    std::vector<size_t> offsets;
+    std::vector<uint64_t> chunkOffsets(1, 0);
+    std::vector<int> ids;
+    std::string text, label;
+    ScratchContext &ctx = ScratchContext::local();
+
+    while (csv.next(text, label)) {
+        size_t count = pre.processInto(text, ctx);
+
+        ids.clear();
+        for (size_t t = 0; t < count; ++t) {
+            std::unordered_map<std::string, int>::iterator it = vocabIndex.find(ctx.tokens[t]);
+            if (it == vocabIndex.end()) {
+                it = vocabIndex.insert(std::make_pair(ctx.tokens[t], (int)vocab.size())).first;
+                vocab.push_back(ctx.tokens[t]);
+            }
+            ids.push_back(it->second);
+        }
+        std::sort(ids.begin(), ids.end());
+
+        int c = (int)(std::find(classes.begin(), classes.end(), label) - classes.begin());
+        if (c == (int)classes.size()) {
+            classes.push_back(label);
+            classDocs.push_back(0);
+            wordCounts.push_back(std::vector<int64_t>());
+        }
+        classDocs[c]++;
+        std::vector<int64_t> &wc = wordCounts[c];
+        if (wc.size() < vocab.size()) wc.resize(vocab.size(), 0);
+
+        offsets.push_back(buffer.size());
+        buffer.push_back((uint32_t)c);
+        size_t nnzPos = buffer.size();
+        buffer.push_back(0);
+        for (size_t i = 0; i < ids.size(); ) {
+            size_t j = i;
+            while (j < ids.size() && ids[j] == ids[i]) j++;
+            int id = ids[i];
+            int n = (int)(j - i);
+            buffer.push_back((uint32_t)id);
+            buffer.push_back((uint32_t)n);
+            buffer[nnzPos]++;
+            wc[id] += n;
+            i = j;
+        }
+
+        // hashed n-grams come from the token order, which the id pairs above no longer keep
+        hashVec.transformSingle(ctx.tokens.data(), count, ctx.hashed);
+        buffer.push_back((uint32_t)ctx.hashed.nnz());
+        for (size_t k = 0; k < ctx.hashed.nnz(); ++k) {
+            buffer.push_back((uint32_t)ctx.hashed.indices[k]);
+            buffer.push_back((uint32_t)(int32_t)ctx.hashed.values[k]);
+        }
+        report.documents++;
+
+        size_t chunkBytes = buffer.size() * sizeof(uint32_t) + offsets.size() * sizeof(size_t);
+        if (chunkBytes >= chunkBudget) {
+            report.peakChunkBytes = std::max(report.peakChunkBytes, chunkBytes);
+            flushChunk(out, buffer, offsets, options.seed, chunkOffsets);
+            if (!out) break;
+        }
+    }
+    if (out && !offsets.empty()) {
+        report.peakChunkBytes = std::max(report.peakChunkBytes,
+                                         buffer.size() * sizeof(uint32_t) + offsets.size() * sizeof(size_t));
+        flushChunk(out, buffer, offsets, options.seed, chunkOffsets);
+    }
+    if (out) out.close();
+    // a short write (e.g. a full disk) would leave a truncated cache behind
+    if (!out) {
+        std::cerr << "Error: could not write cache file: " << cachePath << std::endl;
+        std::remove(cachePath.c_str());
+        return false;
+    }
+    std::vector<uint32_t>().swap(buffer);
+    std::vector<size_t>().swap(offsets);
+
+    report.csvBytes = csv.getBytesRead();
+    report.cacheBytes = chunkOffsets.back();
+    report.chunks = chunkOffsets.size() - 1;
+    report.vocabularySize = vocab.size();
+    report.pass1Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - p0).count();
+    METRIC_COUNT("streaming_documents", report.documents);
+
+    if (report.documents == 0) {
+        if (!options.keepCache) std::remove(cachePath.c_str());
+        return true;
+    }
+
+    int V = (int)vocab.size();
+    int C = (int)classes.size();
+    report.modelBytes = (size_t)V * C * (sizeof(int64_t) + 2 * sizeof(double)) + (size_t)V * sizeof(int) +
+                        (size_t)hashVec.getDimension() * C * sizeof(double);
+
+    // hand the rows to a count table once the vocabulary is final, so NB is built the same
+    // way as from merged count files (NaiveBayes::trainFromCountTable)
+    {
+        NaiveBayesCounts table(classes, vocab);
+        for (int c = 0; c < C; ++c) {
+            table.addClassCounts(c, classDocs[c], wordCounts[c].data(), wordCounts[c].size());
+            std::vector<int64_t>().swap(wordCounts[c]);
+        }
+        nb.trainFromCountTable(table);
+    }
+
+    double N = (double)report.documents;
+    vec.setVocabulary(vocab);
+    lr.initModel(classes, V);
+    hashLr.initModel(classes, hashVec.getDimension());
+    vsm.initModel(classes, V);
+
+    // ---- SGD epochs over the shuffled cache; epoch 1 also folds the documents into VSM ----
+    std::ifstream in(cachePath.c_str(), std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: could not read cache file: " << cachePath << std::endl;
+        return false;
+    }
+
+    std::vector<size_t> chunkOrder(report.chunks);
+    for (size_t i = 0; i < chunkOrder.size(); ++i) chunkOrder[i] = i;
+    std::vector<uint32_t> chunk;
+    std::vector<size_t> records;
+    SparseVector x, h;
+    int epochs = std::max(1, options.epochs);
+
+    for (int ep = 0; ep < epochs; ++ep) {
+        METRIC_TIMER("streaming_epoch");
+        std::chrono::steady_clock::time_point e0 = std::chrono::steady_clock::now();
+        std::mt19937 rng(options.seed + 7919u * (unsigned)(ep + 1));
+        std::shuffle(chunkOrder.begin(), chunkOrder.end(), rng);
+        size_t correct = 0, hashCorrect = 0;
+
+        for (size_t k = 0; k < chunkOrder.size(); ++k) {
+            size_t ch = chunkOrder[k];
+            uint64_t begin = chunkOffsets[ch];
+            uint64_t bytes = chunkOffsets[ch + 1] - begin;
+            chunk.resize((size_t)(bytes / sizeof(uint32_t)));
+            in.seekg((std::streamoff)begin);
+            in.read(reinterpret_cast<char *>(chunk.data()), (std::streamsize)bytes);
+            bool intact = in && (uint64_t)in.gcount() == bytes;
+
+            records.clear();
+            for (size_t r = 0; intact && r < chunk.size(); ) {
+                size_t words = checkedRecordWords(chunk, r, (size_t)C, (size_t)V, (size_t)hashVec.getDimension());
+                if (words == 0) {
+                    intact = false;
+                    break;
+                }
+                records.push_back(r);
+                r += words;
+            }
+            if (!intact) {
+                std::cerr << "Error: cache file is truncated or corrupt: " << cachePath << std::endl;
+                if (!options.keepCache) std::remove(cachePath.c_str());
+                return false;
+            }
+            std::shuffle(records.begin(), records.end(), rng);
+
+            for (size_t i = 0; i < records.size(); ++i) {
+                const uint32_t *rec = &chunk[records[i]];
+                int c = (int)rec[0];
+                size_t nnz = rec[1];
+                x.clear();
+                for (size_t t = 0; t < nnz; ++t) {
+                    x.indices.push_back((int)rec[2 + 2 * t]);
+                    x.values.push_back((double)rec[3 + 2 * t]);
+                }
+                const uint32_t *hashed = rec + 2 + 2 * nnz;
+                size_t hnnz = hashed[0];
+                h.clear();
+                for (size_t t = 0; t < hnnz; ++t) {
+                    h.indices.push_back((int)hashed[1 + 2 * t]);
+                    h.values.push_back((double)(int32_t)hashed[2 + 2 * t]);
+                }
+
+                if (lr.sgdStep(x, c) == c) correct++;
+                if (hashLr.sgdStep(h, c) == c) hashCorrect++;
+
+                if (ep == 0) vsm.addDocument(x, c);
+            }
+        }
+
+        if (ep == 0) vsm.refreshCentroids();
+
+        report.epochAccuracy.push_back((double)correct / N);
+        report.epochHashAccuracy.push_back((double)hashCorrect / N);
+        report.epochSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - e0).count());
+    }
+    in.close();
+
+    if (!options.keepCache) std::remove(cachePath.c_str());
+    return true;
+}
@@ -0,0 +1,201 @@
+#include "../include/ThreadPool.hpp"
+#include <cstdlib>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// worker identity of the calling thread
+thread_local const ThreadPool *tlsPool = 0;
+thread_local int tlsIndex = -1;
+
+int g_sharedThreads = 0;
+bool g_sharedPin = false;
+
+}
+
+ThreadPool::ThreadPool(int numThreads, bool pinThreads)
+    : pending(0), nextVictim(0), stopping(false), stolen(0), executed(0) {
+    if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+    if (numThreads <= 0) numThreads = 1;
+
+    for (int i = 0; i < numThreads; ++i) workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    for (int i = 0; i < numThreads; ++i) {
+        threads.push_back(std::thread(&ThreadPool::workerLoop, this, i, pinThreads));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+}
+
+int ThreadPool::currentWorker() const {
+    return tlsPool == this ? tlsIndex : -1;
+}
+
+void ThreadPool::submit(const Task &task) {
+    int self = currentWorker();
+    size_t target = self >= 0 ? (size_t)self : nextVictim.fetch_add(1) % workers.size();
+    // counted before it is visible, so a thief can never drive the count below zero
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> guard(workers[target]->lock);
+        workers[target]->tasks.push_back(task);
+    }
+    {
+        // pairs with the predicate check in workerLoop so the wake-up cannot be lost
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::takeTask(int self, Task &task) {
+    size_t n = workers.size();
+
+    // own deque, newest first
+    if (self >= 0) {
+        Worker &own = *workers[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task.swap(own.tasks.back());
+            own.tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // steal the oldest task of another deque
+    size_t start = self >= 0 ? (size_t)self + 1 : nextVictim.load();
+    for (size_t k = 0; k < n; ++k) {
+        size_t victim = (start + k) % n;
+        if ((int)victim == self) continue;
+        Worker &w = *workers[victim];
+        std::lock_guard<std::mutex> guard(w.lock);
+        if (!w.tasks.empty()) {
+            task.swap(w.tasks.front());
+            w.tasks.pop_front();
+            pending.fetch_sub(1);
+            if (self >= 0) stolen.fetch_add(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index, bool pin) {
+    tlsPool = this;
+    tlsIndex = index;
+
+#ifdef __linux__
+    if (pin) {
+        unsigned cpus = std::thread::hardware_concurrency();
+        if (cpus > 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(index % cpus, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+    }
+#else
+    (void)pin;
+#endif
+
+    Task task;
+    while (true) {
+        if (takeTask(index, task)) {
+            task();
+            task = Task();
+            executed.fetch_add(1);
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return stopping.load() || pending.load() > 0; });
+        if (stopping.load() && pending.load() == 0) return;
+    }
+}
+
+bool ThreadPool::runPendingTask() {
+    Task task;
+    if (!takeTask(currentWorker(), task)) return false;
+    task();
+    executed.fetch_add(1);
+    return true;
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)> &body) {
+    if (end <= begin) return;
+    size_t n = end - begin;
+    if (grain == 0) grain = std::max<size_t>(1, n / (workers.size() * 4));
+    size_t chunks = (n + grain - 1) / grain;
+    if (chunks <= 1 || workers.size() <= 1) {
+        body(begin, end);
+        return;
+    }
+
+    // chunks are claimed from a shared counter by the caller and by helper tasks alike;
+    // a helper that starts after the loop is finished only sees an exhausted counter
+    struct Loop {
+        std::atomic<size_t> next;
+        std::atomic<size_t> done;
+        Loop() : next(0), done(0) {}
+    };
+    std::shared_ptr<Loop> loop = std::make_shared<Loop>();
+    const std::function<void(size_t, size_t)> *fn = &body;
+    std::function<void()> runChunks = [loop, fn, begin, end, grain, chunks]() {
+        size_t c;
+        while ((c = loop->next.fetch_add(1)) < chunks) {
+            size_t lo = begin + c * grain;
+            (*fn)(lo, std::min(end, lo + grain));
+            loop->done.fetch_add(1);
+        }
+    };
+
+    size_t helpers = std::min(chunks, workers.size()) - 1;
+    for (size_t h = 0; h < helpers; ++h) submit(runChunks);
+
+    // the caller works through chunks too, so nested loops always make progress
+    runChunks();
+    while (loop->done.load() < chunks) std::this_thread::yield();
+}
+
+int ThreadPool::size() const {
+    return (int)workers.size();
+}
+
+size_t ThreadPool::getStolenCount() const {
+    return stolen.load();
+}
+
+size_t ThreadPool::getExecutedCount() const {
+    return executed.load();
+}
+
+ThreadPool &ThreadPool::shared() {
+    // never destroyed: tasks may still be queued while static objects are torn down
+    static ThreadPool *pool = 0;
+    static std::once_flag created;
+    std::call_once(created, []() {
+        int threads = g_sharedThreads;
+        bool pin = g_sharedPin;
+        const char *env = std::getenv("EMOTION_THREADS");
+        if (threads <= 0 && env) threads = std::atoi(env);
+        const char *pinEnv = std::getenv("EMOTION_PIN_THREADS");
+        if (pinEnv && std::atoi(pinEnv) != 0) pin = true;
+        pool = new ThreadPool(threads, pin);
+    });
+    return *pool;
+}
+
+void ThreadPool::configureShared(int numThreads, bool pinThreads) {
+    g_sharedThreads = numThreads;
+    g_sharedPin = pinThreads;
+}
@@ -1,166 +1,309 @@
 #include "../include/VSM.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/DenseKernels.hpp"
 #include <iostream>
 #include <algorithm>
 
-VSM::VSM() {
+// Tile sizes for batched scoring: 16 documents x 2048 features
+static const size_t BATCH_DOC_BLOCK = 16;
+static const size_t BATCH_FEATURE_BLOCK = 2048;
+
+// per-thread single-query buffers, reused across calls
+static thread_local std::vector<double> scoreScratch;
+static thread_local SparseVector queryScratch;
+static thread_local std::vector<KnnIndex::Neighbor> neighborScratch;
+
+VSM::VSM() : knnK(5), docCount(0) {
     classes.clear();
     classCentroids.clear();
-    trainVectors.clear();
-    trainLabels.clear();
+    idf.clear();
+    centroidNorms.clear();
+    trainClassIds.clear();
 }
 
-double VSM::cosineSimilarity(const std::vector<double> &a, const std::vector<double> &b) {
+double VSM::cosineSimilarity(const std::vector<double> &a, const std::vector<double> &b) const {
     if (a.size() != b.size()) return 0.0;
     
-    double dotProduct = 0.0;
-    double normA = 0.0;
-    double normB = 0.0;
-    
-    for (size_t i = 0; i < a.size(); ++i) {
-        dotProduct += a[i] * b[i];
-        normA += a[i] * a[i];
-        normB += b[i] * b[i];
-    }
-    
-    normA = std::sqrt(normA);
-    normB = std::sqrt(normB);
+    double dotProduct = DenseKernels::dot(a.data(), b.data(), a.size());
+    double normA = DenseKernels::norm(a.data(), a.size());
+    double normB = DenseKernels::norm(b.data(), b.size());
     
     if (normA < 1e-10 || normB < 1e-10) return 0.0;
     
     return dotProduct / (normA * normB);
 }
 
-std::vector<std::vector<double>> VSM::computeTFIDF(const std::vector<std::vector<int>> &countVectors) {
-    int numDocs = (int)countVectors.size();
-    if (numDocs == 0) return std::vector<std::vector<double>>();
-    
-    int vocabSize = (int)countVectors[0].size();
-    
-    // Compute IDF for each term
-    std::vector<int> docFreq(vocabSize, 0);
-    for (int i = 0; i < numDocs; ++i) {
-        for (int j = 0; j < vocabSize; ++j) {
-            if (countVectors[i][j] > 0) {
-                docFreq[j]++;
-            }
-        }
+std::vector<double> VSM::toTFIDF(const std::vector<int> &countVector) const {
+    size_t n = std::min(countVector.size(), idf.size());
+    std::vector<double> tfidfVec(idf.size(), 0.0);
+
+    for (size_t j = 0; j < n; ++j) {
+        if (countVector[j] == 0) continue;
+        tfidfVec[j] = (double)countVector[j] * idf[j];
     }
-    
-    std::vector<double> idf(vocabSize);
-    for (int j = 0; j < vocabSize; ++j) {
-        if (docFreq[j] > 0) {
-            idf[j] = std::log((double)numDocs / (double)docFreq[j]);
-        } else {
-            idf[j] = 0.0;
-        }
+
+    double norm = DenseKernels::norm(tfidfVec.data(), n);
+    if (norm > 1e-10) DenseKernels::scale(1.0 / norm, tfidfVec.data(), n);
+    return tfidfVec;
+}
+
+SparseVector VSM::toTFIDFSparse(const std::vector<int> &countVector) const {
+    size_t n = std::min(countVector.size(), idf.size());
+    SparseVector v;
+
+    for (size_t j = 0; j < n; ++j) {
+        if (countVector[j] == 0 || idf[j] == 0.0) continue;
+        v.indices.push_back((int)j);
+        v.values.push_back((double)countVector[j] * idf[j]);
     }
-    
-    // Compute TF-IDF vectors
-    std::vector<std::vector<double>> tfidfVectors;
-    for (int i = 0; i < numDocs; ++i) {
-        std::vector<double> tfidfVec(vocabSize);
-        double norm = 0.0;
-        
-        for (int j = 0; j < vocabSize; ++j) {
-            double tf = (double)countVectors[i][j];
-            tfidfVec[j] = tf * idf[j];
-            norm += tfidfVec[j] * tfidfVec[j];
-        }
-        
-        // L2 normalization
-        norm = std::sqrt(norm);
-        if (norm > 1e-10) {
-            for (int j = 0; j < vocabSize; ++j) {
-                tfidfVec[j] /= norm;
-            }
-        }
-        
-        tfidfVectors.push_back(tfidfVec);
+
+    double norm = DenseKernels::norm(v.values.data(), v.values.size());
+    if (norm > 1e-10) DenseKernels::scale(1.0 / norm, v.values.data(), v.values.size());
+    return v;
+}
+
+void VSM::toTFIDFSparse(const SparseVector &counts, SparseVector &out) const {
+    out.clear();
+    for (size_t k = 0; k < counts.nnz(); ++k) {
+        int j = counts.indices[k];
+        if (j < 0 || j >= (int)idf.size() || counts.values[k] == 0.0 || idf[j] == 0.0) continue;
+        out.indices.push_back(j);
+        out.values.push_back(counts.values[k] * idf[j]);
     }
-    
-    return tfidfVectors;
+
+    double norm = DenseKernels::norm(out.values.data(), out.values.size());
+    if (norm > 1e-10) DenseKernels::scale(1.0 / norm, out.values.data(), out.values.size());
 }
 
 void VSM::trainFromVectors(const std::vector<std::vector<int>> &vectors, 
                            const std::vector<std::string> &labels) {
-    classes.clear();
-    classCentroids.clear();
-    
-    // Compute TF-IDF vectors
-    std::vector<std::vector<double>> tfidfVecs = computeTFIDF(vectors);
-    trainVectors = tfidfVecs;
-    trainLabels = labels;
-    
+    METRIC_TIMER("vsm_train");
     int numDocs = (int)vectors.size();
-    if (numDocs == 0) return;
-    
-    int vecSize = (int)vectors[0].size();
+    int vecSize = numDocs > 0 ? (int)vectors[0].size() : 0;
     
     // Find unique classes
+    std::vector<std::string> classList;
     for (int i = 0; i < numDocs; ++i) {
         const std::string &c = labels[i];
         bool found = false;
-        for (size_t j = 0; j < classes.size(); ++j) {
-            if (classes[j] == c) {
+        for (size_t j = 0; j < classList.size(); ++j) {
+            if (classList[j] == c) {
                 found = true;
                 break;
             }
         }
-        if (!found) classes.push_back(c);
+        if (!found) classList.push_back(c);
     }
-    
-    // Compute centroids for each class
-    for (size_t c = 0; c < classes.size(); ++c) {
-        std::vector<double> centroid(vecSize, 0.0);
-        int count = 0;
-        
-        for (int i = 0; i < numDocs; ++i) {
-            if (labels[i] == classes[c]) {
-                for (int j = 0; j < vecSize; ++j) {
-                    centroid[j] += tfidfVecs[i][j];
-                }
-                count++;
-            }
+    initModel(classList, vecSize);
+    if (numDocs == 0) return;
+
+    // Fold every document into the df counts and class sums, then derive IDF and centroids
+    trainClassIds.assign(numDocs, 0);
+    SparseVector counts;
+    for (int i = 0; i < numDocs; ++i) {
+        trainClassIds[i] = (int)(std::find(classes.begin(), classes.end(), labels[i]) - classes.begin());
+        counts.clear();
+        for (int j = 0; j < vecSize; ++j) {
+            if (vectors[i][j] == 0) continue;
+            counts.indices.push_back(j);
+            counts.values.push_back((double)vectors[i][j]);
         }
-        
-        if (count > 0) {
-            for (int j = 0; j < vecSize; ++j) {
-                centroid[j] /= (double)count;
-            }
+        addDocument(counts, trainClassIds[i]);
+    }
+    refreshCentroids();
+
+    // kNN index over the unit-length TF-IDF documents
+    std::vector<SparseVector> sparseDocs(numDocs);
+    for (int i = 0; i < numDocs; ++i) sparseDocs[i] = toTFIDFSparse(vectors[i]);
+    knnIndex.build(sparseDocs, vecSize);
+}
+
+void VSM::initModel(const std::vector<std::string> &classList, int numFeatures) {
+    classes = classList;
+    classCentroids.clear();
+    for (size_t c = 0; c < classes.size(); ++c) classCentroids[classes[c]] = std::vector<double>();
+    centroidNorms.assign(classes.size(), 0.0);
+    idf.clear();
+    trainClassIds.clear();
+    knnIndex.clear();
+
+    docCount = 0;
+    docFreq.clear();
+    classDocCounts.clear();
+    termClassSums.clear();
+    normSq.clear();
+    normLogDf.clear();
+    normLogDfSq.clear();
+    growModel((int)classes.size(), numFeatures);
+}
+
+void VSM::growModel(int numClasses, int numFeatures) {
+    int oldClasses = (int)classDocCounts.size();
+    int oldFeatures = (int)docFreq.size();
+    numClasses = std::max(numClasses, oldClasses);
+    numFeatures = std::max(numFeatures, oldFeatures);
+
+    if (numClasses != oldClasses) {
+        // the table is term-major, so a new class changes the row stride
+        std::vector<double> table((size_t)numFeatures * numClasses, 0.0);
+        for (int t = 0; t < oldFeatures; ++t) {
+            std::copy(termClassSums.begin() + (size_t)t * oldClasses, termClassSums.begin() + (size_t)(t + 1) * oldClasses,
+                      table.begin() + (size_t)t * numClasses);
         }
-        
-        classCentroids[classes[c]] = centroid;
+        termClassSums.swap(table);
+    } else {
+        termClassSums.resize((size_t)numFeatures * numClasses, 0.0);
     }
+    docFreq.resize(numFeatures, 0);
+    classDocCounts.resize(numClasses, 0);
+    normSq.resize(numClasses, 0.0);
+    normLogDf.resize(numClasses, 0.0);
+    normLogDfSq.resize(numClasses, 0.0);
 }
 
-std::string VSM::predict(const std::vector<int> &vector) {
-    // Convert count vector to TF-IDF
-    std::vector<std::vector<int>> tempVec;
-    tempVec.push_back(vector);
-    std::vector<std::vector<double>> tfidfVec = computeTFIDF(tempVec);
-    
-    if (tfidfVec.empty() || tfidfVec[0].empty()) return "";
-    
-    double bestSim = -2.0;
-    std::string bestClass = "";
-    
-    for (size_t i = 0; i < classes.size(); ++i) {
-        const std::string &c = classes[i];
-        if (classCentroids.find(c) != classCentroids.end()) {
-            double sim = cosineSimilarity(tfidfVec[0], classCentroids[c]);
-            if (sim > bestSim) {
-                bestSim = sim;
-                bestClass = c;
-            }
+void VSM::addNormTerms(int term, double sign) {
+    if (docFreq[term] == 0) return;
+    size_t numClasses = classDocCounts.size();
+    double g = std::log((double)docFreq[term]);
+    const double *row = &termClassSums[(size_t)term * numClasses];
+    for (size_t c = 0; c < numClasses; ++c) {
+        double s2 = sign * row[c] * row[c];
+        normSq[c] += s2;
+        normLogDf[c] += g * s2;
+        normLogDfSq[c] += g * g * s2;
+    }
+}
+
+double VSM::classSumNorm(int classId) const {
+    if (docCount == 0) return 0.0;
+    double logN = std::log((double)docCount);
+    double sq = logN * logN * normSq[classId] - 2.0 * logN * normLogDf[classId] + normLogDfSq[classId];
+    return sq > 0.0 ? std::sqrt(sq) : 0.0;
+}
+
+void VSM::addDocument(const SparseVector &counts, int classId) {
+    if (classId < 0 || classId >= (int)classDocCounts.size()) return;
+    size_t numClasses = classDocCounts.size();
+    int width = (int)docFreq.size();
+
+    double norm = DenseKernels::norm(counts.values.data(), counts.values.size());
+    docCount++;
+    classDocCounts[classId]++;
+    if (norm <= 1e-10) return;
+
+    // a term's df and sum change together, so its norm share is swapped out and back in
+    for (size_t k = 0; k < counts.nnz(); ++k) {
+        int t = counts.indices[k];
+        if (t < 0 || t >= width || counts.values[k] == 0.0) continue;
+        addNormTerms(t, -1.0);
+        docFreq[t]++;
+        termClassSums[(size_t)t * numClasses + classId] += counts.values[k] / norm;
+        addNormTerms(t, 1.0);
+    }
+}
+
+void VSM::partialFit(const std::vector<SparseVector> &counts,
+                     const std::vector<std::string> &labels, int numFeatures) {
+    METRIC_TIMER("vsm_partial_fit");
+    size_t numDocs = std::min(counts.size(), labels.size());
+    for (size_t i = 0; i < numDocs; ++i) {
+        if (std::find(classes.begin(), classes.end(), labels[i]) != classes.end()) continue;
+        classes.push_back(labels[i]);
+        // zero centroid as wide as the dense view, so dense scoring is safe before refreshCentroids()
+        classCentroids[labels[i]] = std::vector<double>(idf.size(), 0.0);
+        centroidNorms.push_back(0.0);
+    }
+    growModel((int)classes.size(), numFeatures);
+
+    for (size_t i = 0; i < numDocs; ++i) {
+        addDocument(counts[i], (int)(std::find(classes.begin(), classes.end(), labels[i]) - classes.begin()));
+    }
+    METRIC_COUNT("vsm_partial_fit_docs", numDocs);
+}
+
+void VSM::refreshCentroids() {
+    int numFeatures = (int)docFreq.size();
+    size_t numClasses = classDocCounts.size();
+
+    idf.assign(numFeatures, 0.0);
+    for (int t = 0; t < numFeatures; ++t) {
+        if (docFreq[t] > 0) idf[t] = std::log((double)docCount / (double)docFreq[t]);
+    }
+
+    // exact norm sums, so rounding from many incremental updates does not build up
+    normSq.assign(numClasses, 0.0);
+    normLogDf.assign(numClasses, 0.0);
+    normLogDfSq.assign(numClasses, 0.0);
+    for (int t = 0; t < numFeatures; ++t) addNormTerms(t, 1.0);
+
+    // centroids are class means, in the same TF-IDF space as toTFIDF
+    centroidNorms.assign(numClasses, 0.0);
+    for (size_t c = 0; c < numClasses; ++c) {
+        std::vector<double> &centroid = classCentroids[classes[c]];
+        centroid.assign(numFeatures, 0.0);
+        if (classDocCounts[c] == 0) continue;
+        double scale = 1.0 / (double)classDocCounts[c];
+        for (int t = 0; t < numFeatures; ++t) {
+            centroid[t] = idf[t] * termClassSums[(size_t)t * numClasses + c] * scale;
         }
+        centroidNorms[c] = DenseKernels::norm(centroid.data(), numFeatures);
     }
-    
-    if (bestClass == "" && classes.size() > 0) bestClass = classes[0];
-    return bestClass;
+}
+
+std::string VSM::predict(const std::vector<int> &vector) const {
+    // Gather the non-zero counts; scoring then reads only those terms' rows of the term table.
+    // Terms are bounded by centroidScores against the live df counts, not the refreshed IDF view.
+    SparseVector counts;
+    for (size_t j = 0; j < vector.size(); ++j) {
+        if (vector[j] == 0) continue;
+        counts.indices.push_back((int)j);
+        counts.values.push_back((double)vector[j]);
+    }
+    return predictSparse(counts);
+}
+
+void VSM::centroidScores(const SparseVector &counts, std::vector<double> &scores) const {
+    size_t numClasses = classes.size();
+    scores.assign(numClasses, 0.0);
+    if (docCount == 0) return;
+    double queryNorm = 0.0;
+
+    // IDF from the current counts; the centroid weight of t is idf(t) * sum, so it enters twice
+    for (size_t k = 0; k < counts.nnz(); ++k) {
+        int t = counts.indices[k];
+        if (t < 0 || t >= (int)docFreq.size() || docFreq[t] == 0 || counts.values[k] == 0.0) continue;
+        double termIdf = std::log((double)docCount / (double)docFreq[t]);
+        double q = counts.values[k] * termIdf;
+        queryNorm += q * q;
+        const double *row = &termClassSums[(size_t)t * numClasses];
+        for (size_t c = 0; c < numClasses; ++c) scores[c] += q * termIdf * row[c];
+    }
+
+    queryNorm = std::sqrt(queryNorm);
+    for (size_t c = 0; c < numClasses; ++c) {
+        double norm = queryNorm * classSumNorm((int)c);
+        scores[c] = norm > 1e-10 ? scores[c] / norm : 0.0;
+    }
+}
+
+std::string VSM::predictSparse(const SparseVector &counts) const {
+    int id = predictSparseId(counts);
+    return id < 0 ? "" : classes[id];
+}
+
+int VSM::predictSparseId(const SparseVector &counts) const {
+    METRIC_TIMER("vsm_predict");
+    if (classes.empty()) return -1;
+
+    std::vector<double> &scores = scoreScratch;
+    centroidScores(counts, scores);
+
+    // first class wins ties, as with the dense scan
+    return (int)(std::max_element(scores.begin(), scores.end()) - scores.begin());
 }
 
 double VSM::accuracy(const std::vector<std::vector<int>> &vectors, 
-                     const std::vector<std::string> &labels) {
+                     const std::vector<std::string> &labels) const {
     int n = (int)vectors.size();
     if (n == 0) return 0.0;
     
@@ -172,3 +315,134 @@ double VSM::accuracy(const std::vector<std::vector<int>> &vectors,
     
     return (double)correct / (double)n;
 }
+
+void VSM::knnScores(const std::vector<int> &vector, std::vector<double> &scores) const {
+    scores.assign(classes.size(), 0.0);
+    std::vector<KnnIndex::Neighbor> neighbors;
+    knnIndex.search(toTFIDFSparse(vector), knnK, neighbors);
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+        scores[trainClassIds[neighbors[i].doc]] += neighbors[i].score;
+    }
+}
+
+std::string VSM::predictKnn(const std::vector<int> &vector) const {
+    METRIC_TIMER("vsm_knn_predict");
+    std::vector<double> scores;
+    knnScores(vector, scores);
+    if (scores.empty()) return "";
+
+    size_t best = std::max_element(scores.begin(), scores.end()) - scores.begin();
+    if (scores[best] > 0.0) return classes[best];
+
+    // no neighbour shares a term with the query
+    BatchPrediction centroid = predictBatch(&vector, 1);
+    return centroid.label(0);
+}
+
+int VSM::predictKnnId(const SparseVector &counts) const {
+    METRIC_TIMER("vsm_knn_predict");
+    if (classes.empty()) return -1;
+
+    toTFIDFSparse(counts, queryScratch);
+    knnIndex.search(queryScratch, knnK, neighborScratch);
+    std::vector<double> &scores = scoreScratch;
+    scores.assign(classes.size(), 0.0);
+    for (size_t i = 0; i < neighborScratch.size(); ++i) {
+        scores[trainClassIds[neighborScratch[i].doc]] += neighborScratch[i].score;
+    }
+
+    size_t best = std::max_element(scores.begin(), scores.end()) - scores.begin();
+    if (scores[best] > 0.0) return (int)best;
+
+    // no neighbour shares a term with the query
+    return predictSparseId(counts);
+}
+
+void VSM::setKnnParameters(int k, double pruneFactor) {
+    knnK = k < 1 ? 1 : k;
+    knnIndex.setPruneFactor(pruneFactor);
+}
+
+const KnnIndex &VSM::getKnnIndex() const {
+    return knnIndex;
+}
+
+size_t VSM::termTableSizeBytes() const {
+    return termClassSums.size() * sizeof(double) + docFreq.size() * sizeof(int);
+}
+
+int VSM::getDocumentCount() const {
+    return docCount;
+}
+
+BatchPrediction VSM::predictBatch(const std::vector<int> *docs, size_t count) const {
+    METRIC_TIMER("vsm_predict_batch");
+    BatchPrediction result;
+    result.resize(count, classes);
+    size_t numClasses = classes.size();
+    if (count == 0 || numClasses == 0) return result;
+
+    size_t width = idf.size();
+    // a centroid narrower than the IDF view (not refreshed yet) scores 0
+    std::vector<const double *> centroid(numClasses, (const double *)0);
+    for (size_t c = 0; c < numClasses; ++c) {
+        const std::vector<double> &row = classCentroids.find(classes[c])->second;
+        if (row.size() >= width) centroid[c] = row.data();
+    }
+
+    std::vector<std::vector<double> > block(BATCH_DOC_BLOCK);
+    for (size_t d0 = 0; d0 < count; d0 += BATCH_DOC_BLOCK) {
+        size_t d1 = std::min(count, d0 + BATCH_DOC_BLOCK);
+        for (size_t d = d0; d < d1; ++d) block[d - d0] = toTFIDF(docs[d]);
+
+        for (size_t f0 = 0; f0 < width; f0 += BATCH_FEATURE_BLOCK) {
+            size_t f1 = std::min(width, f0 + BATCH_FEATURE_BLOCK);
+            for (size_t c = 0; c < numClasses; ++c) {
+                const double *cc = centroid[c];
+                if (!cc) continue;
+                for (size_t d = d0; d < d1; ++d) {
+                    const double *x = block[d - d0].data();
+                    result.scores[d * numClasses + c] += DenseKernels::dot(x + f0, cc + f0, f1 - f0);
+                }
+            }
+        }
+
+        // documents are unit length, so only the centroid norm is left to divide out
+        for (size_t d = d0; d < d1; ++d) {
+            for (size_t c = 0; c < numClasses; ++c) {
+                double &s = result.scores[d * numClasses + c];
+                s = !centroid[c] || centroidNorms[c] < 1e-10 ? 0.0 : s / centroidNorms[c];
+            }
+        }
+    }
+
+    result.computeArgmax();
+    METRIC_COUNT("vsm_predict_batch_docs", count);
+    return result;
+}
+
+BatchPrediction VSM::predictBatch(const std::vector<std::vector<int>> &docs) const {
+    return predictBatch(docs.data(), docs.size());
+}
+
+const std::vector<std::string> &VSM::getClasses() const {
+    return classes;
+}
+
+const std::vector<double> &VSM::getCentroid(const std::string &className) const {
+    static const std::vector<double> empty;
+    std::map<std::string, std::vector<double>>::const_iterator it = classCentroids.find(className);
+    if (it == classCentroids.end()) return empty;
+    return it->second;
+}
+
+double VSM::getCentroidNorm(const std::string &className) const {
+    for (size_t c = 0; c < classes.size() && c < centroidNorms.size(); ++c) {
+        if (classes[c] == className) return centroidNorms[c];
+    }
+    return 0.0;
+}
+
+const std::vector<double> &VSM::getIDF() const {
+    return idf;
+}
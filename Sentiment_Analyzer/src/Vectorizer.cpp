@@ -1,56 +1,309 @@
 #include "../include/Vectorizer.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+#include <map>
+#include <cmath>
 
 
-Vectorizer::Vectorizer() {
+Vectorizer::Vectorizer() : hotSize(0) {
     vocabulary.clear();
+    wordIndex.clear();
 }
 
-int Vectorizer::find_in_vocab(const std::string &word) {
+int Vectorizer::find_in_vocab(const std::string &word) const {
+    if (hotSize > 0) {
+        std::unordered_map<std::string, int>::const_iterator hot = hotIndex.find(word);
+        if (hot != hotIndex.end()) return hot->second;
+    }
+
+    std::unordered_map<std::string, int>::const_iterator it = wordIndex.find(word);
+    if (it == wordIndex.end()) return -1;
+    return it->second;
+}
 
-    for (size_t i = 0; i < vocabulary.size(); ++i) {
-        if (vocabulary[i] == word) return (int)i;
+void Vectorizer::rebuildIndex() {
+    hotSize = std::min(hotSize, (int)vocabulary.size());
+    hotIndex.clear();
+    hotIndex.reserve(hotSize);
+    for (int i = 0; i < hotSize; ++i) hotIndex[vocabulary[i]] = i;
+
+    wordIndex.clear();
+    wordIndex.reserve(vocabulary.size() - hotSize);
+    for (size_t i = hotSize; i < vocabulary.size(); ++i) {
+        wordIndex[vocabulary[i]] = (int)i;
     }
-    return -1;
 }
 
 void Vectorizer::buildVocabulary(const std::vector<std::vector<std::string>> &documents) {
+    METRIC_TIMER("build_vocabulary");
 
     vocabulary.clear();
+    wordIndex.clear();
+    hotIndex.clear();
+    hotSize = 0;
     for (size_t i = 0; i < documents.size(); ++i) {
         const std::vector<std::string> &tokens = documents[i];
 
         for (size_t j = 0; j < tokens.size(); ++j) {
             const std::string &w = tokens[j];
             if (find_in_vocab(w) == -1) {
+                wordIndex[w] = (int)vocabulary.size();
                 vocabulary.push_back(w);
             }
         }
     }
 }
 
+size_t Vectorizer::extendVocabulary(const std::vector<std::vector<std::string>> &documents) {
+    size_t before = vocabulary.size();
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const std::vector<std::string> &tokens = documents[i];
+
+        for (size_t j = 0; j < tokens.size(); ++j) {
+            const std::string &w = tokens[j];
+            if (find_in_vocab(w) == -1) {
+                wordIndex[w] = (int)vocabulary.size();
+                vocabulary.push_back(w);
+            }
+        }
+    }
+    return vocabulary.size() - before;
+}
+
 // Create bag-of-words count vector for a single token list
-std::vector<int> Vectorizer::transformSingle(const std::vector<std::string> &tokens) {
+std::vector<int> Vectorizer::transformSingle(const std::vector<std::string> &tokens) const {
+    METRIC_TIMER("vectorize");
     std::vector<int> vec;
     vec.assign(vocabulary.size(), 0);
 
     for (size_t t = 0; t < tokens.size(); ++t) {
         int idx = find_in_vocab(tokens[t]);
         if (idx != -1) {
-            vec[idx] += 1; 
+            vec[idx] += 1;
         }
     }
+    METRIC_COUNT("vectorize_tokens", tokens.size());
     return vec;
 }
 
 // Transform multiple documents
-std::vector<std::vector<int>> Vectorizer::transform(const std::vector<std::vector<std::string>> &documents) {
-    std::vector<std::vector<int>> matrix;
-    for (size_t i = 0; i < documents.size(); ++i) {
-        matrix.push_back(transformSingle(documents[i]));
-    }
+std::vector<std::vector<int>> Vectorizer::transform(const std::vector<std::vector<std::string>> &documents) const {
+    std::vector<std::vector<int>> matrix(documents.size());
+    ThreadPool::shared().parallelFor(0, documents.size(), 0, [this, &documents, &matrix](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) matrix[i] = transformSingle(documents[i]);
+    });
     return matrix;
 }
 
-std::vector<std::string> Vectorizer::getVocabulary() {
+// Sparse bag-of-words counts, indices sorted by word id
+SparseVector Vectorizer::transformSparse(const std::vector<std::string> &tokens) const {
+    SparseVector vec;
+    transformSparse(tokens.data(), tokens.size(), vec);
+    return vec;
+}
+
+void Vectorizer::transformSparse(const std::string *tokens, size_t count, SparseVector &out) const {
+    // ids go straight into out.indices and are run-length merged in place
+    out.clear();
+    std::vector<int> &ids = out.indices;
+    for (size_t t = 0; t < count; ++t) {
+        int idx = find_in_vocab(tokens[t]);
+        if (idx != -1) ids.push_back(idx);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    size_t unique = 0;
+    for (size_t i = 0; i < ids.size(); ) {
+        size_t j = i;
+        while (j < ids.size() && ids[j] == ids[i]) j++;
+        ids[unique++] = ids[i];
+        out.values.push_back((double)(j - i));
+        i = j;
+    }
+    ids.resize(unique);
+}
+
+void Vectorizer::setVocabulary(const std::vector<std::string> &words) {
+    vocabulary = words;
+    hotSize = 0;
+    rebuildIndex();
+}
+
+std::vector<std::string> Vectorizer::getVocabulary() const {
     return vocabulary;
 }
+
+int Vectorizer::getVocabularySize() const {
+    return (int)vocabulary.size();
+}
+
+int Vectorizer::getWordId(const std::string &word) const {
+    return find_in_vocab(word);
+}
+
+std::vector<int> Vectorizer::pruneVocabulary(const std::vector<std::vector<std::string>> &documents,
+                                             const std::vector<std::string> &labels,
+                                             const PruneOptions &options) {
+    METRIC_TIMER("prune_vocabulary");
+    int V = (int)vocabulary.size();
+    int N = (int)documents.size();
+
+    // class ids in first-seen order
+    std::map<std::string, int> classIds;
+    for (int i = 0; i < N; ++i) {
+        if (classIds.find(labels[i]) == classIds.end()) {
+            int next = (int)classIds.size();
+            classIds[labels[i]] = next;
+        }
+    }
+    int C = (int)classIds.size();
+
+    // document frequency per term and per (term, class); counts per term for SELECT_FREQUENCY
+    std::vector<int> docFreq(V, 0);
+    std::vector<int> termFreq(V, 0);
+    std::vector<int> classDocFreq((size_t)V * C, 0);
+    std::vector<int> docsInClass(C, 0);
+    std::vector<int> lastSeen(V, -1);
+
+    for (int i = 0; i < N; ++i) {
+        int c = classIds[labels[i]];
+        docsInClass[c]++;
+        const std::vector<std::string> &tokens = documents[i];
+        for (size_t t = 0; t < tokens.size(); ++t) {
+            int id = find_in_vocab(tokens[t]);
+            if (id == -1) continue;
+            termFreq[id]++;
+            if (lastSeen[id] != i) {
+                lastSeen[id] = i;
+                docFreq[id]++;
+                classDocFreq[(size_t)id * C + c]++;
+            }
+        }
+    }
+
+    // document-frequency filters
+    std::vector<int> candidates;
+    for (int v = 0; v < V; ++v) {
+        if (docFreq[v] < options.minDf) continue;
+        if (N > 0 && (double)docFreq[v] / (double)N > options.maxDfRatio) continue;
+        candidates.push_back(v);
+    }
+
+    // score and keep the top-k candidates
+    if (options.topK > 0 && (int)candidates.size() > options.topK) {
+        std::vector<double> score(V, 0.0);
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            int v = candidates[k];
+
+            if (options.selection == SELECT_FREQUENCY) {
+                score[v] = (double)termFreq[v];
+            }
+            else if (options.selection == SELECT_CHI_SQUARED) {
+                // max over classes of the 2x2 presence/class chi-squared statistic
+                double best = 0.0;
+                for (int c = 0; c < C; ++c) {
+                    double a = classDocFreq[(size_t)v * C + c];   // term, class
+                    double b = docFreq[v] - a;                    // term, other class
+                    double cc = docsInClass[c] - a;               // no term, class
+                    double d = N - a - b - cc;                    // no term, other class
+                    double denom = (a + cc) * (b + d) * (a + b) * (cc + d);
+                    if (denom <= 0.0) continue;
+                    double chi = (double)N * (a * d - cc * b) * (a * d - cc * b) / denom;
+                    if (chi > best) best = chi;
+                }
+                score[v] = best;
+            }
+            else {
+                // expected mutual information between term presence and class
+                double mi = 0.0;
+                double pT = (double)docFreq[v] / (double)N;
+                for (int c = 0; c < C; ++c) {
+                    double pC = (double)docsInClass[c] / (double)N;
+                    double n11 = classDocFreq[(size_t)v * C + c];
+                    double n01 = docsInClass[c] - n11;
+                    double p11 = n11 / (double)N;
+                    double p01 = n01 / (double)N;
+                    if (p11 > 0.0) mi += p11 * std::log(p11 / (pT * pC));
+                    if (p01 > 0.0) mi += p01 * std::log(p01 / ((1.0 - pT) * pC));
+                }
+                score[v] = mi;
+            }
+        }
+
+        // highest score first, ties broken by original id for determinism
+        std::vector<std::pair<double, int> > ranked;
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            ranked.push_back(std::make_pair(-score[candidates[k]], candidates[k]));
+        }
+        std::sort(ranked.begin(), ranked.end());
+
+        candidates.clear();
+        for (int k = 0; k < options.topK; ++k) candidates.push_back(ranked[k].second);
+        std::sort(candidates.begin(), candidates.end());
+    }
+
+    // compact renumbering
+    std::vector<int> remap(V, -1);
+    std::vector<std::string> kept;
+    kept.reserve(candidates.size());
+    for (size_t k = 0; k < candidates.size(); ++k) {
+        remap[candidates[k]] = (int)kept.size();
+        kept.push_back(vocabulary[candidates[k]]);
+    }
+    vocabulary.swap(kept);
+    hotSize = 0;
+    rebuildIndex();
+
+    return remap;
+}
+
+std::vector<int> Vectorizer::orderByFrequency(const std::vector<std::vector<std::string>> &documents,
+                                              double hotCoverage) {
+    METRIC_TIMER("order_vocabulary");
+    int V = (int)vocabulary.size();
+    std::vector<long long> termFreq(V, 0);
+    long long totalTokens = 0;
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const std::vector<std::string> &tokens = documents[i];
+        for (size_t t = 0; t < tokens.size(); ++t) {
+            int id = find_in_vocab(tokens[t]);
+            if (id == -1) continue;
+            termFreq[id]++;
+            totalTokens++;
+        }
+    }
+
+    std::vector<int> order(V);
+    for (int v = 0; v < V; ++v) order[v] = v;
+    std::stable_sort(order.begin(), order.end(), [&termFreq](int a, int b) { return termFreq[a] > termFreq[b]; });
+
+    std::vector<int> remap(V, -1);
+    std::vector<std::string> ordered(V);
+    for (int k = 0; k < V; ++k) {
+        remap[order[k]] = k;
+        ordered[k] = vocabulary[order[k]];
+    }
+    vocabulary.swap(ordered);
+
+    // hot tier: the most frequent words until they cover hotCoverage of all tokens
+    hotSize = 0;
+    if (hotCoverage > 0.0) {
+        long long covered = 0;
+        while (hotSize < V && (double)covered < hotCoverage * (double)totalTokens) covered += termFreq[order[hotSize++]];
+    }
+    rebuildIndex();
+    return remap;
+}
+
+int Vectorizer::getHotSize() const {
+    return hotSize;
+}
+
+std::vector<std::string> Vectorizer::filterTokens(const std::vector<std::string> &tokens) const {
+    std::vector<std::string> kept;
+    for (size_t t = 0; t < tokens.size(); ++t) {
+        if (find_in_vocab(tokens[t]) != -1) kept.push_back(tokens[t]);
+    }
+    return kept;
+}
@@ -5,58 +5,55 @@
 #include <iomanip>
 #include <cctype>
 #include <algorithm>
+#include <thread>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
 
 #include "../include/Preprocessor.hpp"
 #include "../include/Vectorizer.hpp"
 #include "../include/NaiveBayes.hpp"
 #include "../include/VSM.hpp"
 #include "../include/LogisticRegression.hpp"
+#include "../include/HashingVectorizer.hpp"
+#include "../include/EnsemblePredictor.hpp"
 #include "../include/ModelEvaluator.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/Benchmarks.hpp"
+#include "../include/CsvStream.hpp"
+#include "../include/StreamingTrainer.hpp"
+#include "../include/CorpusCache.hpp"
+#include "../include/LazyEvaluation.hpp"
+#include "../include/ModelSnapshot.hpp"
+#include "../include/ScoringPipeline.hpp"
+#include "../include/ThreadPool.hpp"
+#include "../include/FastMath.hpp"
+#include "../include/SparseLogisticRegression.hpp"
+#include "../include/ModelHeaderExporter.hpp"
+#include "../include/CountMinNaiveBayes.hpp"
+#include "../include/PredictionCache.hpp"
+#include <memory>
+#include <chrono>
+#include <unordered_map>
 
 // Simple CSV loader: expects header line, then each line text,label
 void loadCSV(const std::string &path, std::vector<std::string> &texts, std::vector<std::string> &labels) {
+    METRIC_TIMER("load_csv");
     texts.clear();
     labels.clear();
-    std::ifstream infile(path.c_str());
+    CsvStream csv(path);
 
-    if (!infile.is_open()) {
+    if (!csv.isOpen()) {
         std::cerr << "Error: could not open file: " << path << std::endl;
         return;
     }
 
-    std::string line;
-    bool first = true;
-
-    while (std::getline(infile, line)) 
-    {
-        if (first) { 
-            first = false; continue; // skip header
-        } 
-
-        int pos = -1;
-        for (int i = (int)line.size() - 1; i >= 0; --i) {
-            if (line[i] == ',') { 
-                pos = i; break; 
-            }
-        }
-        if (pos == -1) continue;
-
-        std::string text = line.substr(0, pos);
-        std::string label = line.substr(pos + 1);
-        
-        // trim spaces from label
-        size_t s = 0;
-        while (s < label.size() && (label[s] == ' ' || label[s] == '\t' || label[s] == '\r' || label[s] == '\n')) s++;
-        size_t e = label.size();
-
-        while (e > s && (label[e-1] == ' ' || label[e-1] == '\t' || label[e-1] == '\r' || label[e-1] == '\n')) e--;
-        if (e > s) label = label.substr(s, e - s);
-        else label = "";
-
+    std::string text, label;
+    while (csv.next(text, label)) {
         texts.push_back(text);
         labels.push_back(label);
     }
-    infile.close();
+    METRIC_COUNT("load_csv_rows", texts.size());
 }
 
 bool isValidInput(const std::string &input) {
@@ -84,11 +81,42 @@ void displayMainMenu() {
     std::cout << "║          EMOTION DETECTOR - MAIN MENU                 ║" << std::endl;
     std::cout << "╠═══════════════════════════════════════════════════════╣" << std::endl;
     std::cout << "║ 1. Train and Evaluate All Models                      ║" << std::endl;
-    std::cout << "║ 2. Predict Emotion from User Input                    ║" << std::endl;
-    std::cout << "║ 3. View Detailed Performance Report                   ║" << std::endl;
-    std::cout << "║ 4. Exit                                               ║" << std::endl;
+    std::cout << "║ 2. Train Models Only (Metrics On Demand)              ║" << std::endl;
+    std::cout << "║ 3. Predict Emotion from User Input                    ║" << std::endl;
+    std::cout << "║ 4. View Detailed Performance Report                   ║" << std::endl;
+    std::cout << "║ 5. Export Runtime Metrics                             ║" << std::endl;
+    std::cout << "║ 6. Performance & Model Tools                          ║" << std::endl;
+    std::cout << "║ 7. Exit                                               ║" << std::endl;
+    std::cout << "╚═══════════════════════════════════════════════════════╝" << std::endl;
+    std::cout << "Select option (1-7): ";
+
+}
+
+void displayToolsMenu() {
+
+    std::cout << "\n╔═══════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║          PERFORMANCE & MODEL TOOLS                    ║" << std::endl;
+    std::cout << "╠═══════════════════════════════════════════════════════╣" << std::endl;
+    std::cout << "║ 1. Vocabulary Pruning Benchmark                       ║" << std::endl;
+    std::cout << "║ 2. Quantized (int8 / fp16) Model Drift Check          ║" << std::endl;
+    std::cout << "║ 3. Fused Ensemble Benchmark                           ║" << std::endl;
+    std::cout << "║ 4. Scratch Arena Allocation Check                     ║" << std::endl;
+    std::cout << "║ 5. VSM kNN (WAND index) Benchmark                     ║" << std::endl;
+    std::cout << "║ 6. Out-of-Core Streaming Training                     ║" << std::endl;
+    std::cout << "║ 7. Snapshot Hot-Swap Serving Benchmark                ║" << std::endl;
+    std::cout << "║ 8. Batch Scoring Pipeline (CSV -> predictions CSV)    ║" << std::endl;
+    std::cout << "║ 9. Naive Bayes Count Shards (export / merge)          ║" << std::endl;
+    std::cout << "║ 10. Fast Math Kernels vs libm (accuracy / speed)      ║" << std::endl;
+    std::cout << "║ 11. Dense Linear Algebra Kernels Benchmark            ║" << std::endl;
+    std::cout << "║ 12. Sparse L1 / Elastic-Net LR (report / export)      ║" << std::endl;
+    std::cout << "║ 13. Incremental LR + VSM Update (partial fit)         ║" << std::endl;
+    std::cout << "║ 14. Export NB + LR as constexpr C++ Header            ║" << std::endl;
+    std::cout << "║ 15. Frequency-Ordered Vocabulary Ids Benchmark        ║" << std::endl;
+    std::cout << "║ 16. Count-Min Sketch Naive Bayes (bounded memory)     ║" << std::endl;
+    std::cout << "║ 17. Prediction Cache (benchmark / hit-rate stats)     ║" << std::endl;
+    std::cout << "║ 0. Back                                               ║" << std::endl;
     std::cout << "╚═══════════════════════════════════════════════════════╝" << std::endl;
-    std::cout << "Select option (1-4): ";
+    std::cout << "Select tool: ";
 
 }
 
@@ -97,18 +125,162 @@ void displayMainMenu() {
 NaiveBayes g_nb;
 VSM g_vsm;
 LogisticRegression g_lr(0.01, 100);
+LogisticRegression g_hashLr(0.01, 100);
+HashingVectorizer g_hashVec(18, 1, 3);   // word 1-3 grams in 2^18 buckets
+EnsemblePredictor g_ensemble;
 Vectorizer g_vec;
 Preprocessor g_pre;
 bool g_trained = false;
+ModelRegistry g_models;   // frozen copy of the models above that predictions are served from
+PredictionCache g_predictionCache;   // answers for repeated inputs, dropped on every publish
 
-ModelEvaluator::EvaluationMetrics g_nbMetrics, g_vsmMetrics, g_lrMetrics;
+// Training-set metrics, computed in the background or on first report
+LazyEvaluation g_nbEval, g_vsmEval, g_lrEval, g_hashLrEval, g_ensembleEval;
 std::vector<std::string> g_uniqueLabels;
+std::string g_noEvaluationReason = "streamed model";   // shown when a model has no training-set metrics
+
+// Tokenize the whole corpus with the global preprocessor, on the shared thread pool
+std::vector<std::vector<std::string>> tokenizeAll(const std::vector<std::string> &rawTexts) {
+    std::vector<std::vector<std::string>> docs(rawTexts.size());
+    ThreadPool::shared().parallelFor(0, rawTexts.size(), 0, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) docs[i] = g_pre.process(rawTexts[i]);
+    });
+    return docs;
+}
+
+// Helper: freeze the freshly trained models into a new snapshot and swap it in for serving
+void publishSnapshot() {
+    std::shared_ptr<ModelSnapshot> snapshot = std::make_shared<ModelSnapshot>();
+    snapshot->pre = g_pre;
+    snapshot->vec = g_vec;
+    snapshot->nb = g_nb;
+    snapshot->vsm = g_vsm;
+    snapshot->lr = g_lr;
+    snapshot->hashVec = g_hashVec;
+    snapshot->hashLr = g_hashLr;
+    snapshot->ensemble = g_ensemble;
+    unsigned long version = g_models.publish(snapshot);
+    g_predictionCache.invalidate();
+    std::cout << "[INFO] Serving model snapshot v" << version << std::endl;
+}
+
+// Vocabulary id order from EMOTION_VOCAB_ORDER: first-seen (default), frequency, or tiered
+// (frequency order plus a hot lookup tier covering 90% of the tokens)
+std::string vocabularyOrderMode() {
+    const char *env = std::getenv("EMOTION_VOCAB_ORDER");
+    std::string mode = env ? env : "";
+    return mode == "frequency" || mode == "tiered" ? mode : "first-seen";
+}
+
+// Helper: renumber g_vec ids for the chosen order; a no-op renumbering when they already follow it
+void applyVocabularyOrder(const std::string &mode, const std::vector<std::vector<std::string>> &docs) {
+    if (mode == "first-seen") return;
+    g_vec.orderByFrequency(docs, mode == "tiered" ? 0.9 : 0.0);
+    std::cout << "[INFO] Vocabulary ids ordered by frequency";
+    if (g_vec.getHotSize() > 0) std::cout << " (hot tier: " << g_vec.getHotSize() << " words)";
+    std::cout << std::endl;
+}
+
+// Helper: tokenized documents and count vectors, from <dataPath>.cache when it was built
+// from the same dataset, stopwords and preprocessing rules; otherwise rebuild and rewrite it
+void loadOrBuildCorpus(const std::vector<std::string> &rawTexts, const std::vector<std::string> &labels,
+                       const std::string &dataPath, const std::string &stopPath,
+                       std::vector<std::vector<std::string>> &docs,
+                       std::vector<std::vector<int>> &countVectors) {
+    std::string cachePath = dataPath + ".cache";
+    std::string order = vocabularyOrderMode();
+    std::string signature = g_pre.getConfigSignature();
+    if (order != "first-seen") signature += "|ids=" + order;   // default keeps existing caches valid
+    uint64_t key = CorpusCache::computeKey(dataPath, stopPath, signature);
+    size_t n = rawTexts.size();
+
+    CorpusCache cache;
+    bool hit = cache.open(cachePath, key) && cache.getDocumentCount() == n;
+    for (size_t i = 0; hit && i < n; ++i) {
+        if (cache.label(i) >= cache.getClasses().size() || cache.getClasses()[cache.label(i)] != labels[i]) hit = false;
+    }
+
+    if (hit) {
+        METRIC_TIMER("corpus_cache_load");
+        const std::vector<std::string> &vocab = cache.getVocabulary();
+        g_vec.setVocabulary(vocab);
+        docs.assign(n, std::vector<std::string>());
+        countVectors.assign(n, std::vector<int>(vocab.size(), 0));
+        for (size_t i = 0; i < n; ++i) {
+            const uint32_t *ids = cache.tokens(i);
+            size_t count = cache.tokenCount(i);
+            docs[i].reserve(count);
+            for (size_t t = 0; t < count; ++t) {
+                docs[i].push_back(vocab[ids[t]]);
+                countVectors[i][ids[t]]++;
+            }
+        }
+        applyVocabularyOrder(order, docs);
+        std::cout << "[INFO] Loaded preprocessed corpus from " << cachePath << std::endl;
+        return;
+    }
+
+    // Tokenize all documents
+    docs = tokenizeAll(rawTexts);
+
+    // Build vocabulary
+    g_vec.buildVocabulary(docs);
+    applyVocabularyOrder(order, docs);
+    countVectors = g_vec.transform(docs);
+
+    // CSR token ids + label ids for the next run
+    std::vector<std::string> vocab = g_vec.getVocabulary();
+    std::unordered_map<std::string, uint32_t> index;
+    for (size_t v = 0; v < vocab.size(); ++v) index[vocab[v]] = (uint32_t)v;
+    std::vector<std::vector<uint32_t>> ids(n);
+    std::vector<uint32_t> labelIds(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t t = 0; t < docs[i].size(); ++t) ids[i].push_back(index[docs[i][t]]);
+        labelIds[i] = (uint32_t)(std::find(g_uniqueLabels.begin(), g_uniqueLabels.end(), labels[i]) - g_uniqueLabels.begin());
+    }
+    if (CorpusCache::write(cachePath, key, vocab, g_uniqueLabels, ids, labelIds)) {
+        std::cout << "[INFO] Wrote preprocessed corpus cache to " << cachePath << std::endl;
+    }
+}
+
+// Helper: wait for / drop every model's pending evaluation before the models change
+void clearEvaluations() {
+    g_nbEval.clear();
+    g_vsmEval.clear();
+    g_lrEval.clear();
+    g_hashLrEval.clear();
+    g_ensembleEval.clear();
+}
 
-void trainModels(const std::vector<std::string> &rawTexts, const std::vector<std::string> &labels) {
+// Helper: labels of a BatchPrediction, one per row
+std::vector<std::string> batchLabels(const BatchPrediction &batch) {
+    std::vector<std::string> out;
+    out.reserve(batch.rows);
+    for (size_t i = 0; i < batch.rows; ++i) out.push_back(batch.label(i));
+    return out;
+}
+
+// Helper: one row of the training box with the time a stage took
+void printStageTime(double seconds) {
+    std::ostringstream line;
+    line << "   Trained in " << std::fixed << std::setprecision(2) << seconds << " s";
+    std::cout << "║ " << std::left << std::setw(53) << line.str() << " ║" << std::right << std::endl;
+}
+
+/**
+ * Train every model. With evaluate = true each model's training-set metrics
+ * are computed on a worker thread while the next model trains, and the
+ * comparison table is printed at the end; otherwise metrics are deferred
+ * until the report asks for them.
+ */
+void trainModels(const std::vector<std::string> &rawTexts, const std::vector<std::string> &labels,
+                 const std::string &dataPath, const std::string &stopPath, bool evaluate) {
     if (rawTexts.empty()) {
         std::cerr << "Error: No training data loaded.\n";
         return;
     }
+    METRIC_TIMER("train_models");
+    clearEvaluations();
 
     g_uniqueLabels.clear();
     for (size_t i = 0; i < labels.size(); ++i) {
@@ -122,67 +294,88 @@ void trainModels(const std::vector<std::string> &rawTexts, const std::vector<std
         std::cout << "  - " << emotion << std::endl;
     }
 
-    // Tokenize all documents
-    std::vector<std::vector<std::string>> docs;
-    for (size_t i = 0; i < rawTexts.size(); ++i) {
-        std::vector<std::string> toks = g_pre.process(rawTexts[i]);
-        docs.push_back(toks);
-    }
+    // Training data is shared with the evaluations, which may outlive this call
+    std::shared_ptr<std::vector<std::vector<std::string>>> docs = std::make_shared<std::vector<std::vector<std::string>>>();
+    std::shared_ptr<std::vector<std::vector<int>>> countVectors = std::make_shared<std::vector<std::vector<int>>>();
+    std::shared_ptr<std::vector<SparseVector>> hashedVectors = std::make_shared<std::vector<SparseVector>>();
+    std::shared_ptr<const std::vector<std::string>> sharedLabels = std::make_shared<const std::vector<std::string>>(labels);
 
-    // Build vocabulary
-    g_vec.buildVocabulary(docs);
+    // Tokenize and vectorize, or reuse the preprocessed corpus cache
+    loadOrBuildCorpus(rawTexts, labels, dataPath, stopPath, *docs, *countVectors);
     std::vector<std::string> vocab = g_vec.getVocabulary();
     
     std::cout << "[INFO] Vocabulary size: " << vocab.size() << " unique words\n" << std::endl;
-    
-    std::vector<std::vector<int>> countVectors = g_vec.transform(docs);
 
     std::cout << "╔═══════════════════════════════════════════════════════╗" << std::endl;
-    std::cout << "║        TRAINING ALL THREE ALGORITHMS                  ║" << std::endl;
+    std::cout << "║        TRAINING ALL ALGORITHMS                        ║" << std::endl;
     std::cout << "╠═══════════════════════════════════════════════════════╣" << std::endl;
+    std::chrono::steady_clock::time_point t0;
 
     
     // Train Naive Bayes
     std::cout << "║ 1. Training Naive Bayes...                            ║" << std::endl;
-    g_nb.trainFromDocuments(docs, labels, vocab);
-    std::vector<std::string> nbPredictions;
-
-    for (size_t i = 0; i < docs.size(); ++i) {
-        nbPredictions.push_back(g_nb.predict(docs[i]));
-    }
-    g_nbMetrics = ModelEvaluator::evaluate(nbPredictions, labels, g_uniqueLabels);
-    double nbAcc = g_nbMetrics.accuracy;
-    std::cout << "║    Accuracy: " << std::fixed << std::setprecision(2) << std::setw(38) << (nbAcc * 100.0) << "%   ║" << std::endl;
-
+    t0 = std::chrono::steady_clock::now();
+    g_nb.trainParallel(*docs, labels, vocab);
+    printStageTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    g_nbEval.schedule([docs]() { return batchLabels(g_nb.predictBatch(*docs)); },
+                      sharedLabels, g_uniqueLabels, evaluate);
 
-    // // Train Vector Space Model (VSM)
-    // std::cout << "║ 2. Training Vector Space Model (VSM)...               ║" << std::endl;
-    // g_vsm.trainFromVectors(countVectors, labels);
-    // std::vector<std::string> vsmPredictions;
 
-    // for (size_t i = 0; i < countVectors.size(); ++i) {
-    //     vsmPredictions.push_back(g_vsm.predict(countVectors[i]));
-    // }
-    // g_vsmMetrics = ModelEvaluator::evaluate(vsmPredictions, labels, g_uniqueLabels);
-    // double vsmAcc = g_vsmMetrics.accuracy;
-    // std::cout << "║    Accuracy: " << std::fixed << std::setprecision(2) << std::setw(38) << (vsmAcc * 100.0) << "%   ║" << std::endl;
+    // Train Vector Space Model (VSM)
+    std::cout << "║ 2. Training Vector Space Model (VSM)...               ║" << std::endl;
+    t0 = std::chrono::steady_clock::now();
+    g_vsm.trainFromVectors(*countVectors, labels);
+    printStageTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    g_vsmEval.schedule([countVectors]() { return batchLabels(g_vsm.predictBatch(*countVectors)); },
+                       sharedLabels, g_uniqueLabels, evaluate);
 
 
     // Train Logistic Regression
-    std::cout << "║ 2. Training Logistic Regression...                    ║" << std::endl;
-    g_lr.trainFromVectors(countVectors, labels);
-    std::vector<std::string> lrPredictions;
-
-    for (size_t i = 0; i < countVectors.size(); ++i) {
-        lrPredictions.push_back(g_lr.predict(countVectors[i]));
-    }
-    g_lrMetrics = ModelEvaluator::evaluate(lrPredictions, labels, g_uniqueLabels);
-    double lrAcc = g_lrMetrics.accuracy;
-    std::cout << "║    Accuracy: " << std::fixed << std::setprecision(2) << std::setw(38) << (lrAcc * 100.0) << "%   ║" << std::endl;
+    std::cout << "║ 3. Training Logistic Regression...                    ║" << std::endl;
+    t0 = std::chrono::steady_clock::now();
+    g_lr.trainFromVectors(*countVectors, labels);
+    printStageTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    g_lrEval.schedule([countVectors]() { return batchLabels(g_lr.predictBatch(*countVectors)); },
+                      sharedLabels, g_uniqueLabels, evaluate);
+
+    // Train Logistic Regression on hashed word n-grams (sparse, no vocabulary)
+    std::cout << "║ 4. Training Logistic Regression (hashed n-grams)...   ║" << std::endl;
+    t0 = std::chrono::steady_clock::now();
+    *hashedVectors = g_hashVec.transform(*docs, ThreadPool::shared().size());
+    g_hashLr.trainFromSparse(*hashedVectors, labels, g_hashVec.getDimension());
+    printStageTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    g_hashLrEval.schedule([hashedVectors]() { return batchLabels(g_hashLr.predictBatchSparse(*hashedVectors)); },
+                          sharedLabels, g_uniqueLabels, evaluate);
+
+    // Fuse NB + VSM + LR into one ensemble (weighted soft vote)
+    std::cout << "║ 5. Building fused ensemble (NB + VSM + LR)...         ║" << std::endl;
+    t0 = std::chrono::steady_clock::now();
+    g_ensemble.build(vocab, g_nb, g_lr, g_vsm);
+    printStageTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    g_ensembleEval.schedule([docs]() {
+                                std::vector<std::string> predictions(docs->size());
+                                ThreadPool::shared().parallelFor(0, docs->size(), 0, [&](size_t begin, size_t end) {
+                                    for (size_t i = begin; i < end; ++i) predictions[i] = g_ensemble.predict((*docs)[i]);
+                                });
+                                return predictions;
+                            },
+                            sharedLabels, g_uniqueLabels, evaluate);
     
     std::cout << "╚═══════════════════════════════════════════════════════╝" << std::endl;
+    g_trained = true;
+    publishSnapshot();
 
-    
+    if (!evaluate) {
+        std::cout << "[INFO] Models are ready. Training-set metrics will be computed when the report is opened." << std::endl;
+        return;
+    }
+
+    // waits for whichever background evaluations are still running
+    double nbAcc = g_nbEval.get().accuracy;
+    double vsmAcc = g_vsmEval.get().accuracy;
+    double lrAcc = g_lrEval.get().accuracy;
+    double hashLrAcc = g_hashLrEval.get().accuracy;
+    double ensembleAcc = g_ensembleEval.get().accuracy;
 
     std::cout << "\n╔═══════════════════════════════════════════════════════╗" << std::endl;
     std::cout << "║            ACCURACY COMPARISON TABLE                  ║" << std::endl;
@@ -190,17 +383,466 @@ void trainModels(const std::vector<std::string> &rawTexts, const std::vector<std
     std::cout << "║ Algorithm                  ║ Training Accuracy       ║" << std::endl;
     std::cout << "╠════════════════════════════╬═════════════════════════╣" << std::endl;
     std::cout << "║ Naive Bayes                ║ " << std::fixed << std::setprecision(2) << std::setw(19) << (nbAcc * 100.0) << "% ║" << std::endl;
-    //std::cout << "║ Vector Space Model (VSM)   ║ " << std::fixed << std::setprecision(2) << std::setw(19) << (vsmAcc * 100.0) << "% ║" << std::endl;
+    std::cout << "║ Vector Space Model (VSM)   ║ " << std::fixed << std::setprecision(2) << std::setw(19) << (vsmAcc * 100.0) << "% ║" << std::endl;
     std::cout << "║ Logistic Regression        ║ " << std::fixed << std::setprecision(2) << std::setw(19) << (lrAcc * 100.0) << "% ║" << std::endl;
+    std::cout << "║ LR (hashed n-grams)        ║ " << std::fixed << std::setprecision(2) << std::setw(19) << (hashLrAcc * 100.0) << "% ║" << std::endl;
+    std::cout << "║ Ensemble (NB+VSM+LR)       ║ " << std::fixed << std::setprecision(2) << std::setw(19) << (ensembleAcc * 100.0) << "% ║" << std::endl;
     std::cout << "╚════════════════════════════╩═════════════════════════╝" << std::endl;
+}
+
+// Helper: detailed report from the cached evaluation, computing it on first use
+void printModelReport(const std::string &name, const LazyEvaluation &eval) {
+    if (!eval.available()) {
+        std::cout << "[INFO] No training-set metrics for " << name << " (" << g_noEvaluationReason << ")\n";
+        return;
+    }
+    if (!eval.isReady()) {
+        std::cout << "[INFO] Computing metrics for " << name << "...\n";
+    }
+    ModelEvaluator::printDetailedReport(name, eval.get());
+}
+
+// Dump the current metrics snapshot as Prometheus text (stdout) and JSON (file)
+void exportMetrics() {
+    if (!Metrics::enabled()) {
+        std::cout << "\n[INFO] Metrics are compiled out. Rebuild with -DEMOTION_METRICS to enable them.\n";
+        return;
+    }
 
+    std::string jsonPath = "metrics.json";
+    std::ofstream out(jsonPath.c_str());
+    if (!out.is_open()) {
+        std::cerr << "Error: could not write metrics file: " << jsonPath << std::endl;
+    }
+    else {
+        out << Metrics::instance().toJSON();
+        out.close();
+    }
+
+    std::cout << "\n" << Metrics::instance().toPrometheus();
+    std::cout << "\n[INFO] JSON snapshot written to " << jsonPath << std::endl;
+}
+
+// Helper: prompt with a default value, empty input keeps the default
+std::string promptWithDefault(const std::string &question, const std::string &def) {
+    std::cout << question << " [" << def << "]: ";
+    std::string answer;
+    if (!std::getline(std::cin, answer) || answer.empty()) return def;
+    return answer;
+}
+
+void streamingTrain() {
+    std::string path = promptWithDefault("CSV path", "data/dataset.csv");
+    int budgetMb = std::atoi(promptWithDefault("Memory budget (MB)", "256").c_str());
+    int epochs = std::atoi(promptWithDefault("SGD epochs", "10").c_str());
+    if (budgetMb < 4) budgetMb = 4;
+
+    StreamingTrainer::Options options;
+    options.memoryBudgetBytes = (size_t)budgetMb << 20;
+    options.epochs = epochs;
+    StreamingTrainer trainer(options);
+    StreamingTrainer::Report report;
+
+    std::cout << "\n[INFO] Streaming " << path << " ..." << std::endl;
+    clearEvaluations();
+    g_noEvaluationReason = "streamed model";
+    if (!trainer.train(path, g_pre, g_vec, g_nb, g_vsm, g_lr, g_hashVec, g_hashLr, report)) return;
+    if (report.documents == 0) {
+        std::cerr << "Error: no documents in " << path << std::endl;
+        return;
+    }
+
+    g_uniqueLabels = g_nb.getClasses();
+    g_ensemble.build(g_vec.getVocabulary(), g_nb, g_lr, g_vsm);
     g_trained = true;
+    publishSnapshot();
+
+    std::cout << "\n╔═══════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║        OUT-OF-CORE TRAINING SUMMARY                   ║" << std::endl;
+    std::cout << "╠════════════════════════════╦══════════════════════════╣" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "║ Documents                  ║ " << std::right << std::setw(24) << report.documents << " ║" << std::endl;
+    std::cout << "║ Vocabulary                 ║ " << std::setw(24) << report.vocabularySize << " ║" << std::endl;
+    std::cout << "║ CSV read (MB)              ║ " << std::setw(24) << report.csvBytes / 1048576.0 << " ║" << std::endl;
+    std::cout << "║ Sparse cache (MB)          ║ " << std::setw(24) << report.cacheBytes / 1048576.0 << " ║" << std::endl;
+    std::cout << "║ Chunks                     ║ " << std::setw(24) << report.chunks << " ║" << std::endl;
+    std::cout << "║ Peak chunk buffer (MB)     ║ " << std::setw(24) << report.peakChunkBytes / 1048576.0 << " ║" << std::endl;
+    std::cout << "║ Model accumulators (MB)    ║ " << std::setw(24) << report.modelBytes / 1048576.0 << " ║" << std::endl;
+    std::cout << "║ Pass 1 (s)                 ║ " << std::setw(24) << report.pass1Seconds << " ║" << std::endl;
+    for (size_t e = 0; e < report.epochAccuracy.size(); ++e) {
+        std::ostringstream name;
+        name << "Epoch " << (e + 1) << " LR / hashed / s";
+        std::ostringstream value;
+        value << std::fixed << std::setprecision(2) << (report.epochAccuracy[e] * 100.0) << "% / "
+              << (report.epochHashAccuracy[e] * 100.0) << "% / " << report.epochSeconds[e];
+        std::cout << "║ " << std::left << std::setw(26) << name.str() << " ║ " << std::right << std::setw(24) << value.str() << " ║" << std::endl;
+    }
+    std::cout << "╚════════════════════════════╩══════════════════════════╝" << std::endl;
+    if (report.modelBytes + report.chunkBudgetBytes > options.memoryBudgetBytes) {
+        std::cout << "[WARNING] Model accumulators exceed the memory budget; prune the vocabulary for this corpus.\n";
+    }
+    std::cout << "[INFO] NB, VSM, both LRs and the ensemble are ready. LR accuracy is progressive (predict-then-update);\n"
+              << "       training-set reports are not computed in streaming mode." << std::endl;
 }
 
-void predictEmotion() {
+// Helper: true when both files have identical contents
+bool sameFileContents(const std::string &a, const std::string &b) {
+    std::ifstream fa(a.c_str(), std::ios::binary), fb(b.c_str(), std::ios::binary);
+    std::ostringstream ca, cb;
+    ca << fa.rdbuf();
+    cb << fb.rdbuf();
+    return fa && fb && ca.str() == cb.str();
+}
+
+void batchScore() {
+    std::shared_ptr<const ModelSnapshot> snapshot = g_models.acquire();
+    if (!snapshot) {
+        std::cout << "\n[ERROR] Models not trained yet. Please train models first.\n";
+        return;
+    }
+    std::string input = promptWithDefault("CSV to score", "data/dataset.csv");
+    std::string output = promptWithDefault("Predictions CSV", input + ".predictions.csv");
+    ScoringPipeline::Options options;
+    options.tokenizerThreads = std::atoi(promptWithDefault("Tokenizer threads", "2").c_str());
+    options.scorerThreads = std::atoi(promptWithDefault("Scorer threads", "2").c_str());
+    ScoringPipeline pipeline(snapshot, options);
+
+    // sequential baseline first, into a side file, so the outputs can be compared
+    std::string baselinePath = output + ".sequential";
+    ScoringPipeline::Report sequential, pipelined;
+    if (!pipeline.runSequential(input, baselinePath, sequential)) return;
+    if (!pipeline.run(input, output, pipelined)) return;
+
+    std::cout << "\nSequential (read -> tokenize -> score -> write, one row at a time):" << std::endl;
+    ScoringPipeline::printReport(sequential);
+    std::cout << "\nPipelined:" << std::endl;
+    ScoringPipeline::printReport(pipelined);
+
+    bool same = sameFileContents(baselinePath, output);
+    std::remove(baselinePath.c_str());
+    std::cout << "[INFO] Predictions written to " << output << "; "
+              << (same ? "identical to" : "DIFFERENT from") << " the sequential run." << std::endl;
+}
+
+// Helper: split "a,b,c" into trimmed non-empty parts
+std::vector<std::string> splitList(const std::string &list) {
+    std::vector<std::string> parts;
+    std::stringstream ss(list);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        size_t b = part.find_first_not_of(" \t"), e = part.find_last_not_of(" \t");
+        if (b != std::string::npos) parts.push_back(part.substr(b, e - b + 1));
+    }
+    return parts;
+}
+
+void naiveBayesCounts(const std::vector<std::string> &rawTexts, const std::vector<std::string> &labels) {
+    std::string action = promptWithDefault("[e]xport counts of the loaded dataset or [m]erge count files", "e");
+
+    if (action == "e") {
+        std::string path = promptWithDefault("Count file", "data/dataset.csv.nbcounts");
+        std::vector<std::vector<std::string>> docs = tokenizeAll(rawTexts);
+        Vectorizer vec;
+        vec.buildVocabulary(docs);
+        std::vector<std::string> vocab = vec.getVocabulary();
+
+        // serial map-based training vs sharded counting, same model expected
+        NaiveBayes serial, sharded;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        serial.trainFromDocuments(docs, labels, vocab);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        NaiveBayesCounts counts = NaiveBayesCounts::fromDocuments(docs, labels, vocab);
+        std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+        sharded.trainFromCountTable(counts);
+        std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+
+        BatchPrediction a = serial.predictBatch(docs), b = sharded.predictBatch(docs);
+        size_t same = 0;
+        for (size_t i = 0; i < docs.size(); ++i) same += a.label(i) == b.label(i) ? 1 : 0;
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << "[INFO] trainFromDocuments: " << std::chrono::duration<double>(t1 - t0).count() << " s; "
+                  << ThreadPool::shared().size() << "-shard count: " << std::chrono::duration<double>(t2 - t1).count()
+                  << " s + probabilities: " << std::chrono::duration<double>(t3 - t2).count() << " s\n"
+                  << "[INFO] " << same << " / " << docs.size() << " predictions identical" << std::endl;
+        if (counts.save(path)) std::cout << "[INFO] Wrote " << path << std::endl;
+        else std::cerr << "Error: cannot write " << path << std::endl;
+        return;
+    }
+
+    std::vector<std::string> files = splitList(promptWithDefault("Count files to merge (comma-separated)", "data/dataset.csv.nbcounts"));
+    std::string output = promptWithDefault("Merged count file", "data/merged.nbcounts");
+    std::vector<NaiveBayesCounts> shards(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!shards[i].load(files[i])) {
+            std::cerr << "Error: " << files[i] << " is missing or not a count file" << std::endl;
+            return;
+        }
+    }
+    NaiveBayesCounts merged = NaiveBayesCounts::reduce(shards);
+    if (!merged.save(output)) {
+        std::cerr << "Error: cannot write " << output << std::endl;
+        return;
+    }
+
+    // sanity check: the merged model on the loaded dataset
+    NaiveBayes nb;
+    nb.trainFromCountTable(merged);
+    std::vector<std::vector<std::string>> docs = tokenizeAll(rawTexts);
+    std::cout << "[INFO] Merged " << files.size() << " file(s) into " << output << ": "
+              << merged.getDocumentTotal() << " documents, " << merged.getClasses().size() << " classes, "
+              << merged.getVocabulary().size() << " words\n"
+              << "[INFO] Accuracy of the merged model on the loaded dataset: " << std::fixed << std::setprecision(2)
+              << nb.accuracy(docs, labels) * 100.0 << "%" << std::endl;
+}
+
+void sparseLogistic(const std::vector<std::string> &rawTexts, const std::vector<std::string> &labels) {
+    std::vector<std::vector<std::string>> docs = tokenizeAll(rawTexts);
+    Benchmarks::sparseLogistic(docs, labels);
+
+    double l1 = std::atof(promptWithDefault("Export a model trained on all rows with L1 penalty (0 = skip)", "0").c_str());
+    if (l1 <= 0.0) return;
+    if (!g_trained) {
+        std::cout << "\n[ERROR] Models not trained yet; the export uses the trained vocabulary.\n";
+        return;
+    }
+    double l2 = std::atof(promptWithDefault("L2 penalty", "0").c_str());
+    std::string output = promptWithDefault("Sparse model file", "data/dataset.csv.sparselr");
+
+    // feature ids follow the trained vocabulary, so the file scores g_vec.transformSparse output
+    std::vector<SparseVector> vectors(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) vectors[i] = g_vec.transformSparse(docs[i]);
+    LogisticRegression lr(0.01, 100);
+    lr.setRegularization(l1, l2);
+    lr.trainFromSparse(vectors, labels, (int)g_vec.getVocabulary().size());
+
+    SparseLogisticRegression sparse, reloaded;
+    sparse.compact(lr);
+    if (!sparse.save(output) || !reloaded.load(output)) {
+        std::cerr << "Error: cannot write " << output << std::endl;
+        return;
+    }
+    size_t agree = 0, correct = 0;
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        std::string pred = reloaded.predict(vectors[i]);
+        if (pred == sparse.predict(vectors[i])) agree++;
+        if (pred == labels[i]) correct++;
+    }
+    std::cout << std::fixed << std::setprecision(1) << "[INFO] Wrote " << output << ": " << sparse.getNonZeroCount()
+              << " non-zero weights on " << sparse.getActiveFeatureCount() << " of " << sparse.getNumFeatures()
+              << " features, " << sparse.sizeBytes() / 1024.0 << " KB ("
+              << (double)sparse.denseSizeBytes() / (double)std::max<size_t>(1, sparse.sizeBytes()) << "x smaller than dense)\n"
+              << "[INFO] Reloaded model agrees on " << agree << " / " << vectors.size() << " rows, training accuracy "
+              << std::setprecision(2) << 100.0 * (double)correct / (double)std::max<size_t>(1, vectors.size()) << "%" << std::endl;
+}
+
+void incrementalUpdate() {
+    if (!g_trained) {
+        std::cout << "\n[ERROR] Models not trained yet. Please train models first.\n";
+        return;
+    }
+    std::string path = promptWithDefault("CSV with new labelled rows", "data/dataset.csv");
+    int passes = std::max(1, std::atoi(promptWithDefault("SGD passes over the new rows", "1").c_str()));
+
+    std::vector<std::string> texts, newLabels;
+    loadCSV(path, texts, newLabels);
+    if (texts.empty()) {
+        std::cerr << "Error: no rows in " << path << std::endl;
+        return;
+    }
 
+    // LR, VSM and the ensemble change below: no pending evaluation may still be reading them.
+    // NB and the hashed LR are untouched, so their metrics stay valid.
+    g_vsmEval.clear();
+    g_lrEval.clear();
+    g_ensembleEval.clear();
+    g_noEvaluationReason = "updated by partial fit since the last full training";
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::string>> docs = tokenizeAll(texts);
+    size_t classesBefore = g_lr.getClasses().size();
+    size_t newWords = g_vec.extendVocabulary(docs);
+
+    // new words get ids after the old ones, so existing LR weights keep their meaning
+    std::vector<SparseVector> vectors(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) vectors[i] = g_vec.transformSparse(docs[i]);
+    double progressive = g_lr.partialFit(vectors, newLabels, g_vec.getVocabularySize(), passes);
+    g_vsm.partialFit(vectors, newLabels, g_vec.getVocabularySize());
+    g_vsm.refreshCentroids();   // the ensemble and batch scoring read the dense centroids
+
+    g_ensemble.build(g_vec.getVocabulary(), g_nb, g_lr, g_vsm);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    publishSnapshot();
+
+    size_t correct = 0;
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        if (g_lr.predictSparse(vectors[i]) == newLabels[i]) correct++;
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << "[INFO] Partial fit on " << texts.size() << " rows in " << seconds << " s: " << newWords
+              << " new words (vocabulary " << g_vec.getVocabularySize() << "), "
+              << g_lr.getClasses().size() - classesBefore << " new classes\n"
+              << "[INFO] VSM now counts " << g_vsm.getDocumentCount() << " documents\n"
+              << "[INFO] LR accuracy on the new rows: " << progressive * 100.0 << "% before the update (progressive), "
+              << 100.0 * (double)correct / (double)vectors.size() << "% after" << std::endl;
+}
+
+void exportHeader() {
     if (!g_trained) {
-        std::cout << "\n[ERROR] Models not trained yet. Please train models first (option 1).\n";
+        std::cout << "\n[ERROR] Models not trained yet. Please train models first.\n";
+        return;
+    }
+    std::string path = promptWithDefault("Header file", "data/emotion_model.hpp");
+    std::string ns = promptWithDefault("C++ namespace", "emotion_model");
+
+    ModelHeaderExporter::Report report;
+    if (!ModelHeaderExporter::write(path, ns, g_vec.getVocabulary(), g_nb, g_lr, report)) {
+        std::cerr << "Error: cannot export to " << path << " (is the namespace a C++ identifier?)" << std::endl;
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(1)
+              << "[INFO] Wrote " << path << ": " << report.words << " words, " << report.classes << " classes, "
+              << report.tableBytes / 1024.0 << " KB of constexpr tables\n"
+              << "[INFO] Perfect hash: " << report.buckets << " buckets -> " << report.tableSize
+              << " slots, largest displacement seed " << report.maxDisplacement << "\n"
+              << "[INFO] Build with -I include and score with " << ns << "::Predictor::predictNaiveBayes(tokens)"
+              << " / predictLogistic(tokens)" << std::endl;
+}
+
+void countMinNaiveBayes(const std::vector<std::string> &rawTexts, const std::vector<std::string> &labels) {
+    Benchmarks::countMinNaiveBayes(tokenizeAll(rawTexts), labels);
+
+    int capKb = std::atoi(promptWithDefault("Stream a CSV into a sketch with memory cap in KB (0 = skip)", "0").c_str());
+    if (capKb <= 0) return;
+    std::string path = promptWithDefault("CSV path", "data/dataset.csv");
+    CsvStream csv(path);
+    if (!csv.isOpen()) {
+        std::cerr << "Error: cannot open " << path << std::endl;
+        return;
+    }
+
+    // one row at a time, predict-then-update: memory stays at the cap however long the stream is
+    CountMinNaiveBayes cms((size_t)capKb << 10);
+    std::string text, label;
+    size_t rows = 0, correct = 0;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    while (csv.next(text, label)) {
+        std::vector<std::string> tokens = g_pre.process(text);
+        if (rows > 0 && cms.predict(tokens) == label) correct++;
+        cms.addDocument(tokens, label);
+        rows++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (rows == 0) {
+        std::cerr << "Error: no rows in " << path << std::endl;
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << "[INFO] Streamed " << rows << " rows in " << seconds << " s into a " << cms.getWidth() << " x "
+              << cms.getDepth() << " sketch (" << cms.sizeBytes() / 1024.0 << " KB, " << cms.getClasses().size()
+              << " classes, ~" << std::setprecision(0) << cms.estimateVocabularySize() << " distinct words)\n"
+              << std::setprecision(2) << "[INFO] Progressive accuracy (predict-then-update): "
+              << 100.0 * (double)correct / (double)std::max<size_t>(1, rows - 1) << "%" << std::endl;
+}
+
+void predictionCacheStats(const std::vector<std::string> &rawTexts) {
+    std::shared_ptr<const ModelSnapshot> snapshot = g_models.acquire();
+    if (!snapshot) {
+        std::cout << "\n[ERROR] Models not trained yet. Please train models first.\n";
+        return;
+    }
+    Benchmarks::predictionCache(*snapshot, rawTexts);
+
+    PredictionCache::Stats stats = g_predictionCache.getStats();
+    std::cout << "\n╔═══════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║        INTERACTIVE PREDICTION CACHE                   ║" << std::endl;
+    std::cout << "╠════════════════════════════╦══════════════════════════╣" << std::endl;
+    std::cout << "║ Lookups                    ║ " << std::right << std::setw(24) << stats.lookups() << " ║" << std::endl;
+    std::cout << "║ Text-key hits              ║ " << std::setw(24) << stats.textHits << " ║" << std::endl;
+    std::cout << "║ Token-key hits             ║ " << std::setw(24) << stats.tokenHits << " ║" << std::endl;
+    std::cout << "║ Misses                     ║ " << std::setw(24) << stats.misses << " ║" << std::endl;
+    std::cout << "║ Hit rate (%)               ║ " << std::fixed << std::setprecision(2) << std::setw(24) << 100.0 * stats.hitRate() << " ║" << std::endl;
+    std::cout << "║ Entries / capacity         ║ " << std::setw(24)
+              << (std::to_string(stats.entries) + " / " + std::to_string(stats.capacity)) << " ║" << std::endl;
+    std::cout << "║ Evictions                  ║ " << std::setw(24) << stats.evictions << " ║" << std::endl;
+    std::cout << "║ Invalidations (publishes)  ║ " << std::setw(24) << stats.invalidations << " ║" << std::endl;
+    std::cout << "╚════════════════════════════╩══════════════════════════╝" << std::endl;
+}
+
+void runTools(const std::vector<std::string> &rawTexts, const std::vector<std::string> &labels) {
+    while (true) {
+        displayToolsMenu();
+        std::string choice;
+
+        if (!std::getline(std::cin, choice)) break;
+
+        if (choice == "1") {
+            Benchmarks::vocabularyPruning(tokenizeAll(rawTexts), labels);
+        }
+        else if (choice == "2") {
+            Benchmarks::quantization(tokenizeAll(rawTexts), labels);
+        }
+        else if (choice == "3") {
+            Benchmarks::ensemble(tokenizeAll(rawTexts), labels);
+        }
+        else if (choice == "4") {
+            std::shared_ptr<const ModelSnapshot> snapshot = g_models.acquire();
+            Benchmarks::scratchAllocations(g_pre, rawTexts, labels, snapshot.get());
+        }
+        else if (choice == "5") {
+            Benchmarks::knn(tokenizeAll(rawTexts), labels);
+        }
+        else if (choice == "6") {
+            streamingTrain();
+        }
+        else if (choice == "7") {
+            std::shared_ptr<const ModelSnapshot> snapshot = g_models.acquire();
+            if (!snapshot) std::cout << "\n[ERROR] Models not trained yet. Please train models first.\n";
+            else Benchmarks::snapshotServing(*snapshot, rawTexts);
+        }
+        else if (choice == "8") {
+            batchScore();
+        }
+        else if (choice == "9") {
+            naiveBayesCounts(rawTexts, labels);
+        }
+        else if (choice == "10") {
+            Benchmarks::fastMath();
+        }
+        else if (choice == "11") {
+            Benchmarks::denseKernels(tokenizeAll(rawTexts), labels);
+        }
+        else if (choice == "12") {
+            sparseLogistic(rawTexts, labels);
+        }
+        else if (choice == "13") {
+            incrementalUpdate();
+        }
+        else if (choice == "14") {
+            exportHeader();
+        }
+        else if (choice == "15") {
+            Benchmarks::vocabularyOrder(tokenizeAll(rawTexts), labels);
+        }
+        else if (choice == "16") {
+            countMinNaiveBayes(rawTexts, labels);
+        }
+        else if (choice == "17") {
+            predictionCacheStats(rawTexts);
+        }
+        else if (choice == "0" || choice == "back") {
+            break;
+        }
+        else {
+            std::cout << "[ERROR] Invalid tool selection.\n";
+        }
+    }
+}
+
+void predictEmotion() {
+
+    if (!g_models.acquire()) {
+        std::cout << "\n[ERROR] Models not trained yet. Please train models first (option 1 or 2).\n";
         return;
     }
 
@@ -228,30 +870,31 @@ void predictEmotion() {
             continue;
         }
 
-        // Process text
-        std::vector<std::string> tokens = g_pre.process(input);
-        
-        if (tokens.empty()) {
+        // pin the current snapshot so a concurrent retrain cannot change it mid-request
+        std::shared_ptr<const ModelSnapshot> models = g_models.acquire();
+        ModelSnapshot::Predictions pred;
+        bool predicted;
+        {
+            METRIC_TIMER("predict_request");
+            predicted = g_predictionCache.predict(*models, input, pred);
+        }
+        if (!predicted) {
             std::cout << "[WARNING] No meaningful tokens found. Try a different sentence.\n" << std::endl;
             continue;
         }
 
-        // Get predictions from all three models
-        std::string nbPred = g_nb.predict(tokens);
-        
-        std::vector<int> countVec = g_vec.transformSingle(tokens);
-        std::string vsmPred = g_vsm.predict(countVec);
-        std::string lrPred = g_lr.predict(countVec);
-
         
         std::cout << "\n╔═══════════════════════════════════════════════════════╗" << std::endl;
         std::cout << "║                 EMOTION PREDICTIONS                   ║" << std::endl;
         std::cout << "╠════════════════════════════╦═════════════════════════╣" << std::endl;
         std::cout << "║ Algorithm                  ║ Predicted Emotion       ║" << std::endl;
         std::cout << "╠════════════════════════════╬═════════════════════════╣" << std::endl;
-        std::cout << "║ Naive Bayes                ║ " << std::left << std::setw(21) << nbPred << " ║" << std::endl;
-        //std::cout << "║ Vector Space Model (VSM)   ║ " << std::left << std::setw(21) << vsmPred << " ║" << std::endl;
-        std::cout << "║ Logistic Regression        ║ " << std::left << std::setw(21) << lrPred << " ║" << std::endl;
+        std::cout << "║ Naive Bayes                ║ " << std::left << std::setw(21) << pred.nb << " ║" << std::endl;
+        std::cout << "║ Vector Space Model (VSM)   ║ " << std::left << std::setw(21) << pred.vsm << " ║" << std::endl;
+        std::cout << "║ VSM k-nearest neighbours   ║ " << std::left << std::setw(21) << pred.vsmKnn << " ║" << std::endl;
+        std::cout << "║ Logistic Regression        ║ " << std::left << std::setw(21) << pred.lr << " ║" << std::endl;
+        std::cout << "║ LR (hashed n-grams)        ║ " << std::left << std::setw(21) << pred.hashLr << " ║" << std::endl;
+        std::cout << "║ Ensemble (NB+VSM+LR)       ║ " << std::left << std::setw(21) << pred.ensemble << " ║" << std::endl;
         std::cout << "╚════════════════════════════╩═════════════════════════╝\n" << std::endl;
     }
 }
@@ -270,6 +913,8 @@ int main() {
     }
 
     std::cout << "[INFO] Loaded " << rawTexts.size() << " training samples from " << dataPath << std::endl;
+    std::cout << "[INFO] Thread pool: " << ThreadPool::shared().size() << " workers (set EMOTION_THREADS to change)" << std::endl;
+    std::cout << "[INFO] Math kernels: " << FastMath::kernelName(FastMath::getKernel()) << " (set EMOTION_SIMD to change)" << std::endl;
 
     // Preprocess
     g_pre.loadStopWords(stopPath);
@@ -281,28 +926,39 @@ int main() {
         if (!std::getline(std::cin, choice)) break;
 
         if (choice == "1") {
-            trainModels(rawTexts, labels);
+            trainModels(rawTexts, labels, dataPath, stopPath, true);
         } 
         else if (choice == "2") {
-            predictEmotion();
+            trainModels(rawTexts, labels, dataPath, stopPath, false);
         } 
         else if (choice == "3") {
+            predictEmotion();
+        } 
+        else if (choice == "4") {
             if (!g_trained) {
-                std::cout << "\n[ERROR] Models not trained yet. Please train models first (option 1).\n";
+                std::cout << "\n[ERROR] Models not trained yet. Please train models first (option 1 or 2).\n";
             } 
             else {
                 std::cout << "\n";
-                ModelEvaluator::printDetailedReport("NAIVE BAYES", g_nbMetrics);
-                ModelEvaluator::printDetailedReport("VECTOR SPACE MODEL (VSM)", g_vsmMetrics);
-                ModelEvaluator::printDetailedReport("LOGISTIC REGRESSION", g_lrMetrics);
+                printModelReport("NAIVE BAYES", g_nbEval);
+                printModelReport("VECTOR SPACE MODEL (VSM)", g_vsmEval);
+                printModelReport("LOGISTIC REGRESSION", g_lrEval);
+                printModelReport("LOGISTIC REGRESSION (HASHED N-GRAMS)", g_hashLrEval);
+                printModelReport("ENSEMBLE (NB + VSM + LR)", g_ensembleEval);
             }
         }
-        else if (choice == "4") {
+        else if (choice == "5") {
+            exportMetrics();
+        }
+        else if (choice == "6") {
+            runTools(rawTexts, labels);
+        }
+        else if (choice == "7") {
             std::cout << "\nThank you for using EmotionDet!\n";
             break;
         } 
         else {
-            std::cout << "[ERROR] Invalid option. Please select 1-4.\n";
+            std::cout << "[ERROR] Invalid option. Please select 1-7.\n";
         }
     }
 